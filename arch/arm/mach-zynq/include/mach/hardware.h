@@ -63,7 +63,8 @@ struct slcr_regs {
 	u32 pss_rst_ctrl; /* 0x200 */
 	u32 reserved2[15];
 	u32 fpga_rst_ctrl; /* 0x240 */
-	u32 reserved3[5];
+	u32 a9_cpu_rst_ctrl; /* 0x244 */
+	u32 reserved3[4];
 	u32 reboot_status; /* 0x258 */
 	u32 boot_mode; /* 0x25c */
 	u32 reserved4[116];
@@ -108,7 +109,8 @@ struct devcfg_regs {
 #define devcfg_base ((struct devcfg_regs *)ZYNQ_DEV_CFG_APB_BASEADDR)
 
 struct scu_regs {
-	u32 reserved1[16];
+	u32 control; /* 0x0 */
+	u32 reserved1[15];
 	u32 filter_start; /* 0x40 */
 	u32 filter_end; /* 0x44 */
 };
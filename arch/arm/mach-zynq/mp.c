@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Second Cortex-A9 core as a worker for U-Boot jobs
+ *
+ * CPU1 is held in reset by the SLCR. When it is released it starts at the
+ * reset vector at address 0, where a two-word trampoline sends it to
+ * zynq_cpu1_entry. Both cores use the same translation table and are kept
+ * coherent by the SCU, so jobs need no cache maintenance.
+ *
+ * Before the OS starts, CPU1 leaves the coherency domain and is put back
+ * into reset, which is where the Linux SMP code expects to find it.
+ */
+
+#include <common.h>
+#include <cpu_func.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <worker.h>
+#include <asm/cache.h>
+#include <asm/io.h>
+#include <asm/system.h>
+#include <asm/arch/hardware.h>
+#include <asm/arch/sys_proto.h>
+#include <linux/bitops.h>
+#include <linux/sizes.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define SCU_CTRL_ENABLE		BIT(0)
+
+#define SLCR_A9_CPU1_RST	BIT(1)
+#define SLCR_A9_CPU1_CLKSTOP	BIT(5)
+
+#define ACTLR_SMP		BIT(6)
+
+#define ZYNQ_RESET_VECTOR	0x0
+/* ldr pc, [pc, #-4], followed by the address to jump to */
+#define ZYNQ_TRAMPOLINE_INSN	0xe51ff004
+
+#define ZYNQ_CPU1_STACK_SIZE	SZ_16K
+#define ZYNQ_CPU1_TIMEOUT_MS	100
+
+/* Read by zynq_cpu1_entry, keep the layout in sync with lowlevel_init.S */
+struct zynq_cpu1_boot {
+	u32 ttbr0;
+	u32 ttbcr;
+	u32 dacr;
+	u32 vbar;
+	u32 sctlr;
+	u32 sp;
+	u32 gd;
+	u32 entry;
+	volatile u32 alive;
+};
+
+struct zynq_cpu1_boot zynq_cpu1_boot;
+
+/*
+ * Set by CPU1 with its dcache off once it has left the coherency domain.
+ * CPU0 reads it from memory, so it has a cache line of its own.
+ */
+u32 zynq_cpu1_parked[ARCH_DMA_MINALIGN / sizeof(u32)]
+	__aligned(ARCH_DMA_MINALIGN);
+
+static void *zynq_cpu1_stack;
+
+void zynq_cpu1_entry(void);
+
+int arch_worker_start(void (*entry)(void))
+{
+	struct zynq_cpu1_boot *boot = &zynq_cpu1_boot;
+	void __iomem *vector = (void __iomem *)ZYNQ_RESET_VECTOR;
+	u32 saved[2], actlr;
+	ulong start;
+	void *stack;
+	int ret = 0;
+
+	/* lowlevel_init has to put CPU0 into SMP mode before the MMU is on */
+	asm volatile ("mrc p15, 0, %0, c1, c0, 1" : "=r" (actlr));
+	if (!(actlr & ACTLR_SMP))
+		return -ENOSYS;
+
+	stack = memalign(ARCH_DMA_MINALIGN, ZYNQ_CPU1_STACK_SIZE);
+	if (!stack)
+		return -ENOMEM;
+
+	asm volatile ("mrc p15, 0, %0, c2, c0, 0" : "=r" (boot->ttbr0));
+	asm volatile ("mrc p15, 0, %0, c2, c0, 2" : "=r" (boot->ttbcr));
+	asm volatile ("mrc p15, 0, %0, c3, c0, 0" : "=r" (boot->dacr));
+	asm volatile ("mrc p15, 0, %0, c12, c0, 0" : "=r" (boot->vbar));
+	boot->sctlr = get_cr();
+	boot->sp = (ulong)stack + ZYNQ_CPU1_STACK_SIZE;
+	boot->gd = (ulong)gd;
+	boot->entry = (ulong)entry;
+	boot->alive = 0;
+	zynq_cpu1_parked[0] = 0;
+
+	saved[0] = readl(vector);
+	saved[1] = readl(vector + 4);
+	writel(ZYNQ_TRAMPOLINE_INSN, vector);
+	writel((ulong)zynq_cpu1_entry, vector + 4);
+
+	/*
+	 * CPU1 reads all of this with its caches off. Lines which CPU0 had
+	 * cached before the SCU was enabled are not known to the SCU either.
+	 */
+	setbits_le32(&scu_base->control, SCU_CTRL_ENABLE);
+	flush_dcache_all();
+
+	zynq_slcr_unlock();
+	setbits_le32(&slcr_base->a9_cpu_rst_ctrl,
+		     SLCR_A9_CPU1_RST | SLCR_A9_CPU1_CLKSTOP);
+	clrbits_le32(&slcr_base->a9_cpu_rst_ctrl, SLCR_A9_CPU1_RST);
+	clrbits_le32(&slcr_base->a9_cpu_rst_ctrl, SLCR_A9_CPU1_CLKSTOP);
+	zynq_slcr_lock();
+
+	start = get_timer(0);
+	while (!boot->alive) {
+		if (get_timer(start) > ZYNQ_CPU1_TIMEOUT_MS)
+			break;
+	}
+
+	if (!boot->alive) {
+		zynq_slcr_unlock();
+		setbits_le32(&slcr_base->a9_cpu_rst_ctrl,
+			     SLCR_A9_CPU1_RST | SLCR_A9_CPU1_CLKSTOP);
+		zynq_slcr_lock();
+		ret = -ETIMEDOUT;
+	}
+
+	/* CPU1 is past the trampoline or back in reset */
+	writel(saved[0], vector);
+	writel(saved[1], vector + 4);
+	if (ret) {
+		free(stack);
+		return ret;
+	}
+	zynq_cpu1_stack = stack;
+	debug("CPU1 running, stack at %p\n", stack);
+
+	return 0;
+}
+
+int arch_worker_stop(void)
+{
+	ulong parked = (ulong)zynq_cpu1_parked;
+	ulong start;
+	int ret = 0;
+
+	start = get_timer(0);
+	for (;;) {
+		invalidate_dcache_range(parked, parked + ARCH_DMA_MINALIGN);
+		if (zynq_cpu1_parked[0])
+			break;
+		if (get_timer(start) > ZYNQ_CPU1_TIMEOUT_MS) {
+			ret = -ETIMEDOUT;
+			break;
+		}
+	}
+
+	zynq_slcr_unlock();
+	setbits_le32(&slcr_base->a9_cpu_rst_ctrl,
+		     SLCR_A9_CPU1_RST | SLCR_A9_CPU1_CLKSTOP);
+	zynq_slcr_lock();
+
+	free(zynq_cpu1_stack);
+	zynq_cpu1_stack = NULL;
+	debug("CPU1 in reset\n");
+
+	return ret;
+}
+
+void arch_worker_idle(void)
+{
+	asm volatile ("wfe" : : : "memory");
+}
+
+void arch_worker_kick(void)
+{
+	dsb();
+	asm volatile ("sev" : : : "memory");
+}
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler interrupt for the Zynq A9
+ *
+ * The private timer is U-Boot's timebase, so the samples come from the
+ * private watchdog, run in timer mode. Its interrupt (PPI 30) is the only
+ * one enabled in the GIC while the profiler runs.
+ */
+
+#include <common.h>
+#include <profile.h>
+#include <asm/gic.h>
+#include <asm/io.h>
+#include <asm/arch/hardware.h>
+#include <linux/bitops.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define PROFILE_IRQ		30
+
+struct scu_wdt {
+	u32 load;
+	u32 counter;
+	u32 control;
+	u32 isr;
+};
+
+#define SCUWDT_CONTROL_IT_ENABLE	BIT(2)
+#define SCUWDT_CONTROL_AUTO_RELOAD	BIT(1)
+#define SCUWDT_CONTROL_ENABLE		BIT(0)
+#define SCUWDT_ISR_EVENT		BIT(0)
+
+#define GICD_BASE	(ZYNQ_SCU_BASEADDR + GIC_DIST_OFFSET)
+#define GICC_BASE	(ZYNQ_SCU_BASEADDR + GIC_CPU_OFFSET_A9)
+
+static struct scu_wdt *const wdt =
+			(struct scu_wdt *)(ZYNQ_SCU_BASEADDR + 0x620);
+
+/* The interrupt runs on its own stack, set up in IRQ mode */
+static u64 profile_irq_stack[64];
+
+/* GIC state restored when the profiler stops */
+static u32 gicd_ctlr, gicc_ctlr, gicc_pmr;
+
+static void profile_set_irq_stack(void *top)
+{
+	ulong cpsr;
+
+	asm volatile("mrs	%0, cpsr\n"
+		     "cps	#0x12\n"	/* IRQ mode */
+		     "mov	sp, %1\n"
+		     "msr	cpsr_c, %0\n"
+		     : "=&r" (cpsr) : "r" (top) : "memory");
+}
+
+/* Called by the IRQ exception vector */
+void profile_irq(ulong pc)
+{
+	u32 iar = readl(GICC_BASE + GICC_IAR);
+
+	if ((iar & 0x3ff) == PROFILE_IRQ) {
+		writel(SCUWDT_ISR_EVENT, &wdt->isr);
+		profile_sample(pc);
+	}
+	/* Spurious interrupts (1023) must not be acknowledged */
+	if ((iar & 0x3ff) != 1023)
+		writel(iar, GICC_BASE + GICC_EOIR);
+}
+
+int arch_profile_start(uint rate)
+{
+	/* The private timers count at half the CPU clock */
+	u32 load = gd->cpu_clk / 2 / rate;
+
+	if (!load)
+		return -EINVAL;
+
+	profile_set_irq_stack(profile_irq_stack + ARRAY_SIZE(profile_irq_stack));
+
+	writel(0, &wdt->control);
+	writel(SCUWDT_ISR_EVENT, &wdt->isr);
+	writel(load - 1, &wdt->load);
+
+	gicd_ctlr = readl(GICD_BASE + GICD_CTLR);
+	gicc_ctlr = readl(GICC_BASE + GICC_CTLR);
+	gicc_pmr = readl(GICC_BASE + GICC_PMR);
+	writeb(0xa0, GICD_BASE + GICD_IPRIORITYRn + PROFILE_IRQ);
+	writel(BIT(PROFILE_IRQ), GICD_BASE + GICD_ISENABLERn);
+	writel(gicd_ctlr | 1, GICD_BASE + GICD_CTLR);
+	writel(0xf0, GICC_BASE + GICC_PMR);
+	writel(gicc_ctlr | 1, GICC_BASE + GICC_CTLR);
+
+	writel(SCUWDT_CONTROL_IT_ENABLE | SCUWDT_CONTROL_AUTO_RELOAD |
+	       SCUWDT_CONTROL_ENABLE, &wdt->control);
+	asm volatile("cpsie i" : : : "memory");
+
+	return 0;
+}
+
+void arch_profile_stop(void)
+{
+	asm volatile("cpsid i" : : : "memory");
+	writel(0, &wdt->control);
+	writel(SCUWDT_ISR_EVENT, &wdt->isr);
+
+	writel(BIT(PROFILE_IRQ), GICD_BASE + GICD_ICENABLERn);
+	writel(BIT(PROFILE_IRQ), GICD_BASE + GICD_ICPENDRn);
+	writel(gicc_ctlr, GICC_BASE + GICC_CTLR);
+	writel(gicc_pmr, GICC_BASE + GICC_PMR);
+	writel(gicd_ctlr, GICD_BASE + GICD_CTLR);
+}
@@ -12,6 +12,8 @@
 #include <linux/delay.h>
 #include <linux/libfdt.h>
 #include <os.h>
+#include <profile.h>
+#include <worker.h>
 #include <asm/io.h>
 #include <asm/malloc.h>
 #include <asm/setjmp.h>
@@ -54,14 +56,30 @@ void __udelay(unsigned long usec)
 
 int cleanup_before_linux(void)
 {
+	worker_stop();
+
 	return 0;
 }
 
 int cleanup_before_linux_select(int flags)
 {
+	worker_stop();
+
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(PROFILE)
+int arch_profile_start(uint rate)
+{
+	return os_profile_start(rate, profile_sample) ? -EIO : 0;
+}
+
+void arch_profile_stop(void)
+{
+	os_profile_stop();
+}
+#endif
+
 /**
  * is_in_sandbox_mem() - Checks if a pointer is within sandbox's emulated DRAM
  *
@@ -344,3 +362,45 @@ ulong timer_get_boot_us(void)
 
 	return (count - base_count) / 1000;
 }
+
+#if CONFIG_IS_ENABLED(WORKER)
+static void (*worker_entry)(void);
+static volatile bool worker_running;
+
+static void sandbox_worker_thread(void *arg)
+{
+	worker_entry();
+	worker_running = false;
+}
+
+/* A host thread stands in for the secondary core */
+int arch_worker_start(void (*entry)(void))
+{
+	worker_entry = entry;
+	worker_running = true;
+	if (os_thread_create(sandbox_worker_thread, NULL)) {
+		worker_running = false;
+		return -EAGAIN;
+	}
+
+	return 0;
+}
+
+/* The thread ends when the entry function returns */
+int arch_worker_stop(void)
+{
+	while (worker_running)
+		os_usleep(10);
+
+	return 0;
+}
+
+void arch_worker_idle(void)
+{
+	os_usleep(10);
+}
+
+void arch_worker_kick(void)
+{
+}
+#endif
@@ -3,10 +3,13 @@
  * Copyright (c) 2011 The Chromium OS Authors.
  */
 
+#define _GNU_SOURCE
+
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <setjmp.h>
 #include <signal.h>
 #include <stdio.h>
@@ -15,6 +18,7 @@
 #include <string.h>
 #include <termios.h>
 #include <time.h>
+#include <ucontext.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -823,6 +827,92 @@ void *os_find_text_base(void)
 	return base;
 }
 
+struct os_thread {
+	void (*func)(void *arg);
+	void *arg;
+};
+
+static void *os_thread_start(void *data)
+{
+	struct os_thread thread = *(struct os_thread *)data;
+
+	free(data);
+	thread.func(thread.arg);
+
+	return NULL;
+}
+
+int os_thread_create(void (*func)(void *arg), void *arg)
+{
+	struct os_thread *thread;
+	pthread_t id;
+
+	thread = malloc(sizeof(*thread));
+	if (!thread)
+		return -1;
+	thread->func = func;
+	thread->arg = arg;
+	if (pthread_create(&id, NULL, os_thread_start, thread)) {
+		free(thread);
+		return -1;
+	}
+	pthread_detach(id);
+
+	return 0;
+}
+
+static void (*os_profile_func)(unsigned long pc);
+
+static void os_profile_handler(int sig, siginfo_t *info, void *con)
+{
+	ucontext_t *context = con;
+	unsigned long pc;
+
+#if defined(__x86_64__)
+	pc = context->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+	pc = context->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+	pc = context->uc_mcontext.pc;
+#else
+	pc = 0;
+#endif
+	os_profile_func(pc);
+}
+
+int os_profile_start(unsigned int rate, void (*func)(unsigned long pc))
+{
+	struct itimerval timer = {};
+	struct sigaction act = {};
+	unsigned long usec = 1000000 / rate;
+
+	os_profile_func = func;
+	act.sa_sigaction = os_profile_handler;
+	/* Do not make console reads fail with EINTR */
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	if (sigaction(SIGALRM, &act, NULL))
+		return -1;
+
+	timer.it_interval.tv_sec = usec / 1000000;
+	timer.it_interval.tv_usec = usec % 1000000;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_REAL, &timer, NULL)) {
+		signal(SIGALRM, SIG_DFL);
+		return -1;
+	}
+
+	return 0;
+}
+
+void os_profile_stop(void)
+{
+	struct itimerval timer = {};
+
+	setitimer(ITIMER_REAL, &timer, NULL);
+	signal(SIGALRM, SIG_DFL);
+}
+
 void os_relaunch(char *argv[])
 {
 	execv(argv[0], argv);
@@ -61,6 +61,11 @@ void sandbox_write(void *addr, unsigned int val, enum sandboxio_size_t size);
 #define writeq(v, addr) sandbox_write((void *)addr, v, SB_SIZE_64)
 #endif
 
+/* Memory barriers, for data shared with the worker thread */
+#define mb()		__sync_synchronize()
+#define rmb()		mb()
+#define wmb()		mb()
+
 /*
  * Clear and set bits in one shot. These macros can be used to clear and
  * set multiple bits in a register using a single call. These macros can
@@ -20,9 +20,9 @@
 #include <linux/math64.h>
 #include <power/da9063_pmic.h>
 #include <power/pmic.h>
+#include <resource.h>
 #include <video.h>
 #include <video_console.h>
-#include "files.h"
 
 // For register EVENT_A
 #define DA9063_E_NONKEY BIT(0)
@@ -288,11 +288,15 @@ static int do_mango_pmic(struct cmd_tbl *cmdtp, int flag, int argc,
 	return CMD_RET_USAGE;
 }
 
+U_BOOT_RESOURCE(battery_charging_bmp, "battery-charging.bmp");
+
 static int do_mango_resource(struct cmd_tbl *cmdtp, int flag, int argc,
                            char * const argv[])
 {
 	int ret;
 	uintptr_t resource_ptr;
+	void *data;
+	ulong size;
 	char buf[32];
 
 	/* drop the 'resource' param */
@@ -308,13 +312,17 @@ static int do_mango_resource(struct cmd_tbl *cmdtp, int flag, int argc,
 		if (2 > argc) {
 			return CMD_RET_USAGE;
 		}
-		if (0 == strcmp(argv[1], "battery-charging.bmp")) {
-			resource_ptr = (uintptr_t) mango_files_battery_charging_bmp;
-		}
-		else {
+		/* decompressed on first use */
+		ret = resource_get(argv[1], &data, &size);
+		if (-ENOENT == ret) {
 			printf("No such resource\n");
 			return CMD_RET_FAILURE;
 		}
+		else if (ret) {
+			log_err("Could not get resource '%s': %d.\n", argv[1], ret);
+			return CMD_RET_FAILURE;
+		}
+		resource_ptr = (uintptr_t) data;
 		snprintf(buf, sizeof(buf), "0x%lx", resource_ptr);
 		if (2 > argc) {
 			/* simply print the result */
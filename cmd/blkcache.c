@@ -13,37 +13,56 @@
 static int blkc_show(struct cmd_tbl *cmdtp, int flag,
 		     int argc, char *const argv[])
 {
+	struct block_cache_config config;
 	struct block_cache_stats stats;
-	blkcache_stats(&stats);
-
-	printf("hits: %u\n"
-	       "misses: %u\n"
-	       "entries: %u\n"
-	       "max blocks/entry: %u\n"
-	       "max cache entries: %u\n",
-	       stats.hits, stats.misses, stats.entries,
-	       stats.max_blocks_per_entry, stats.max_entries);
+	int i, j;
+
+	blkcache_get_config(&config);
+	printf("size/device: %u KiB\n"
+	       "read-ahead blocks: %u\n"
+	       "max blocks/read: %u\n",
+	       config.size_kib, config.readahead, config.max_blocks);
+
+	for (i = 0; !blkcache_stats(i, &stats); i++) {
+		printf("\n%s %d (%lu-byte blocks):\n",
+		       blk_get_if_type_name(stats.iftype), stats.devnum,
+		       stats.blksz);
+		printf("hits: %u\n"
+		       "misses: %u\n"
+		       "read ahead: %u\n"
+		       "read-ahead hits: %u\n",
+		       stats.hits, stats.misses, stats.prefetched,
+		       stats.prefetch_hits);
+		for (j = 0; j < BLKCACHE_CLASSES; j++)
+			printf("entries of %u blocks: %u of %u\n",
+			       stats.cls[j].blocks_per_entry,
+			       stats.cls[j].entries, stats.cls[j].max_entries);
+	}
 	return 0;
 }
 
 static int blkc_configure(struct cmd_tbl *cmdtp, int flag,
 			  int argc, char *const argv[])
 {
-	unsigned blocks_per_entry, max_entries;
-	if (argc != 3)
+	struct block_cache_config config;
+
+	if (argc != 3 && argc != 4)
 		return CMD_RET_USAGE;
 
-	blocks_per_entry = simple_strtoul(argv[1], 0, 0);
-	max_entries = simple_strtoul(argv[2], 0, 0);
-	blkcache_configure(blocks_per_entry, max_entries);
-	printf("changed to max of %u entries of %u blocks each\n",
-	       max_entries, blocks_per_entry);
+	blkcache_get_config(&config);
+	config.size_kib = simple_strtoul(argv[1], 0, 0);
+	config.readahead = simple_strtoul(argv[2], 0, 0);
+	if (argc == 4)
+		config.max_blocks = simple_strtoul(argv[3], 0, 0);
+	blkcache_configure(&config);
+	printf("changed to %u KiB per device, read-ahead of %u blocks, reads of up to %u blocks\n",
+	       config.size_kib, config.readahead, config.max_blocks);
 	return 0;
 }
 
 static struct cmd_tbl cmd_blkc_sub[] = {
 	U_BOOT_CMD_MKENT(show, 0, 0, blkc_show, "", ""),
-	U_BOOT_CMD_MKENT(configure, 3, 0, blkc_configure, "", ""),
+	U_BOOT_CMD_MKENT(configure, 4, 0, blkc_configure, "", ""),
 };
 
 static __maybe_unused void blkc_reloc(void)
@@ -80,8 +99,10 @@ static int do_blkcache(struct cmd_tbl *cmdtp, int flag,
 }
 
 U_BOOT_CMD(
-	blkcache, 4, 0, do_blkcache,
+	blkcache, 5, 0, do_blkcache,
 	"block cache diagnostics and control",
-	"show - show and reset statistics\n"
-	"blkcache configure blocks entries\n"
+	"show - show configuration, show and reset statistics\n"
+	"blkcache configure size_kib readahead [max_blocks]\n"
+	"    - set the size per device in KiB, the number of blocks to read\n"
+	"      ahead of sequential reads and the largest read which is cached\n"
 );
@@ -39,6 +39,12 @@ U_BOOT_CMD(
 	"      If 'bytes' is 0 or omitted, the file is read until the end.\n"
 	"      'pos' gives the file byte position to start reading from.\n"
 	"      If 'pos' is 0 or omitted, the file is read from the start."
+#if CONFIG_IS_ENABLED(GZIP)
+	"\nload -z <interface> [<dev[:part]> [<addr> [<filename> [bytes]]]]\n"
+	"    - Load gzipped file 'filename', decompressing it while it is\n"
+	"      read. 'bytes' limits the uncompressed size.\n"
+	"      'filesize' is set to the uncompressed size."
+#endif
 )
 
 static int do_save_wrapper(struct cmd_tbl *cmdtp, int flag, int argc,
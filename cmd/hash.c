@@ -12,14 +12,71 @@
 #include <common.h>
 #include <command.h>
 #include <hash.h>
+#include <mapmem.h>
+#include <time.h>
+#include <div64.h>
 #include <linux/ctype.h>
 
+#ifdef CONFIG_CMD_HASH_BENCH
+static int do_hash_bench(int argc, char *const argv[])
+{
+	struct hash_algo *algo;
+	u8 output[HASH_MAX_DIGEST_SIZE];
+	ulong addr, len, loops = 1, start, us, i;
+	const void *buf;
+	char name[16];
+	u64 bytes;
+	char *s;
+
+	if (argc != 4 && argc != 5)
+		return CMD_RET_USAGE;
+
+	/* argv may be read-only, so lower-case a copy of the name */
+	strlcpy(name, argv[1], sizeof(name));
+	for (s = name; *s; s++)
+		*s = tolower(*s);
+
+	if (hash_lookup_algo(name, &algo)) {
+		printf("Unknown hash algorithm '%s'\n", argv[1]);
+		return CMD_RET_USAGE;
+	}
+	addr = simple_strtoul(argv[2], NULL, 16);
+	len = simple_strtoul(argv[3], NULL, 16);
+	if (argc == 5)
+		loops = simple_strtoul(argv[4], NULL, 10);
+	if (!len || !loops)
+		return CMD_RET_USAGE;
+
+	printf("Hash bench: %s, %lu bytes, %lu loop(s) ... ", algo->name, len,
+	       loops);
+
+	buf = map_sysmem(addr, len);
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		algo->hash_func_ws(buf, len, output, algo->chunk_size);
+	us = timer_get_us() - start;
+	unmap_sysmem(buf);
+	if (!us)
+		us = 1;
+
+	bytes = (u64)loops * len;
+	printf("%llu bytes in %lu us, %llu KiB/s\n", bytes, us,
+	       lldiv(bytes * 1000000 / 1024, us));
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
 static int do_hash(struct cmd_tbl *cmdtp, int flag, int argc,
 		   char *const argv[])
 {
 	char *s;
 	int flags = HASH_FLAG_ENV;
 
+#ifdef CONFIG_CMD_HASH_BENCH
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+		return do_hash_bench(argc - 1, argv + 1);
+#endif
 #ifdef CONFIG_HASH_VERIFY
 	if (argc < 4)
 		return CMD_RET_USAGE;
@@ -37,7 +94,7 @@ static int do_hash(struct cmd_tbl *cmdtp, int flag, int argc,
 	return hash_command(*argv, flags, cmdtp, flag, argc - 1, argv + 1);
 }
 
-#ifdef CONFIG_HASH_VERIFY
+#if defined(CONFIG_HASH_VERIFY) || defined(CONFIG_CMD_HASH_BENCH)
 #define HARGS 6
 #else
 #define HARGS 5
@@ -53,4 +110,8 @@ U_BOOT_CMD(
 		"    - verify message digest of memory area to immediate value, \n"
 		"      env var or *address"
 #endif
+#ifdef CONFIG_CMD_HASH_BENCH
+	"\nhash bench algorithm address count [loops]\n"
+		"    - hash memory area 'loops' times and report the throughput"
+#endif
 );
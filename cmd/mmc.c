@@ -8,11 +8,13 @@
 #include <blk.h>
 #include <command.h>
 #include <console.h>
+#include <div64.h>
 #include <memalign.h>
 #include <mmc.h>
 #include <part.h>
 #include <sparse_format.h>
 #include <image-sparse.h>
+#include <time.h>
 
 static int curr_device = -1;
 
@@ -351,6 +353,56 @@ static int do_mmc_read(struct cmd_tbl *cmdtp, int flag,
 	return (n == cnt) ? CMD_RET_SUCCESS : CMD_RET_FAILURE;
 }
 
+#if CONFIG_IS_ENABLED(CMD_MMC_BENCH)
+static int do_mmc_bench(struct cmd_tbl *cmdtp, int flag,
+			int argc, char *const argv[])
+{
+	struct blk_desc *desc;
+	struct mmc *mmc;
+	u32 blk, cnt, loops = 1, i, n;
+	ulong start, us;
+	u64 bytes;
+	void *addr;
+
+	if (argc != 4 && argc != 5)
+		return CMD_RET_USAGE;
+
+	addr = (void *)simple_strtoul(argv[1], NULL, 16);
+	blk = simple_strtoul(argv[2], NULL, 16);
+	cnt = simple_strtoul(argv[3], NULL, 16);
+	if (argc == 5)
+		loops = simple_strtoul(argv[4], NULL, 10);
+	if (!cnt || !loops)
+		return CMD_RET_USAGE;
+
+	mmc = init_mmc_device(curr_device, false);
+	if (!mmc)
+		return CMD_RET_FAILURE;
+	desc = mmc_get_blk_desc(mmc);
+
+	printf("MMC bench: dev # %d, block # %d, count %d, %d loop(s) ... ",
+	       curr_device, blk, cnt, loops);
+
+	start = timer_get_us();
+	for (i = 0; i < loops; i++) {
+		n = blk_dread(desc, blk, cnt, addr);
+		if (n != cnt) {
+			printf("ERROR after %d blocks\n", i * cnt + n);
+			return CMD_RET_FAILURE;
+		}
+	}
+	us = timer_get_us() - start;
+	if (!us)
+		us = 1;
+
+	bytes = (u64)loops * cnt * desc->blksz;
+	printf("%llu bytes in %lu us, %llu KiB/s\n", bytes, us,
+	       lldiv(bytes * 1000000 / 1024, us));
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
 #if CONFIG_IS_ENABLED(CMD_MMC_SWRITE)
 static lbaint_t mmc_sparse_write(struct sparse_storage *info, lbaint_t blk,
 				 lbaint_t blkcnt, const void *buffer)
@@ -935,6 +987,9 @@ static int do_mmc_boot_wp(struct cmd_tbl *cmdtp, int flag,
 static struct cmd_tbl cmd_mmc[] = {
 	U_BOOT_CMD_MKENT(info, 1, 0, do_mmcinfo, "", ""),
 	U_BOOT_CMD_MKENT(read, 4, 1, do_mmc_read, "", ""),
+#if CONFIG_IS_ENABLED(CMD_MMC_BENCH)
+	U_BOOT_CMD_MKENT(bench, 5, 1, do_mmc_bench, "", ""),
+#endif
 	U_BOOT_CMD_MKENT(wp, 1, 0, do_mmc_boot_wp, "", ""),
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 	U_BOOT_CMD_MKENT(write, 4, 0, do_mmc_write, "", ""),
@@ -997,6 +1052,9 @@ U_BOOT_CMD(
 	"MMC sub system",
 	"info - display info of the current MMC device\n"
 	"mmc read addr blk# cnt\n"
+#if CONFIG_IS_ENABLED(CMD_MMC_BENCH)
+	"mmc bench addr blk# cnt [loops] - time reading cnt blocks loops times\n"
+#endif
 	"mmc write addr blk# cnt\n"
 #if CONFIG_IS_ENABLED(CMD_MMC_SWRITE)
 	"mmc swrite addr blk#\n"
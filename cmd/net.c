@@ -13,6 +13,7 @@
 #include <env.h>
 #include <image.h>
 #include <net.h>
+#include <net/sink.h>
 #include <net/udp.h>
 #include <net/sntp.h>
 
@@ -123,6 +124,21 @@ U_BOOT_CMD(
 );
 #endif
 
+#if defined(CONFIG_CMD_WGET)
+static int do_wget(struct cmd_tbl *cmdtp, int flag, int argc,
+		   char *const argv[])
+{
+	return netboot_common(WGET, cmdtp, argc, argv);
+}
+
+U_BOOT_CMD(
+	wget,	3,	1,	do_wget,
+	"boot image via network using HTTP protocol",
+	"[loadAddress] [[hostIPaddr:]path]\n"
+	"    The server port is taken from 'httpdstp', 80 by default"
+);
+#endif
+
 static void netboot_update_env(void)
 {
 	char tmp[22];
@@ -198,6 +214,7 @@ static int netboot_common(enum proto_t proto, struct cmd_tbl *cmdtp, int argc,
 	int   rcode = 0;
 	int   size;
 	ulong addr;
+	bool sink;
 
 	net_boot_file_name_explicit = false;
 
@@ -258,6 +275,9 @@ static int netboot_common(enum proto_t proto, struct cmd_tbl *cmdtp, int argc,
 	}
 	bootstage_mark(BOOTSTAGE_ID_NET_START);
 
+	/* A file written to a sink is not in memory, so it cannot be booted */
+	sink = net_sink_is_set() && (proto == TFTPGET || proto == NFS ||
+				       proto == WGET || proto == TFTPSRV);
 	size = net_loop(proto);
 	if (size < 0) {
 		bootstage_error(BOOTSTAGE_ID_NET_NETLOOP_OK);
@@ -275,6 +295,8 @@ static int netboot_common(enum proto_t proto, struct cmd_tbl *cmdtp, int argc,
 	}
 
 	bootstage_mark(BOOTSTAGE_ID_NET_LOADED);
+	if (sink)
+		return CMD_RET_SUCCESS;
 
 	rcode = bootm_maybe_autostart(cmdtp, argv[0]);
 
@@ -0,0 +1,331 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Write files received by tftp, nfs or wget to a DFU entity, a block device
+ * or a hash instead of memory
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <command.h>
+#include <dfu.h>
+#include <env.h>
+#include <hash.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <net.h>
+#include <part.h>
+#include <net/sink.h>
+#include <linux/kernel.h>
+
+#if CONFIG_IS_ENABLED(DFU)
+static struct netsink_dfu {
+	struct net_sink sink;
+	char interface[16];
+	char devstr[32];
+	char alt[32];
+	struct dfu_entity *dfu;
+	int seq;
+} netsink_dfu;
+
+static int netsink_dfu_start(struct net_sink *sink)
+{
+	struct netsink_dfu *priv = sink->priv;
+	int alt, ret;
+
+	dfu_free_entities();
+	ret = dfu_init_env_entities(priv->interface, priv->devstr);
+	if (ret)
+		return ret;
+
+	alt = dfu_get_alt(priv->alt);
+	if (alt < 0) {
+		printf("DFU entity '%s' not found\n", priv->alt);
+		dfu_free_entities();
+		return alt;
+	}
+	priv->dfu = dfu_get_entity(alt);
+	/* This makes dfu_get_buf_size() take dfu_bufsiz into account */
+	if (!dfu_get_buf(priv->dfu)) {
+		dfu_free_entities();
+		return -ENOMEM;
+	}
+	priv->seq = 0;
+
+	return 0;
+}
+
+static int netsink_dfu_write(struct net_sink *sink, ulong offset,
+			     const void *buf, ulong len)
+{
+	struct netsink_dfu *priv = sink->priv;
+	ulong chunk;
+	int ret;
+
+	/* dfu_write() takes at most a DFU buffer at a time */
+	for (; len; buf += chunk, len -= chunk) {
+		chunk = min(len, dfu_get_buf_size());
+		ret = dfu_write(priv->dfu, (void *)buf, chunk, priv->seq);
+		if (ret)
+			return ret;
+		priv->seq = (priv->seq + 1) & 0xffff;
+	}
+
+	return 0;
+}
+
+static int netsink_dfu_finish(struct net_sink *sink, ulong size)
+{
+	struct netsink_dfu *priv = sink->priv;
+	int ret;
+
+	ret = dfu_flush(priv->dfu, NULL, 0, priv->seq);
+	dfu_free_entities();
+
+	return ret;
+}
+
+static void netsink_dfu_abort(struct net_sink *sink)
+{
+	dfu_free_entities();
+}
+
+static int netsink_set_dfu(int argc, char *const argv[])
+{
+	struct netsink_dfu *priv = &netsink_dfu;
+
+	if (argc != 4)
+		return CMD_RET_USAGE;
+
+	strlcpy(priv->interface, argv[1], sizeof(priv->interface));
+	strlcpy(priv->devstr, argv[2], sizeof(priv->devstr));
+	strlcpy(priv->alt, argv[3], sizeof(priv->alt));
+	priv->sink.name = priv->alt;
+	priv->sink.align = 1;
+	priv->sink.start = netsink_dfu_start;
+	priv->sink.write = netsink_dfu_write;
+	priv->sink.finish = netsink_dfu_finish;
+	priv->sink.abort = netsink_dfu_abort;
+	priv->sink.priv = priv;
+	net_sink_set(&priv->sink);
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(BLK)
+static struct netsink_blk {
+	struct net_sink sink;
+	char name[32];
+	struct blk_desc *desc;
+	lbaint_t start;
+	lbaint_t count;
+} netsink_blk;
+
+static int netsink_blk_write(struct net_sink *sink, ulong offset,
+			     const void *buf, ulong len)
+{
+	struct netsink_blk *priv = sink->priv;
+	struct blk_desc *desc = priv->desc;
+	lbaint_t blk = offset / desc->blksz;
+	lbaint_t full = len / desc->blksz;
+	ulong tail = len % desc->blksz;
+	void *last;
+	ulong ret;
+
+	if (blk + full + !!tail > priv->count) {
+		printf("\nFile does not fit into %s\n", sink->name);
+		return -ENOSPC;
+	}
+
+	if (full && blk_dwrite(desc, priv->start + blk, full, buf) != full)
+		return -EIO;
+	if (!tail)
+		return 0;
+
+	/* The end of the file is padded with zeroes up to a full block */
+	last = malloc_cache_aligned(desc->blksz);
+	if (!last)
+		return -ENOMEM;
+	memcpy(last, buf + full * desc->blksz, tail);
+	memset(last + tail, '\0', desc->blksz - tail);
+	ret = blk_dwrite(desc, priv->start + blk + full, 1, last);
+	free(last);
+
+	return ret == 1 ? 0 : -EIO;
+}
+
+static int netsink_blk_finish(struct net_sink *sink, ulong size)
+{
+	printf("%lu bytes written to %s\n", size, sink->name);
+
+	return 0;
+}
+
+static int netsink_set_blk(int argc, char *const argv[])
+{
+	struct netsink_blk *priv = &netsink_blk;
+	struct disk_partition info;
+	struct blk_desc *desc;
+	lbaint_t offset = 0;
+	int part;
+
+	if (argc != 3 && argc != 4)
+		return CMD_RET_USAGE;
+
+	part = blk_get_device_part_str(argv[1], argv[2], &desc, &info, 1);
+	if (part < 0)
+		return CMD_RET_FAILURE;
+	if (argc == 4)
+		offset = simple_strtoul(argv[3], NULL, 0);
+	if (offset >= info.size) {
+		printf("Offset beyond the end of %s %s\n", argv[1], argv[2]);
+		return CMD_RET_FAILURE;
+	}
+
+	snprintf(priv->name, sizeof(priv->name), "%s %s", argv[1], argv[2]);
+	priv->desc = desc;
+	priv->start = info.start + offset;
+	priv->count = info.size - offset;
+	priv->sink.name = priv->name;
+	priv->sink.align = desc->blksz;
+	priv->sink.write = netsink_blk_write;
+	priv->sink.finish = netsink_blk_finish;
+	priv->sink.priv = priv;
+	net_sink_set(&priv->sink);
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(HASH)
+static struct netsink_hash {
+	struct net_sink sink;
+	struct hash_algo *algo;
+	void *ctx;
+	char var[32];
+} netsink_hash;
+
+static int netsink_hash_start(struct net_sink *sink)
+{
+	struct netsink_hash *priv = sink->priv;
+
+	free(priv->ctx);
+	priv->ctx = NULL;
+
+	return priv->algo->hash_init(priv->algo, &priv->ctx);
+}
+
+static int netsink_hash_write(struct net_sink *sink, ulong offset,
+			      const void *buf, ulong len)
+{
+	struct netsink_hash *priv = sink->priv;
+
+	return priv->algo->hash_update(priv->algo, priv->ctx, buf, len, 0);
+}
+
+static int netsink_hash_finish(struct net_sink *sink, ulong size)
+{
+	struct netsink_hash *priv = sink->priv;
+	struct hash_algo *algo = priv->algo;
+	u8 output[HASH_MAX_DIGEST_SIZE];
+	char str[HASH_MAX_DIGEST_SIZE * 2 + 1];
+	int i, ret;
+
+	ret = algo->hash_finish(algo, priv->ctx, output, sizeof(output));
+	/* hash_finish() frees the context */
+	priv->ctx = NULL;
+	if (ret)
+		return ret;
+
+	for (i = 0; i < algo->digest_size; i++)
+		sprintf(str + 2 * i, "%02x", output[i]);
+	printf("%s for '%s' ==> %s\n", algo->name, net_boot_file_name, str);
+	if (priv->var[0])
+		env_set(priv->var, str);
+
+	return 0;
+}
+
+static void netsink_hash_abort(struct net_sink *sink)
+{
+	struct netsink_hash *priv = sink->priv;
+
+	free(priv->ctx);
+	priv->ctx = NULL;
+}
+
+static int netsink_set_hash(int argc, char *const argv[])
+{
+	struct netsink_hash *priv = &netsink_hash;
+
+	if (argc != 2 && argc != 3)
+		return CMD_RET_USAGE;
+
+	if (hash_lookup_algo(argv[1], &priv->algo)) {
+		printf("Unknown hash algorithm '%s'\n", argv[1]);
+		return CMD_RET_FAILURE;
+	}
+	if (argc == 3)
+		strlcpy(priv->var, argv[2], sizeof(priv->var));
+	else
+		priv->var[0] = '\0';
+	priv->sink.name = priv->algo->name;
+	priv->sink.align = 1;
+	priv->sink.start = netsink_hash_start;
+	priv->sink.write = netsink_hash_write;
+	priv->sink.finish = netsink_hash_finish;
+	priv->sink.abort = netsink_hash_abort;
+	priv->sink.priv = priv;
+	net_sink_set(&priv->sink);
+
+	return CMD_RET_SUCCESS;
+}
+#endif
+
+static int do_netsink(struct cmd_tbl *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	argc--;
+	argv++;
+#if CONFIG_IS_ENABLED(DFU)
+	if (!strcmp(argv[0], "dfu"))
+		return netsink_set_dfu(argc, argv);
+#endif
+#if CONFIG_IS_ENABLED(BLK)
+	if (!strcmp(argv[0], "blk"))
+		return netsink_set_blk(argc, argv);
+#endif
+#if CONFIG_IS_ENABLED(HASH)
+	if (!strcmp(argv[0], "hash"))
+		return netsink_set_hash(argc, argv);
+#endif
+	if (!strcmp(argv[0], "off")) {
+		net_sink_set(NULL);
+		return CMD_RET_SUCCESS;
+	}
+
+	return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(
+	netsink, 5, 0, do_netsink,
+	"write the next tftp/nfs/wget file somewhere else than memory",
+#if CONFIG_IS_ENABLED(DFU)
+	"dfu <interface> <dev> <name> - write it to a DFU entity\n"
+	"netsink "
+#endif
+#if CONFIG_IS_ENABLED(BLK)
+	"blk <interface> <dev[:part]> [offset] - write it to a block device\n"
+	"    or partition, starting at block offset. A partial last block\n"
+	"    is padded with zeroes\n"
+	"netsink "
+#endif
+#if CONFIG_IS_ENABLED(HASH)
+	"hash <algorithm> [var] - print its hash and store it in var\n"
+	"netsink "
+#endif
+	"off - store the next file in memory again"
+);
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Control the sampling profiler
+ */
+
+#include <common.h>
+#include <command.h>
+#include <env.h>
+#include <mapmem.h>
+#include <profile.h>
+
+static int do_profile_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	uint rate = PROFILE_DEFAULT_RATE;
+	int ret;
+
+	if (argc > 1)
+		rate = simple_strtoul(argv[1], NULL, 10);
+	if (!rate)
+		return CMD_RET_USAGE;
+
+	ret = profile_start(rate);
+	if (ret) {
+		printf("Cannot start profiler (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_profile_stop(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	profile_stop();
+	profile_show();
+
+	return 0;
+}
+
+static int do_profile_info(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	profile_show();
+
+	return 0;
+}
+
+static int do_profile_dump(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	ulong addr, size;
+	void *buf;
+	int ret;
+
+	if (argc != 3)
+		return CMD_RET_USAGE;
+	addr = simple_strtoul(argv[1], NULL, 16);
+	size = simple_strtoul(argv[2], NULL, 16);
+
+	buf = map_sysmem(addr, size);
+	ret = profile_dump(buf, size);
+	unmap_sysmem(buf);
+	if (ret == -EBUSY) {
+		printf("Stop the profiler first\n");
+		return CMD_RET_FAILURE;
+	} else if (ret < 0) {
+		printf("Buffer too small\n");
+		return CMD_RET_FAILURE;
+	}
+	printf("Samples dumped to %08lx, size %#x\n", addr, ret);
+	env_set_hex("filesize", ret);
+
+	return 0;
+}
+
+static struct cmd_tbl cmd_profile_sub[] = {
+	U_BOOT_CMD_MKENT(start, 2, 0, do_profile_start, "", ""),
+	U_BOOT_CMD_MKENT(stop, 1, 0, do_profile_stop, "", ""),
+	U_BOOT_CMD_MKENT(info, 1, 0, do_profile_info, "", ""),
+	U_BOOT_CMD_MKENT(dump, 3, 0, do_profile_dump, "", ""),
+};
+
+static int do_profile(struct cmd_tbl *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	struct cmd_tbl *cp;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* Strip off leading 'profile' command argument */
+	argc--;
+	argv++;
+
+	cp = find_cmd_tbl(argv[0], cmd_profile_sub,
+			  ARRAY_SIZE(cmd_profile_sub));
+	if (!cp)
+		return CMD_RET_USAGE;
+
+	return cp->cmd(cmdtp, flag, argc, argv);
+}
+
+U_BOOT_CMD(
+	profile, 4, 0, do_profile,
+	"sampling profiler",
+	"start [<rate>]       - discard the samples and start sampling at\n"
+	"                               rate Hz (default 1000)\n"
+	"profile stop                 - stop sampling\n"
+	"profile info                 - show the state of the profiler\n"
+	"profile dump <addr> <size>   - write the samples to memory and set\n"
+	"                               filesize, for 'proftool -s'"
+);
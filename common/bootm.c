@@ -17,6 +17,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <net.h>
+#include <profile.h>
 #include <asm/cache.h>
 #include <asm/io.h>
 #if defined(CONFIG_CMD_USB)
@@ -394,6 +395,7 @@ static int bootm_load_os(bootm_headers_t *images, int boot_progress)
 	}
 	/* We need the decompressed image size in the next steps */
 	images->os.image_len = load_end - load;
+	fit_hash_worker_invalidate(load, load_end - load);
 
 	flush_cache(flush_start, ALIGN(load_end, ARCH_DMA_MINALIGN) - flush_start);
 
@@ -442,6 +444,8 @@ ulong bootm_disable_interrupts(void)
 	 * recover from any failures any more...
 	 */
 	iflag = disable_interrupts();
+	/* The OS does not expect the profiler's timer interrupt */
+	profile_stop();
 #ifdef CONFIG_NETCONSOLE
 	/* Stop the ethernet stack if NetConsole could have left it up */
 	eth_halt();
@@ -560,6 +564,9 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 
 	images->state |= states;
 
+	/* FIT images may be hashed on the worker core until all are loaded */
+	fit_hash_worker_begin();
+
 	/*
 	 * Work through the states and see how far we get. We stop on
 	 * any error.
@@ -583,6 +590,12 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 			ret = 0;
 	}
 
+	/*
+	 * All images are verified by now. Drop the hashes before anything
+	 * else moves memory around.
+	 */
+	fit_hash_worker_end();
+
 	/* Relocate the ramdisk */
 #ifdef CONFIG_SYS_BOOT_RAMDISK_HIGH
 	if (!ret && (states & BOOTM_STATE_RAMDISK)) {
@@ -659,6 +672,7 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 
 	/* Deal with any fallout */
 err:
+	fit_hash_worker_end();
 	if (iflag)
 		enable_interrupts();
 
@@ -18,11 +18,14 @@
 #include <spl.h>
 #include <linux/compiler.h>
 #include <linux/libfdt.h>
+#include <u-boot/crc.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
 enum {
 	RECORD_COUNT = CONFIG_VAL(BOOTSTAGE_RECORD_COUNT),
+	/* Spans leave the rest of the records to the marks of the boot */
+	SPAN_COUNT = RECORD_COUNT / 2,
 };
 
 struct bootstage_record {
@@ -31,16 +34,25 @@ struct bootstage_record {
 	const char *name;
 	int flags;		/* see enum bootstage_flags */
 	enum bootstage_id id;
+	uint32_t duration_us;	/* Length of a BOOTSTAGEF_SPAN record */
+	/*
+	 * Block device bytes read and written: the totals so far for a mark,
+	 * what was transferred during the span for a span record
+	 */
+	uint32_t read_bytes;
+	uint32_t write_bytes;
 };
 
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
+	u64 read_bytes;		/* Block device bytes read since reset */
+	u64 write_bytes;	/* Block device bytes written since reset */
 	struct bootstage_record record[RECORD_COUNT];
 };
 
 enum {
-	BOOTSTAGE_VERSION	= 0,
+	BOOTSTAGE_VERSION	= 1,
 	BOOTSTAGE_MAGIC		= 0xb00757a3,
 	BOOTSTAGE_DIGITS	= 9,
 };
@@ -132,6 +144,8 @@ ulong bootstage_add_record(enum bootstage_id id, const char *name,
 		rec->name = name;
 		rec->flags = flags;
 		rec->id = id;
+		rec->read_bytes = data->read_bytes;
+		rec->write_bytes = data->write_bytes;
 	}
 
 	/* Tell the board about this progress */
@@ -217,6 +231,120 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+void bootstage_span_start(struct bootstage_span *span)
+{
+	struct bootstage_data *data = gd->bootstage;
+
+	span->start_us = timer_get_boot_us();
+	if (data) {
+		span->read_bytes = data->read_bytes;
+		span->write_bytes = data->write_bytes;
+	}
+}
+
+/*
+ * Get a record for a span. Once spans take SPAN_COUNT records, or the table
+ * is full, a new span replaces the oldest one. In a long session the spans
+ * of commands then do not take the records needed by the marks of a boot.
+ */
+static struct bootstage_record *span_record(struct bootstage_data *data)
+{
+	struct bootstage_record *rec, *oldest = NULL;
+	int i, spans = 0;
+
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (!(rec->flags & BOOTSTAGEF_SPAN))
+			continue;
+		spans++;
+		if (!oldest || rec->time_us < oldest->time_us)
+			oldest = rec;
+	}
+	if (spans < SPAN_COUNT && data->rec_count < RECORD_COUNT)
+		return &data->record[data->rec_count++];
+
+	if (oldest && (oldest->flags & BOOTSTAGEF_CMD))
+		free((char *)oldest->name);
+
+	return oldest;
+}
+
+static bool add_span(struct bootstage_span *span, const char *name,
+		     int flags, ulong now)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec;
+
+	if (!data)
+		return false;
+	rec = span_record(data);
+	if (!rec)
+		return false;
+
+	rec->time_us = span->start_us;
+	rec->start_us = 0;
+	rec->name = name;
+	rec->flags = BOOTSTAGEF_SPAN | flags;
+	rec->id = data->next_id++;
+	rec->duration_us = now - span->start_us;
+	rec->read_bytes = data->read_bytes - span->read_bytes;
+	rec->write_bytes = data->write_bytes - span->write_bytes;
+
+	return true;
+}
+
+ulong bootstage_span_end(struct bootstage_span *span, const char *name)
+{
+	ulong now = timer_get_boot_us();
+
+	add_span(span, name, 0, now);
+
+	return now;
+}
+
+#if IS_ENABLED(CONFIG_BOOTSTAGE_CMD)
+void bootstage_cmd(struct bootstage_span *span, int argc, char *const argv[])
+{
+	char buf[BOOTSTAGE_CMD_NAME_LEN + 11];
+	ulong now = timer_get_boot_us();
+	char *name;
+	u32 hash = 0;
+	int i, len;
+
+	if (!gd->bootstage || now - span->start_us < CONFIG_BOOTSTAGE_CMD_MIN_US)
+		return;
+
+	/*
+	 * The name holds as many words of the command line as fit, usually
+	 * the command and its subcommand. All the arguments are hashed, so
+	 * that records for different invocations can be told apart.
+	 */
+	for (i = 0; i < argc; i++)
+		hash = crc32(hash, (const uchar *)argv[i], strlen(argv[i]) + 1);
+	strlcpy(buf, argv[0], BOOTSTAGE_CMD_NAME_LEN);
+	len = strlen(buf);
+	for (i = 1; i < argc &&
+	     len + 1 + strlen(argv[i]) < BOOTSTAGE_CMD_NAME_LEN; i++)
+		len += sprintf(buf + len, " %s", argv[i]);
+	sprintf(buf + len, " #%08x", hash);
+
+	name = strdup(buf);
+	if (name && !add_span(span, name, BOOTSTAGEF_CMD, now))
+		free(name);
+}
+#endif
+
+void bootstage_blk_io(bool write, ulong bytes)
+{
+	struct bootstage_data *data = gd->bootstage;
+
+	if (!data)
+		return;
+	if (write)
+		data->write_bytes += bytes;
+	else
+		data->read_bytes += bytes;
+}
+
 /**
  * Get a record name as a printable string
  *
@@ -312,6 +440,16 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 				rec->start_us ? "accum" : "mark",
 				rec->time_us))
 			return -EINVAL;
+
+		/* A span also has a length and the block I/O done during it */
+		if (rec->flags & BOOTSTAGEF_SPAN &&
+		    (fdt_setprop_cell(blob, node, "duration",
+				      rec->duration_us) ||
+		     fdt_setprop_cell(blob, node, "read-bytes",
+				      rec->read_bytes) ||
+		     fdt_setprop_cell(blob, node, "write-bytes",
+				      rec->write_bytes)))
+			return -EINVAL;
 	}
 
 	return 0;
@@ -331,6 +469,7 @@ void bootstage_report(void)
 	struct bootstage_data *data = gd->bootstage;
 	struct bootstage_record *rec = data->record;
 	uint32_t prev;
+	int spans = 0;
 	int i;
 
 	printf("Timer summary in microseconds (%d records):\n",
@@ -343,7 +482,7 @@ void bootstage_report(void)
 	qsort(data->record, data->rec_count, sizeof(*rec), h_compare_record);
 
 	for (i = 1, rec++; i < data->rec_count; i++, rec++) {
-		if (rec->id && !rec->start_us)
+		if (rec->id && !rec->start_us && !(rec->flags & BOOTSTAGEF_SPAN))
 			prev = print_time_record(rec, prev);
 	}
 	if (data->rec_count > RECORD_COUNT)
@@ -356,6 +495,19 @@ void bootstage_report(void)
 		if (rec->start_us)
 			prev = print_time_record(rec, -1);
 	}
+
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (!(rec->flags & BOOTSTAGEF_SPAN))
+			continue;
+		if (!spans++)
+			printf("\nSpans:\n%11s%11s%11s%11s  %s\n", "Start",
+			       "Duration", "Read", "Written", "Stage");
+		print_grouped_ull(rec->time_us, BOOTSTAGE_DIGITS);
+		print_grouped_ull(rec->duration_us, BOOTSTAGE_DIGITS);
+		print_grouped_ull(rec->read_bytes, BOOTSTAGE_DIGITS);
+		print_grouped_ull(rec->write_bytes, BOOTSTAGE_DIGITS);
+		printf("  %s\n", rec->name);
+	}
 }
 
 /**
@@ -380,6 +532,90 @@ static void append_data(char **ptrp, char *end, const void *data, int size)
 	memcpy(ptr, data, size);
 }
 
+/**
+ * Append formatted text to a memory buffer
+ *
+ * Like append_data(), the buffer pointer is incremented whether there is
+ * space or not.
+ *
+ * @param ptrp	Pointer to buffer, updated by this function
+ * @param end	Pointer to end of buffer
+ * @param fmt	printf() format string
+ */
+static void append_printf(char **ptrp, char *end, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	*ptrp += vsnprintf(*ptrp, *ptrp < end ? end - *ptrp : 0, fmt, args);
+	va_end(args);
+}
+
+/* Append a record name as a JSON string */
+static void append_json_name(char **ptrp, char *end,
+			     const struct bootstage_record *rec)
+{
+	char buf[20];
+	const char *name = get_record_name(buf, sizeof(buf), rec);
+
+	append_printf(ptrp, end, "\"");
+	for (; *name; name++) {
+		if (*name == '"' || *name == '\\')
+			append_printf(ptrp, end, "\\%c", *name);
+		else if ((uchar)*name < ' ')
+			append_printf(ptrp, end, "\\u%04x", *name);
+		else
+			append_printf(ptrp, end, "%c", *name);
+	}
+	append_printf(ptrp, end, "\"");
+}
+
+int bootstage_trace_json(char *buf, int size)
+{
+	const struct bootstage_data *data = gd->bootstage;
+	const struct bootstage_record *rec;
+	char *ptr = buf, *end = buf + size;
+	const char *sep = "";
+	int i;
+
+	append_printf(&ptr, end,
+		      "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for (rec = data->record, i = 0; i < data->rec_count; i++, rec++) {
+		/* Accumulated time has no place on a timeline */
+		if (rec->start_us)
+			continue;
+
+		append_printf(&ptr, end, "%s\n{\"name\":", sep);
+		append_json_name(&ptr, end, rec);
+		if (rec->flags & BOOTSTAGEF_SPAN) {
+			append_printf(&ptr, end,
+				      ",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+				      "\"ts\":%lu,\"dur\":%u,"
+				      "\"args\":{\"read\":%u,\"written\":%u}}",
+				      rec->time_us, rec->duration_us,
+				      rec->read_bytes, rec->write_bytes);
+		} else {
+			/* Marks also feed a counter track of the block I/O */
+			append_printf(&ptr, end,
+				      ",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,"
+				      "\"ts\":%lu},\n{\"name\":\"block I/O\",\"ph\":\"C\","
+				      "\"pid\":1,\"ts\":%lu,"
+				      "\"args\":{\"read\":%u,\"written\":%u}}",
+				      rec->time_us, rec->time_us,
+				      rec->read_bytes, rec->write_bytes);
+		}
+		sep = ",";
+	}
+	append_printf(&ptr, end, "\n]}\n");
+
+	if (ptr >= end) {
+		debug("%s: Not enough space for bootstage trace\n", __func__);
+		return -ENOSPC;
+	}
+
+	return ptr - buf;
+}
+
 int bootstage_stash(void *base, int size)
 {
 	const struct bootstage_data *data = gd->bootstage;
@@ -488,6 +724,8 @@ int bootstage_unstash(const void *base, int size)
 		rec->name = ptr;
 		if (spl_phase() == PHASE_SPL)
 			rec->name = strdup(ptr);
+		/* The name is no longer one which may be freed */
+		rec->flags &= ~BOOTSTAGEF_CMD;
 
 		/* Assume no data corruption here */
 		ptr += strlen(ptr) + 1;
@@ -516,6 +754,13 @@ int bootstage_get_size(void)
 	return size;
 }
 
+uint bootstage_get_rec_count(void)
+{
+	struct bootstage_data *data = gd->bootstage;
+
+	return data ? data->rec_count : 0;
+}
+
 int bootstage_init(bool first)
 {
 	struct bootstage_data *data;
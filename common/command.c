@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <compiler.h>
 #include <command.h>
 #include <console.h>
@@ -576,9 +577,14 @@ int cmd_discard_repeatable(struct cmd_tbl *cmdtp, int flag, int argc,
 static int cmd_call(struct cmd_tbl *cmdtp, int flag, int argc,
 		    char *const argv[], int *repeatable)
 {
+	struct bootstage_span span;
 	int result;
 
+	if (IS_ENABLED(CONFIG_BOOTSTAGE_CMD))
+		bootstage_span_start(&span);
 	result = cmdtp->cmd_rep(cmdtp, flag, argc, argv, repeatable);
+	if (IS_ENABLED(CONFIG_BOOTSTAGE_CMD))
+		bootstage_cmd(&span, argc, argv);
 	if (result)
 		debug("Command failed, result=%d\n", result);
 	return result;
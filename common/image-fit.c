@@ -21,6 +21,7 @@
 #include <mapmem.h>
 #include <asm/io.h>
 #include <malloc.h>
+#include <worker.h>
 DECLARE_GLOBAL_DATA_PTR;
 #endif /* !USE_HOSTCC*/
 
@@ -1226,6 +1227,241 @@ int calculate_hash(const void *data, int data_len, const char *algo,
 	return 0;
 }
 
+#if IMAGE_ENABLE_FIT_WORKER
+/*
+ * While bootm verifies and loads the first image of a configuration, the
+ * hashes of the other images are computed on the worker core. The results
+ * are looked up by hash node and image data when those images are verified.
+ *
+ * Results only live within one bootm call, until the images are loaded.
+ * Every write to memory in that time is an image load, which drops the
+ * results for images in the memory written. When signatures are required,
+ * nothing is computed ahead, so what is verified is always the data as it
+ * is at that time.
+ */
+#define FIT_WORKER_MAX_HASHES	16
+
+struct fit_worker_hash {
+	struct worker_job job;
+	const void *fit;		/* NULL once the result is used */
+	int noffset;			/* hash node */
+	const void *data;
+	size_t size;
+	const char *algo;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+	int ret;
+};
+
+static struct fit_worker_hash fit_worker_hashes[FIT_WORKER_MAX_HASHES];
+static int fit_worker_count;
+static bool fit_worker_active;
+static const void *fit_worker_fit;
+static int fit_worker_cfg = -1;
+
+/* Configuration properties naming images, roughly in the order bootm loads */
+static const char *const fit_worker_props[] = {
+	FIT_KERNEL_PROP,
+	FIT_RAMDISK_PROP,
+	FIT_FDT_PROP,
+	FIT_FPGA_PROP,
+	FIT_LOADABLE_PROP,
+	FIT_FIRMWARE_PROP,
+	FIT_SETUP_PROP,
+};
+
+static void fit_worker_hash_job(void *arg)
+{
+	struct fit_worker_hash *hash = arg;
+
+	hash->ret = calculate_hash(hash->data, hash->size, hash->algo,
+				   hash->value, &hash->value_len);
+}
+
+/* Check whether the control FDT requires images or configs to be signed */
+static bool fit_worker_sigs_required(void)
+{
+	const void *sig_blob = gd_fdt_blob();
+	int sig_node, noffset;
+
+	if (!IMAGE_ENABLE_VERIFY || !sig_blob)
+		return false;
+
+	sig_node = fdt_subnode_offset(sig_blob, 0, FIT_SIG_NODENAME);
+	if (sig_node < 0)
+		return false;
+	fdt_for_each_subnode(noffset, sig_blob, sig_node) {
+		if (fdt_getprop(sig_blob, noffset, FIT_KEY_REQUIRED, NULL))
+			return true;
+	}
+
+	return false;
+}
+
+static void fit_worker_reset(void)
+{
+	int i;
+
+	for (i = 0; i < fit_worker_count; i++)
+		worker_wait(&fit_worker_hashes[i].job);
+	fit_worker_count = 0;
+	fit_worker_fit = NULL;
+	fit_worker_cfg = -1;
+}
+
+void fit_hash_worker_begin(void)
+{
+	fit_worker_reset();
+	fit_worker_active = true;
+}
+
+void fit_hash_worker_end(void)
+{
+	fit_worker_reset();
+	fit_worker_active = false;
+}
+
+void fit_hash_worker_invalidate(ulong addr, ulong size)
+{
+	struct fit_worker_hash *hash;
+	ulong start;
+	int i;
+
+	for (i = 0; i < fit_worker_count; i++) {
+		hash = &fit_worker_hashes[i];
+		if (!hash->fit)
+			continue;
+		start = map_to_sysmem(hash->data);
+		if (start < addr + size && addr < start + hash->size) {
+			worker_wait(&hash->job);
+			hash->fit = NULL;
+		}
+	}
+}
+
+static struct fit_worker_hash *fit_worker_find(const void *fit, int noffset)
+{
+	int i;
+
+	for (i = 0; i < fit_worker_count; i++) {
+		if (fit_worker_hashes[i].fit == fit &&
+		    fit_worker_hashes[i].noffset == noffset)
+			return &fit_worker_hashes[i];
+	}
+
+	return NULL;
+}
+
+static void fit_worker_queue_image(const void *fit, int image_noffset)
+{
+	struct fit_worker_hash *hash;
+	const void *data;
+	size_t size;
+	char *algo;
+	int noffset, ignore;
+
+	if (fit_image_get_data_and_size(fit, image_noffset, &data, &size))
+		return;
+
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		const char *name = fit_get_name(fit, noffset, NULL);
+
+		if (strncmp(name, FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+		if (fit_worker_count == FIT_WORKER_MAX_HASHES)
+			return;
+		if (fit_worker_find(fit, noffset) ||
+		    fit_image_hash_get_algo(fit, noffset, &algo))
+			continue;
+		fit_image_hash_get_ignore(fit, noffset, &ignore);
+		if (ignore)
+			continue;
+
+		hash = &fit_worker_hashes[fit_worker_count];
+		hash->fit = fit;
+		hash->noffset = noffset;
+		hash->data = data;
+		hash->size = size;
+		hash->algo = algo;
+		if (worker_queue(&hash->job, fit_worker_hash_job, hash))
+			return;
+		fit_worker_count++;
+	}
+}
+
+/**
+ * fit_worker_queue_conf() - queue the hashes of the images of a configuration
+ *
+ * @fit: pointer to the FIT format image header
+ * @cfg_noffset: configuration node offset
+ * @prop_name: property of the image being loaded now, which is verified by
+ *	the caller itself
+ */
+static void fit_worker_queue_conf(const void *fit, int cfg_noffset,
+				  const char *prop_name)
+{
+	int i, j, count, noffset;
+
+	if (!fit_worker_active || fit_worker_sigs_required())
+		return;
+	if (fit == fit_worker_fit && cfg_noffset == fit_worker_cfg)
+		return;
+	fit_worker_reset();
+	fit_worker_fit = fit;
+	fit_worker_cfg = cfg_noffset;
+
+	for (i = 0; i < ARRAY_SIZE(fit_worker_props); i++) {
+		if (!strcmp(fit_worker_props[i], prop_name))
+			continue;
+		count = fit_conf_get_prop_node_count(fit, cfg_noffset,
+						     fit_worker_props[i]);
+		for (j = 0; j < count; j++) {
+			noffset = fit_conf_get_prop_node_index(fit, cfg_noffset,
+							fit_worker_props[i], j);
+			if (noffset >= 0)
+				fit_worker_queue_image(fit, noffset);
+		}
+	}
+}
+
+/*
+ * Get a hash computed by the worker core, waiting for it if needed. This
+ * returns -ENOENT if the hash must be computed again, from the data as it
+ * is now.
+ */
+static int fit_worker_get_hash(const void *fit, int noffset, const void *data,
+			       size_t size, uint8_t *value, int *value_len)
+{
+	struct fit_worker_hash *hash;
+
+	hash = fit_worker_find(fit, noffset);
+	if (!hash || hash->data != data || hash->size != size)
+		return -ENOENT;
+
+	worker_wait(&hash->job);
+	hash->fit = NULL;
+	if (hash->ret || fit_worker_sigs_required())
+		return -ENOENT;
+	memcpy(value, hash->value, hash->value_len);
+	*value_len = hash->value_len;
+
+	return 0;
+}
+#else
+static inline void fit_worker_queue_conf(const void *fit, int cfg_noffset,
+					 const char *prop_name)
+{
+}
+
+static inline int fit_worker_get_hash(const void *fit, int noffset,
+				      const void *data, size_t size,
+				      uint8_t *value, int *value_len)
+{
+	return -ENOENT;
+}
+#endif /* IMAGE_ENABLE_FIT_WORKER */
+
 static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 				size_t size, char **err_msgp)
 {
@@ -1258,7 +1494,8 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	if (fit_worker_get_hash(fit, noffset, data, size, value, &value_len) &&
+	    calculate_hash(data, size, algo, value, &value_len)) {
 		*err_msgp = "Unsupported hash algorithm";
 		return -1;
 	}
@@ -1949,6 +2186,10 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 		if (image_type == IH_TYPE_KERNEL)
 			images->fit_uname_cfg = fit_base_uname_config;
 
+		/* Let the worker core hash the other images meanwhile */
+		if (images->verify)
+			fit_worker_queue_conf(fit, cfg_noffset, prop_name);
+
 		if (FIT_IMAGE_ENABLE_VERIFY && images->verify) {
 			puts("   Verifying Hash Integrity ... ");
 			if (fit_config_verify(fit, cfg_noffset)) {
@@ -2044,8 +2285,11 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 	}
 
 	/* perform any post-processing on the image data */
-	if (!host_build() && IS_ENABLED(CONFIG_FIT_IMAGE_POST_PROCESS))
+	if (!host_build() && IS_ENABLED(CONFIG_FIT_IMAGE_POST_PROCESS)) {
+		/* this may change the data in place */
+		fit_hash_worker_invalidate(map_to_sysmem(buf), size);
 		board_fit_image_post_process(&buf, &size);
+	}
 
 	len = (ulong)size;
 
@@ -2107,9 +2351,11 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 			return -ENOEXEC;
 		}
 		len = load_end - load;
+		fit_hash_worker_invalidate(load, len);
 	} else if (load != data) {
 		loadbuf = map_sysmem(load, len);
 		memcpy(loadbuf, buf, len);
+		fit_hash_worker_invalidate(load, len);
 	}
 
 	if (image_type == IH_TYPE_RAMDISK && comp != IH_COMP_NONE)
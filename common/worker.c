@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Jobs for a secondary CPU core
+ *
+ * The queue is a ring of job pointers with a single producer, the boot CPU,
+ * and a single consumer, the secondary core. Each side only writes its own
+ * index, so no locking is needed, just barriers.
+ *
+ * Before an OS is started the secondary core is stopped again, since the OS
+ * takes over the memory holding its code, stack and translation table.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <worker.h>
+#include <asm/io.h>
+
+#define WORKER_QUEUE_LEN	32
+
+static struct worker_job *worker_ring[WORKER_QUEUE_LEN];
+static volatile uint worker_head;	/* written by the boot CPU */
+static volatile uint worker_tail;	/* written by the secondary core */
+static volatile bool worker_stopping;	/* set by worker_stop() */
+static int worker_ret = -EAGAIN;	/* result of arch_worker_start() */
+
+void worker_main(void)
+{
+	struct worker_job *job;
+
+	for (;;) {
+		while (worker_tail == worker_head) {
+			if (worker_stopping)
+				return;
+			arch_worker_idle();
+		}
+		mb();
+
+		job = worker_ring[worker_tail % WORKER_QUEUE_LEN];
+		job->func(job->arg);
+
+		/* The job's results must be visible before it is marked done */
+		mb();
+		job->done = true;
+		worker_tail++;
+		mb();
+		arch_worker_kick();
+	}
+}
+
+int worker_init(void)
+{
+	if (worker_ret == -EAGAIN) {
+		worker_ret = arch_worker_start(worker_main);
+		if (worker_ret)
+			log_warning("Cannot start secondary core (err=%d)\n",
+				    worker_ret);
+	}
+
+	return worker_ret;
+}
+
+void worker_stop(void)
+{
+	int ret;
+
+	if (worker_ret)
+		return;
+
+	/* Let the queued jobs finish, their owners may still wait for them */
+	while (worker_tail != worker_head)
+		arch_worker_idle();
+
+	worker_stopping = true;
+	mb();
+	arch_worker_kick();
+	ret = arch_worker_stop();
+	if (ret)
+		log_warning("Secondary core did not stop cleanly (err=%d)\n",
+			    ret);
+	worker_stopping = false;
+	worker_ret = -EAGAIN;
+}
+
+int worker_queue(struct worker_job *job, void (*func)(void *arg), void *arg)
+{
+	int ret;
+
+	ret = worker_init();
+	if (ret)
+		return ret;
+	if (worker_head - worker_tail >= WORKER_QUEUE_LEN)
+		return -EBUSY;
+
+	job->func = func;
+	job->arg = arg;
+	job->done = false;
+	worker_ring[worker_head % WORKER_QUEUE_LEN] = job;
+
+	/* Publish the job before the secondary core can see the new head */
+	mb();
+	worker_head++;
+	mb();
+	arch_worker_kick();
+
+	return 0;
+}
+
+bool worker_done(struct worker_job *job)
+{
+	if (!job->done)
+		return false;
+	mb();
+
+	return true;
+}
+
+void worker_wait(struct worker_job *job)
+{
+	while (!worker_done(job))
+		arch_worker_idle();
+}
@@ -6,6 +6,7 @@
 
 #include <common.h>
 #include <blk.h>
+#include <bootstage.h>
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
@@ -432,12 +433,23 @@ int blk_get_device(int if_type, int devnum, struct udevice **devp)
 	return device_probe(*devp);
 }
 
+/* Count the blocks transferred by a device for bootstage */
+static void blk_count_io(struct blk_desc *desc, bool write, ulong blks)
+{
+	/* Drivers return -ve error codes as an unsigned long */
+	if (IS_ERR_VALUE(blks))
+		return;
+	bootstage_blk_io(write, blks * desc->blksz);
+}
+
 unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 			lbaint_t blkcnt, void *buffer)
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
 	ulong blks_read;
+	lbaint_t count;
+	void *rabuf;
 
 	if (!ops->read)
 		return -ENOSYS;
@@ -445,7 +457,19 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	if (blkcache_read(block_dev->if_type, block_dev->devnum,
 			  start, blkcnt, block_dev->blksz, buffer))
 		return blkcnt;
+
+	/* Read the following blocks in the same transfer if sequential */
+	rabuf = blkcache_readahead(block_dev, start, blkcnt, &count);
+	if (rabuf && ops->read(dev, start, count, rabuf) == count) {
+		blk_count_io(block_dev, false, count);
+		blkcache_fill(block_dev->if_type, block_dev->devnum,
+			      start, count, block_dev->blksz, rabuf);
+		memcpy(buffer, rabuf, blkcnt * block_dev->blksz);
+		return blkcnt;
+	}
+
 	blks_read = ops->read(dev, start, blkcnt, buffer);
+	blk_count_io(block_dev, false, blks_read);
 	if (blks_read == blkcnt)
 		blkcache_fill(block_dev->if_type, block_dev->devnum,
 			      start, blkcnt, block_dev->blksz, buffer);
@@ -453,17 +477,135 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	return blks_read;
 }
 
+static void blk_req_finish(struct blk_req *req, long result, bool fill)
+{
+	struct blk_desc *desc = req->desc;
+
+	if (fill && result == req->blkcnt)
+		blkcache_fill(desc->if_type, desc->devnum, req->start,
+			      req->blkcnt, desc->blksz, req->buffer);
+	req->result = result;
+	if (req->complete)
+		req->complete(req);
+}
+
+int blk_dread_async(struct blk_desc *block_dev, lbaint_t start,
+		    lbaint_t blkcnt, void *buffer, struct blk_req *req)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong blks_read;
+	int ret;
+
+	if (!ops->read)
+		return -ENOSYS;
+
+	req->desc = block_dev;
+	req->start = start;
+	req->blkcnt = blkcnt;
+	req->buffer = buffer;
+	req->write = false;
+	req->result = -EINPROGRESS;
+	req->done = 0;
+
+	if (blkcache_read(block_dev->if_type, block_dev->devnum,
+			  start, blkcnt, block_dev->blksz, buffer)) {
+		blk_req_finish(req, blkcnt, false);
+		return 0;
+	}
+
+	if (ops->read_async && ops->poll) {
+		ret = ops->read_async(dev, req);
+		if (ret != -ENOSYS)
+			return ret;
+	}
+
+	/* No asynchronous read available, the request finishes right away */
+	blks_read = ops->read(dev, start, blkcnt, buffer);
+	blk_count_io(block_dev, false, blks_read);
+	blk_req_finish(req, blks_read == blkcnt ? blkcnt : -EIO, true);
+
+	return 0;
+}
+
+long blk_poll(struct blk_req *req)
+{
+	struct udevice *dev = req->desc->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	long ret;
+
+	if (req->result != -EINPROGRESS)
+		return req->result;
+
+	ret = ops->poll(dev, req);
+	if (ret != -EINPROGRESS) {
+		blk_count_io(req->desc, req->write, ret);
+		blk_req_finish(req, ret, !req->write);
+	}
+
+	return ret;
+}
+
+long blk_wait(struct blk_req *req)
+{
+	long ret;
+
+	do {
+		ret = blk_poll(req);
+	} while (ret == -EINPROGRESS);
+
+	return ret;
+}
+
 unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt, const void *buffer)
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong blks_written;
 
 	if (!ops->write)
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
-	return ops->write(dev, start, blkcnt, buffer);
+	blks_written = ops->write(dev, start, blkcnt, buffer);
+	blk_count_io(block_dev, true, blks_written);
+
+	return blks_written;
+}
+
+int blk_dwrite_async(struct blk_desc *block_dev, lbaint_t start,
+		     lbaint_t blkcnt, const void *buffer, struct blk_req *req)
+{
+	struct udevice *dev = block_dev->bdev;
+	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong blks_written;
+	int ret;
+
+	if (!ops->write)
+		return -ENOSYS;
+
+	req->desc = block_dev;
+	req->start = start;
+	req->blkcnt = blkcnt;
+	req->buffer = (void *)buffer;
+	req->write = true;
+	req->result = -EINPROGRESS;
+	req->done = 0;
+
+	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	if (ops->write_async && ops->poll) {
+		ret = ops->write_async(dev, req);
+		if (ret != -ENOSYS)
+			return ret;
+	}
+
+	/* No asynchronous write available, the request finishes right away */
+	blks_written = ops->write(dev, start, blkcnt, buffer);
+	blk_count_io(block_dev, true, blks_written);
+	blk_req_finish(req, blks_written == blkcnt ? blkcnt : -EIO, false);
+
+	return 0;
 }
 
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
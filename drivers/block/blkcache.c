@@ -3,40 +3,129 @@
  * Copyright (C) Nelson Integration, LLC 2016
  * Author: Eric Nelson<eric@nelint.com>
  *
+ * The cache is made of lines, each holding the blocks of one aligned range
+ * of a device. Lines are looked up through a hash table. Each device has its
+ * own memory budget, so that reading one device does not evict the cached
+ * metadata of another.
+ *
+ * Lines come in size classes, each with its own LRU list and half of the
+ * budget. Small reads, such as those of directories and inodes, are kept in
+ * small lines. Larger reads and read-ahead go to large lines, so that
+ * reading a file does not evict the metadata which was read before it.
+ *
+ * When a read misses and starts right after the previous read of the same
+ * device, the blocks after it are read as well, in the same transfer.
  */
 #include <common.h>
 #include <blk.h>
 #include <log.h>
 #include <malloc.h>
+#include <memalign.h>
 #include <part.h>
+#include <linux/bitops.h>
 #include <linux/ctype.h>
 #include <linux/list.h>
+#include <linux/sizes.h>
 
 #ifdef CONFIG_NEEDS_MANUAL_RELOC
 DECLARE_GLOBAL_DATA_PTR;
 #endif
 
-struct block_cache_node {
-	struct list_head lh;
+#define BLKCACHE_HASH_SIZE	256
+/* Reads larger than this are not cached by default */
+#define BLKCACHE_MAX_BLOCKS	32
+/* Lines hold at most this many blocks, the size of the bitmaps */
+#define BLKCACHE_LINE_BLOCKS	32
+
+enum {
+	BLKCACHE_SMALL,		/* reads of up to one small line */
+	BLKCACHE_LARGE,		/* larger reads and read-ahead */
+};
+
+/* Line size of each class in bytes */
+static const uint line_sizes[BLKCACHE_CLASSES] = {
+	[BLKCACHE_SMALL]	= SZ_4K,
+	[BLKCACHE_LARGE]	= SZ_16K,
+};
+
+/**
+ * struct block_cache_class - lines of one size class of a device
+ *
+ * @lru:	Lines of this class, most recently used first
+ * @line_blocks: Number of blocks per line
+ * @lines:	Number of lines allocated
+ * @max_lines:	Number of lines allowed by the memory budget
+ */
+struct block_cache_class {
+	struct list_head lru;
+	uint line_blocks;
+	uint lines;
+	uint max_lines;
+};
+
+/**
+ * struct block_cache_dev - cache state of one block device
+ *
+ * @list:	Node in block_cache_devs
+ * @iftype:	IF_TYPE_x for type of device
+ * @devnum:	Device index of particular type
+ * @blksz:	Block size in bytes
+ * @cls:	Size classes, see BLKCACHE_SMALL and BLKCACHE_LARGE
+ * @next:	Block after the last read, to detect sequential access
+ * @ra_start:	First block read ahead by the pending read-ahead
+ * @ra_end:	Block after the pending read-ahead, 0 if none
+ * @stats:	Statistics, reset when they are shown
+ */
+struct block_cache_dev {
+	struct list_head list;
 	int iftype;
 	int devnum;
-	lbaint_t start;
-	lbaint_t blkcnt;
 	unsigned long blksz;
-	char *cache;
+	struct block_cache_class cls[BLKCACHE_CLASSES];
+	lbaint_t next;
+	lbaint_t ra_start;
+	lbaint_t ra_end;
+	struct block_cache_stats stats;
 };
 
-static LIST_HEAD(block_cache);
+/**
+ * struct block_cache_line - one cached range of blocks
+ *
+ * @lru:	Node in the LRU list of the class
+ * @hash:	Node in the hash chain
+ * @cls:	Size class of the line, which belongs to one device
+ * @start:	First block of the line, aligned to the line size
+ * @valid:	Bitmap of the blocks held in @data
+ * @ahead:	Bitmap of the blocks which were read ahead and not used yet
+ * @data:	Block data
+ */
+struct block_cache_line {
+	struct list_head lru;
+	struct hlist_node hash;
+	struct block_cache_class *cls;
+	lbaint_t start;
+	u32 valid;
+	u32 ahead;
+	char data[];
+};
+
+static LIST_HEAD(block_cache_devs);
+static struct hlist_head block_cache_hash[BLKCACHE_HASH_SIZE];
 
-static struct block_cache_stats _stats = {
-	.max_blocks_per_entry = 8,
-	.max_entries = 32
+static struct block_cache_config _config = {
+	.size_kib = CONFIG_BLOCK_CACHE_SIZE,
+	.readahead = CONFIG_BLOCK_CACHE_READAHEAD,
+	.max_blocks = BLKCACHE_MAX_BLOCKS,
 };
 
+/* Buffer for reads extended by read-ahead */
+static void *ra_buf;
+static size_t ra_buf_size;
+
 #ifdef CONFIG_NEEDS_MANUAL_RELOC
 int blkcache_init(void)
 {
-	struct list_head *head = &block_cache;
+	struct list_head *head = &block_cache_devs;
 
 	head->next = (uintptr_t)head->next + gd->reloc_off;
 	head->prev = (uintptr_t)head->prev + gd->reloc_off;
@@ -45,145 +134,370 @@ int blkcache_init(void)
 }
 #endif
 
-static struct block_cache_node *cache_find(int iftype, int devnum,
-					   lbaint_t start, lbaint_t blkcnt,
-					   unsigned long blksz)
-{
-	struct block_cache_node *node;
-
-	list_for_each_entry(node, &block_cache, lh)
-		if ((node->iftype == iftype) &&
-		    (node->devnum == devnum) &&
-		    (node->blksz == blksz) &&
-		    (node->start <= start) &&
-		    (node->start + node->blkcnt >= start + blkcnt)) {
-			if (block_cache.next != &node->lh) {
-				/* maintain MRU ordering */
-				list_del(&node->lh);
-				list_add(&node->lh, &block_cache);
-			}
-			return node;
-		}
-	return 0;
+static struct hlist_head *line_bucket(struct block_cache_class *cls,
+				      lbaint_t start)
+{
+	ulong key = (ulong)(start / cls->line_blocks) * 0x9e3779b1;
+
+	key ^= (ulong)cls >> 4;
+
+	return &block_cache_hash[(key ^ key >> 16) % BLKCACHE_HASH_SIZE];
+}
+
+static struct block_cache_line *line_find(struct block_cache_class *cls,
+					  lbaint_t start)
+{
+	struct block_cache_line *line;
+	struct hlist_node *node;
+
+	hlist_for_each_entry(line, node, line_bucket(cls, start), hash) {
+		if (line->cls == cls && line->start == start)
+			return line;
+	}
+
+	return NULL;
+}
+
+static void line_free(struct block_cache_line *line)
+{
+	list_del(&line->lru);
+	hlist_del(&line->hash);
+	line->cls->lines--;
+	free(line);
+}
+
+static void dev_free_lines(struct block_cache_dev *dev)
+{
+	struct block_cache_line *line, *next;
+	int i;
+
+	for (i = 0; i < BLKCACHE_CLASSES; i++) {
+		list_for_each_entry_safe(line, next, &dev->cls[i].lru, lru)
+			line_free(line);
+	}
+	dev->next = 0;
+	dev->ra_end = 0;
+}
+
+static void dev_setup(struct block_cache_dev *dev)
+{
+	struct block_cache_class *cls;
+	int i;
+
+	for (i = 0; i < BLKCACHE_CLASSES; i++) {
+		cls = &dev->cls[i];
+		cls->max_lines = _config.size_kib * 1024 / BLKCACHE_CLASSES /
+				 (cls->line_blocks * dev->blksz);
+	}
+}
+
+static struct block_cache_dev *dev_find(int iftype, int devnum,
+					unsigned long blksz, bool create)
+{
+	struct block_cache_dev *dev;
+	int i;
+
+	list_for_each_entry(dev, &block_cache_devs, list) {
+		if (dev->iftype == iftype && dev->devnum == devnum &&
+		    dev->blksz == blksz)
+			return dev;
+	}
+
+	if (!create || !blksz)
+		return NULL;
+
+	dev = calloc(1, sizeof(*dev));
+	if (!dev)
+		return NULL;
+	dev->iftype = iftype;
+	dev->devnum = devnum;
+	dev->blksz = blksz;
+	for (i = 0; i < BLKCACHE_CLASSES; i++) {
+		INIT_LIST_HEAD(&dev->cls[i].lru);
+		dev->cls[i].line_blocks = clamp(line_sizes[i] / blksz, 1UL,
+						(ulong)BLKCACHE_LINE_BLOCKS);
+	}
+	dev_setup(dev);
+	list_add_tail(&dev->list, &block_cache_devs);
+
+	return dev;
+}
+
+/* Get the bitmap of the blocks of a line which are within a range */
+static u32 line_mask(struct block_cache_class *cls, lbaint_t line_start,
+		     lbaint_t start, lbaint_t end)
+{
+	uint first = max(start, line_start) - line_start;
+	uint last = min(end, line_start + cls->line_blocks) - line_start;
+
+	return GENMASK(last - 1, first);
+}
+
+/* Get the end of the range from @start which is in one line of each class */
+static lbaint_t chunk_end(struct block_cache_dev *dev, lbaint_t start,
+			  lbaint_t end)
+{
+	lbaint_t line_end;
+	int i;
+
+	for (i = 0; i < BLKCACHE_CLASSES; i++) {
+		line_end = start - start % dev->cls[i].line_blocks +
+			   dev->cls[i].line_blocks;
+		end = min(end, line_end);
+	}
+
+	return end;
+}
+
+/* Find a line holding all blocks from @start to @end, in one line each */
+static struct block_cache_line *chunk_find(struct block_cache_dev *dev,
+					   lbaint_t start, lbaint_t end)
+{
+	struct block_cache_class *cls;
+	struct block_cache_line *line;
+	u32 mask;
+	int i;
+
+	for (i = 0; i < BLKCACHE_CLASSES; i++) {
+		cls = &dev->cls[i];
+		line = line_find(cls, start - start % cls->line_blocks);
+		if (!line)
+			continue;
+		mask = line_mask(cls, line->start, start, end);
+		if ((line->valid & mask) == mask)
+			return line;
+	}
+
+	return NULL;
 }
 
 int blkcache_read(int iftype, int devnum,
 		  lbaint_t start, lbaint_t blkcnt,
 		  unsigned long blksz, void *buffer)
 {
-	struct block_cache_node *node = cache_find(iftype, devnum, start,
-						   blkcnt, blksz);
-	if (node) {
-		const char *src = node->cache + (start - node->start) * blksz;
-		memcpy(buffer, src, blksz * blkcnt);
-		debug("hit: start " LBAF ", count " LBAFU "\n",
-		      start, blkcnt);
-		++_stats.hits;
-		return 1;
+	struct block_cache_dev *dev = dev_find(iftype, devnum, blksz, false);
+	struct block_cache_line *line;
+	lbaint_t end = start + blkcnt;
+	lbaint_t blk, to;
+	u32 mask;
+
+	if (!dev || !blkcnt || blkcnt > _config.max_blocks)
+		return 0;
+
+	/* The blocks may be spread over lines of different classes */
+	for (blk = start; blk < end; blk = to) {
+		to = chunk_end(dev, blk, end);
+		if (!chunk_find(dev, blk, to)) {
+			debug("miss: start " LBAF ", count " LBAFU "\n",
+			      start, blkcnt);
+			dev->stats.misses++;
+			return 0;
+		}
 	}
 
-	debug("miss: start " LBAF ", count " LBAFU "\n",
-	      start, blkcnt);
-	++_stats.misses;
-	return 0;
+	for (blk = start; blk < end; blk = to) {
+		to = chunk_end(dev, blk, end);
+		line = chunk_find(dev, blk, to);
+		mask = line_mask(line->cls, line->start, blk, to);
+		memcpy(buffer + (blk - start) * blksz,
+		       line->data + (blk - line->start) * blksz,
+		       (to - blk) * blksz);
+		dev->stats.prefetch_hits += hweight32(line->ahead & mask);
+		line->ahead &= ~mask;
+		list_move(&line->lru, &line->cls->lru);
+	}
+
+	debug("hit: start " LBAF ", count " LBAFU "\n", start, blkcnt);
+	dev->stats.hits++;
+	dev->next = end;
+
+	return 1;
+}
+
+void *blkcache_readahead(struct blk_desc *desc, lbaint_t start,
+			 lbaint_t blkcnt, lbaint_t *countp)
+{
+	struct block_cache_class *cls;
+	struct block_cache_dev *dev;
+	lbaint_t count;
+	bool sequential;
+	size_t size;
+
+	if (!_config.readahead || !blkcnt || blkcnt > _config.max_blocks)
+		return NULL;
+	dev = dev_find(desc->if_type, desc->devnum, desc->blksz, true);
+	if (!dev)
+		return NULL;
+	cls = &dev->cls[BLKCACHE_LARGE];
+
+	sequential = start && start == dev->next;
+	dev->next = start + blkcnt;
+	if (!sequential || start >= desc->lba)
+		return NULL;
+
+	count = min(blkcnt + _config.readahead, desc->lba - start);
+	/* Stay within the budget, the read-ahead must not evict itself */
+	count = min(count, (lbaint_t)(max(cls->max_lines, 1U) - 1) *
+		    cls->line_blocks);
+	if (count <= blkcnt)
+		return NULL;
+
+	size = count * desc->blksz;
+	if (size > ra_buf_size) {
+		free(ra_buf);
+		ra_buf_size = 0;
+		ra_buf = malloc_cache_aligned(size);
+		if (!ra_buf)
+			return NULL;
+		ra_buf_size = size;
+	}
+
+	debug("read-ahead: start " LBAF ", count " LBAFU "\n",
+	      start + blkcnt, count - blkcnt);
+	dev->ra_start = start + blkcnt;
+	dev->ra_end = start + count;
+	dev->stats.prefetched += count - blkcnt;
+	*countp = count;
+
+	return ra_buf;
+}
+
+static struct block_cache_line *line_get(struct block_cache_dev *dev,
+					 struct block_cache_class *cls,
+					 lbaint_t start)
+{
+	struct block_cache_line *line;
+
+	line = line_find(cls, start);
+	if (line)
+		return line;
+
+	if (cls->lines >= cls->max_lines) {
+		/* reuse the LRU line */
+		line = list_last_entry(&cls->lru, struct block_cache_line, lru);
+		debug("drop: start " LBAF "\n", line->start);
+		list_del(&line->lru);
+		hlist_del(&line->hash);
+	} else {
+		line = malloc(sizeof(*line) + cls->line_blocks * dev->blksz);
+		if (!line)
+			return NULL;
+		cls->lines++;
+	}
+
+	line->cls = cls;
+	line->start = start;
+	line->valid = 0;
+	line->ahead = 0;
+	list_add(&line->lru, &cls->lru);
+	hlist_add_head(&line->hash, line_bucket(cls, start));
+
+	return line;
 }
 
 void blkcache_fill(int iftype, int devnum,
 		   lbaint_t start, lbaint_t blkcnt,
 		   unsigned long blksz, void const *buffer)
 {
-	lbaint_t bytes;
-	struct block_cache_node *node;
+	struct block_cache_class *cls;
+	struct block_cache_dev *dev;
+	struct block_cache_line *line;
+	lbaint_t end = start + blkcnt;
+	lbaint_t blk, from, to;
+	lbaint_t ra_start = end;
+	u32 mask;
 
-	/* don't cache big stuff */
-	if (blkcnt > _stats.max_blocks_per_entry)
+	dev = dev_find(iftype, devnum, blksz, true);
+	if (!dev)
 		return;
 
-	if (_stats.max_entries == 0)
+	if (dev->ra_end == end && dev->ra_start > start) {
+		ra_start = dev->ra_start;
+	} else if (blkcnt > _config.max_blocks) {
+		/* don't cache big stuff */
 		return;
-
-	bytes = blksz * blkcnt;
-	if (_stats.max_entries <= _stats.entries) {
-		/* pop LRU */
-		node = (struct block_cache_node *)block_cache.prev;
-		list_del(&node->lh);
-		_stats.entries--;
-		debug("drop: start " LBAF ", count " LBAFU "\n",
-		      node->start, node->blkcnt);
-		if (node->blkcnt * node->blksz < bytes) {
-			free(node->cache);
-			node->cache = 0;
-		}
-	} else {
-		node = malloc(sizeof(*node));
-		if (!node)
-			return;
-		node->cache = 0;
 	}
+	dev->ra_end = 0;
 
-	if (!node->cache) {
-		node->cache = malloc(bytes);
-		if (!node->cache) {
-			free(node);
-			return;
-		}
-	}
+	cls = &dev->cls[BLKCACHE_SMALL];
+	if (ra_start != end || blkcnt > cls->line_blocks)
+		cls = &dev->cls[BLKCACHE_LARGE];
+	if (!cls->max_lines)
+		return;
 
-	debug("fill: start " LBAF ", count " LBAFU "\n",
-	      start, blkcnt);
+	debug("fill: start " LBAF ", count " LBAFU ", class %d\n", start,
+	      blkcnt, (int)(cls - dev->cls));
 
-	node->iftype = iftype;
-	node->devnum = devnum;
-	node->start = start;
-	node->blkcnt = blkcnt;
-	node->blksz = blksz;
-	memcpy(node->cache, buffer, bytes);
-	list_add(&node->lh, &block_cache);
-	_stats.entries++;
+	for (blk = start - start % cls->line_blocks; blk < end;
+	     blk += cls->line_blocks) {
+		line = line_get(dev, cls, blk);
+		if (!line)
+			return;
+		from = max(start, blk);
+		to = min(end, blk + cls->line_blocks);
+		memcpy(line->data + (from - blk) * blksz,
+		       buffer + (from - start) * blksz, (to - from) * blksz);
+		mask = line_mask(cls, blk, start, end);
+		line->valid |= mask;
+		line->ahead &= ~mask;
+		if (to > ra_start)
+			line->ahead |= line_mask(cls, blk, ra_start, end);
+	}
 }
 
 void blkcache_invalidate(int iftype, int devnum)
 {
-	struct list_head *entry, *n;
-	struct block_cache_node *node;
-
-	list_for_each_safe(entry, n, &block_cache) {
-		node = (struct block_cache_node *)entry;
-		if ((node->iftype == iftype) &&
-		    (node->devnum == devnum)) {
-			list_del(entry);
-			free(node->cache);
-			free(node);
-			--_stats.entries;
-		}
+	struct block_cache_dev *dev;
+
+	list_for_each_entry(dev, &block_cache_devs, list) {
+		if (dev->iftype == iftype && dev->devnum == devnum)
+			dev_free_lines(dev);
 	}
 }
 
-void blkcache_configure(unsigned blocks, unsigned entries)
+void blkcache_configure(const struct block_cache_config *config)
 {
-	struct block_cache_node *node;
-	if ((blocks != _stats.max_blocks_per_entry) ||
-	    (entries != _stats.max_entries)) {
-		/* invalidate cache */
-		while (!list_empty(&block_cache)) {
-			node = (struct block_cache_node *)block_cache.next;
-			list_del(&node->lh);
-			free(node->cache);
-			free(node);
-		}
-		_stats.entries = 0;
+	struct block_cache_dev *dev;
+
+	_config = *config;
+	list_for_each_entry(dev, &block_cache_devs, list) {
+		dev_free_lines(dev);
+		dev_setup(dev);
+		memset(&dev->stats, '\0', sizeof(dev->stats));
 	}
 
-	_stats.max_blocks_per_entry = blocks;
-	_stats.max_entries = entries;
+	free(ra_buf);
+	ra_buf = NULL;
+	ra_buf_size = 0;
+}
 
-	_stats.hits = 0;
-	_stats.misses = 0;
+void blkcache_get_config(struct block_cache_config *config)
+{
+	*config = _config;
 }
 
-void blkcache_stats(struct block_cache_stats *stats)
+int blkcache_stats(int index, struct block_cache_stats *stats)
 {
-	memcpy(stats, &_stats, sizeof(*stats));
-	_stats.hits = 0;
-	_stats.misses = 0;
+	struct block_cache_dev *dev;
+	int i;
+
+	list_for_each_entry(dev, &block_cache_devs, list) {
+		if (index--)
+			continue;
+		*stats = dev->stats;
+		stats->iftype = dev->iftype;
+		stats->devnum = dev->devnum;
+		stats->blksz = dev->blksz;
+		for (i = 0; i < BLKCACHE_CLASSES; i++) {
+			stats->cls[i].entries = dev->cls[i].lines;
+			stats->cls[i].max_entries = dev->cls[i].max_lines;
+			stats->cls[i].blocks_per_entry =
+				dev->cls[i].line_blocks;
+		}
+		memset(&dev->stats, '\0', sizeof(dev->stats));
+
+		return 0;
+	}
+
+	return -ENOENT;
 }
@@ -88,6 +88,35 @@ static unsigned long host_block_write(struct blk_desc *block_dev,
 }
 
 #ifdef CONFIG_BLK
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+/* The transfer is done when the request is polled for the first time */
+static int host_block_read_async(struct udevice *dev, struct blk_req *req)
+{
+	return 0;
+}
+
+static int host_block_write_async(struct udevice *dev, struct blk_req *req)
+{
+	return 0;
+}
+
+static long host_block_poll(struct udevice *dev, struct blk_req *req)
+{
+	ulong blks;
+
+	if (req->write)
+		blks = host_block_write(dev, req->start, req->blkcnt,
+					req->buffer);
+	else
+		blks = host_block_read(dev, req->start, req->blkcnt,
+				       req->buffer);
+	if (blks != req->blkcnt)
+		return -EIO;
+
+	return blks;
+}
+#endif
+
 int host_dev_bind(int devnum, char *filename)
 {
 	struct host_block_dev *host_dev;
@@ -222,6 +251,11 @@ int host_get_dev_err(int devnum, struct blk_desc **blk_devp)
 static const struct blk_ops sandbox_host_blk_ops = {
 	.read	= host_block_read,
 	.write	= host_block_write,
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	.read_async	= host_block_read_async,
+	.write_async	= host_block_write_async,
+	.poll		= host_block_poll,
+#endif
 };
 
 U_BOOT_DRIVER(sandbox_host_blk) = {
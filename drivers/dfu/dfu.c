@@ -167,6 +167,8 @@ done:
 
 static unsigned char *dfu_buf;
 static unsigned long dfu_buf_size;
+/* 2 if dfu_buf holds two buffers of dfu_buf_size for write-behind */
+static int dfu_buf_count;
 static enum dfu_device_type dfu_buf_device_type;
 
 unsigned char *dfu_free_buf(void)
@@ -202,7 +204,15 @@ unsigned char *dfu_get_buf(struct dfu_entity *dfu)
 	if (dfu->max_buf_size && dfu_buf_size > dfu->max_buf_size)
 		dfu_buf_size = dfu->max_buf_size;
 
-	dfu_buf = memalign(CONFIG_SYS_CACHELINE_SIZE, dfu_buf_size);
+	dfu_buf = NULL;
+	dfu_buf_count = 1;
+	if (CONFIG_IS_ENABLED(DFU_WRITE_BEHIND)) {
+		dfu_buf = memalign(CONFIG_SYS_CACHELINE_SIZE, 2 * dfu_buf_size);
+		if (dfu_buf)
+			dfu_buf_count = 2;
+	}
+	if (!dfu_buf)
+		dfu_buf = memalign(CONFIG_SYS_CACHELINE_SIZE, dfu_buf_size);
 	if (dfu_buf == NULL)
 		printf("%s: Could not memalign 0x%lx bytes\n",
 		       __func__, dfu_buf_size);
@@ -228,6 +238,72 @@ static char *dfu_get_hash_algo(void)
 	return NULL;
 }
 
+int dfu_write_poll(struct dfu_entity *dfu)
+{
+	int ret;
+
+	if (!dfu->wb_pending)
+		return 0;
+
+	ret = dfu->poll_medium(dfu);
+	if (ret == -EINPROGRESS)
+		return 0;
+	dfu->wb_pending = 0;
+	if (ret)
+		debug("%s: Write error!\n", __func__);
+
+	return ret;
+}
+
+/* Wait for the buffer written in the background, if any */
+static int dfu_write_wait(struct dfu_entity *dfu)
+{
+	int ret;
+
+	if (!dfu->wb_pending)
+		return 0;
+
+	do {
+		ret = dfu->poll_medium(dfu);
+	} while (ret == -EINPROGRESS);
+	dfu->wb_pending = 0;
+	if (ret)
+		debug("%s: Write error!\n", __func__);
+
+	return ret;
+}
+
+/*
+ * Start writing the current buffer in the background and continue in the
+ * other one. Returns -ENOSYS if the buffer must be written synchronously.
+ */
+static int dfu_write_behind(struct dfu_entity *dfu, long *w_size)
+{
+	int ret;
+
+	if (dfu_buf_count != 2 || !dfu->write_medium_async)
+		return -ENOSYS;
+
+	/* The other buffer is about to be reused */
+	ret = dfu_write_wait(dfu);
+	if (ret)
+		return ret;
+
+	ret = dfu->write_medium_async(dfu, dfu->offset, dfu->i_buf_start,
+				      w_size);
+	if (ret)
+		return ret;
+	dfu->wb_pending = 1;
+
+	if (dfu->i_buf_start == dfu_buf)
+		dfu->i_buf_start = dfu_buf + dfu_buf_size;
+	else
+		dfu->i_buf_start = dfu_buf;
+	dfu->i_buf_end = dfu->i_buf_start + dfu_buf_size;
+
+	return 0;
+}
+
 static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 {
 	long w_size;
@@ -242,7 +318,23 @@ static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc,
 					   dfu->i_buf_start, w_size, 0);
 
-	ret = dfu->write_medium(dfu, dfu->offset, dfu->i_buf_start, &w_size);
+	/* Sparse and compressed images are recognised by their start */
+	if (dfu->decode && !dfu->offset) {
+		ret = dfu_image_start(dfu, dfu->i_buf_start, w_size);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (dfu->decoding)
+		ret = dfu_image_write(dfu, dfu->i_buf_start, w_size);
+	else
+		ret = dfu_write_behind(dfu, &w_size);
+	if (ret == -ENOSYS) {
+		ret = dfu_write_wait(dfu);
+		if (!ret)
+			ret = dfu->write_medium(dfu, dfu->offset,
+						dfu->i_buf_start, &w_size);
+	}
 	if (ret)
 		debug("%s: Write error!\n", __func__);
 
@@ -259,6 +351,10 @@ static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 
 void dfu_transaction_cleanup(struct dfu_entity *dfu)
 {
+	/* the buffer must not be reused while it is written */
+	dfu_write_wait(dfu);
+	dfu_image_abort(dfu);
+
 	/* clear everything */
 	dfu->crc = 0;
 	dfu->offset = 0;
@@ -305,6 +401,10 @@ int dfu_flush(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	int ret = 0;
 
 	ret = dfu_write_buffer_drain(dfu);
+	if (!ret)
+		ret = dfu_write_wait(dfu);
+	if (!ret && dfu->decoding)
+		ret = dfu_image_finish(dfu);
 	if (ret)
 		return ret;
 
@@ -334,6 +434,12 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	if (ret < 0)
 		return ret;
 
+	ret = dfu_write_poll(dfu);
+	if (ret) {
+		dfu_transaction_cleanup(dfu);
+		return ret;
+	}
+
 	if (dfu->i_blk_seq_num != blk_seq_num) {
 		printf("%s: Wrong sequence number! [%d] [%d]\n",
 		       __func__, dfu->i_blk_seq_num, blk_seq_num);
@@ -374,7 +480,9 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 		return -1;
 	}
 
-	memcpy(dfu->i_buf, buf, size);
+	/* the data may have been received in place */
+	if (buf != dfu->i_buf)
+		memcpy(dfu->i_buf, buf, size);
 	dfu->i_buf += size;
 
 	/* if end or if buffer full flush */
@@ -526,6 +634,8 @@ void dfu_free_entities(void)
 {
 	struct dfu_entity *dfu, *p, *t = NULL;
 
+	list_for_each_entry(dfu, &dfu_list, list)
+		dfu_write_wait(dfu);
 	dfu_free_buf();
 	list_for_each_entry_safe_reverse(dfu, p, &dfu_list, list) {
 		list_del(&dfu->list);
@@ -0,0 +1,588 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decode Android sparse and gzip/zstd compressed images while they are
+ * written to a DFU entity
+ *
+ * The image arrives in DFU buffers of arbitrary size, so it is decoded as a
+ * stream: compressed data is inflated into a small buffer, and the result
+ * (or the received data itself) is passed through a sparse image parser
+ * which falls back to writing everything if it does not find a sparse
+ * header. Output is collected in a staging buffer so that the entity is
+ * always written in whole blocks.
+ */
+
+#include <common.h>
+#include <dfu.h>
+#include <errno.h>
+#include <image-sparse.h>
+#include <log.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <linux/kernel.h>
+#include <linux/math64.h>
+#include <linux/zstd.h>
+#include <u-boot/zlib.h>
+#include <asm/unaligned.h>
+
+/* Size of the staging buffer, a multiple of any block size */
+#define DFU_IMAGE_OUT_SIZE	SZ_1M
+/* Size of the buffer compressed data is inflated into */
+#define DFU_IMAGE_DEC_SIZE	SZ_128K
+/* Zero fills shorter than this are written rather than erased */
+#define DFU_IMAGE_MIN_ERASE	DFU_IMAGE_OUT_SIZE
+
+#define GZIP_MAGIC		0x8b1f
+#define ZSTD_MAGIC		0xfd2fb528
+
+enum dfu_image_comp {
+	DFU_IMAGE_NONE,
+	DFU_IMAGE_GZIP,
+	DFU_IMAGE_ZSTD,
+};
+
+enum dfu_image_state {
+	DFU_IMAGE_DETECT,	/* collecting what may be a sparse header */
+	DFU_IMAGE_RAW,		/* not sparse, everything is written */
+	DFU_IMAGE_CHUNK_HDR,	/* collecting a chunk header */
+	DFU_IMAGE_CHUNK_RAW,	/* writing the data of a raw chunk */
+	DFU_IMAGE_CHUNK_FILL,	/* collecting the value of a fill chunk */
+	DFU_IMAGE_SKIP,		/* skipping header or CRC32 chunk data */
+	DFU_IMAGE_DONE,		/* all chunks seen, the rest is ignored */
+};
+
+static struct dfu_image {
+	struct dfu_entity *dfu;
+	enum dfu_image_comp comp;
+	enum dfu_image_state state;
+	bool comp_end;		/* end of the compressed stream was seen */
+
+	/* Staging buffer, holding data for the entity at out_offset */
+	u8 *out;
+	ulong out_len;
+	u64 out_offset;
+
+	/* Sparse image parser */
+	u8 hdr[64];
+	uint hdr_len;
+	uint hdr_need;
+	u16 chunk_hdr_sz;
+	u32 blk_sz;
+	u32 chunks_left;
+	u64 chunk_left;
+
+	/* Decompression */
+	u8 *dec;
+#if CONFIG_IS_ENABLED(DFU_IMAGE_GZIP)
+	z_stream zs;
+#endif
+#if CONFIG_IS_ENABLED(DFU_IMAGE_ZSTD)
+	ZSTD_DStream *zds;
+	void *zws;
+#endif
+} dfu_image;
+
+static int dfu_image_flush(struct dfu_image *img, bool last)
+{
+	long len = img->out_len;
+	int ret;
+
+	if (!len)
+		return 0;
+
+	/* Whole blocks are written, pad the last one with zeroes */
+	if (last)
+		memset(img->out + len, '\0', DFU_IMAGE_OUT_SIZE - len);
+	ret = img->dfu->write_medium(img->dfu, img->out_offset, img->out,
+				     &len);
+	if (ret)
+		return ret;
+
+	img->out_offset += img->out_len;
+	img->out_len = 0;
+
+	return 0;
+}
+
+/* Continue writing at @offset, leaving what is in between untouched */
+static int dfu_image_seek(struct dfu_image *img, u64 offset)
+{
+	int ret;
+
+	ret = dfu_image_flush(img, false);
+	if (ret)
+		return ret;
+	img->out_offset = offset;
+
+	return 0;
+}
+
+static int dfu_image_out(struct dfu_image *img, const void *data, ulong len)
+{
+	ulong n;
+	int ret;
+
+	while (len) {
+		n = min(len, DFU_IMAGE_OUT_SIZE - img->out_len);
+		memcpy(img->out + img->out_len, data, n);
+		img->out_len += n;
+		data += n;
+		len -= n;
+		if (img->out_len == DFU_IMAGE_OUT_SIZE) {
+			ret = dfu_image_flush(img, false);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Write @len bytes of a 32-bit pattern, @len is a multiple of 4 */
+static int dfu_image_fill(struct dfu_image *img, u32 value, u64 len)
+{
+	ulong i, n;
+	u32 *p;
+	int ret;
+
+	while (len) {
+		n = min_t(u64, len, DFU_IMAGE_OUT_SIZE - img->out_len);
+		p = (u32 *)(img->out + img->out_len);
+		for (i = 0; i < n / sizeof(u32); i++)
+			p[i] = value;
+		img->out_len += n;
+		len -= n;
+		if (img->out_len == DFU_IMAGE_OUT_SIZE) {
+			ret = dfu_image_flush(img, false);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Zero @len bytes, erasing whatever part of them the entity can erase */
+static int dfu_image_zero(struct dfu_image *img, u64 len)
+{
+	struct dfu_entity *dfu = img->dfu;
+	u64 pos = img->out_offset + img->out_len;
+	u32 size = dfu->erase_size;
+	u64 start, end;
+	int ret;
+
+	if (!size || !dfu->erase_medium || len < DFU_IMAGE_MIN_ERASE)
+		return dfu_image_fill(img, 0, len);
+
+	start = div_u64(pos + size - 1, size) * size;
+	end = div_u64(pos + len, size) * size;
+	if (end <= start)
+		return dfu_image_fill(img, 0, len);
+
+	ret = dfu_image_fill(img, 0, start - pos);
+	if (!ret)
+		ret = dfu_image_flush(img, false);
+	if (!ret)
+		ret = dfu->erase_medium(dfu, start, end - start);
+	if (ret)
+		return ret;
+	img->out_offset = end;
+
+	return dfu_image_fill(img, 0, pos + len - end);
+}
+
+/* Collect img->hdr_need bytes in img->hdr, returns true once they are there */
+static bool dfu_image_collect(struct dfu_image *img, const u8 **data,
+			      ulong *len)
+{
+	uint n = min_t(ulong, *len, img->hdr_need - img->hdr_len);
+
+	memcpy(img->hdr + img->hdr_len, *data, n);
+	img->hdr_len += n;
+	*data += n;
+	*len -= n;
+
+	return img->hdr_len == img->hdr_need;
+}
+
+static void dfu_image_expect(struct dfu_image *img,
+			     enum dfu_image_state state, uint need)
+{
+	img->state = state;
+	img->hdr_len = 0;
+	img->hdr_need = need;
+}
+
+/* Skip @len bytes of input before the next chunk header */
+static void dfu_image_skip(struct dfu_image *img, u64 len)
+{
+	img->chunk_left = len;
+	if (len)
+		img->state = DFU_IMAGE_SKIP;
+	else
+		dfu_image_expect(img, DFU_IMAGE_CHUNK_HDR, img->chunk_hdr_sz);
+}
+
+static int dfu_image_sparse_header(struct dfu_image *img)
+{
+	sparse_header_t *hdr = (sparse_header_t *)img->hdr;
+	u64 size, medium_size;
+	int ret;
+
+	img->blk_sz = le32_to_cpu(hdr->blk_sz);
+	img->chunk_hdr_sz = le16_to_cpu(hdr->chunk_hdr_sz);
+	img->chunks_left = le32_to_cpu(hdr->total_chunks);
+	size = (u64)img->blk_sz * le32_to_cpu(hdr->total_blks);
+
+	/* Data for the entity must stay block aligned */
+	if (!img->blk_sz || img->blk_sz % SZ_512 ||
+	    le16_to_cpu(hdr->file_hdr_sz) < sizeof(sparse_header_t) ||
+	    img->chunk_hdr_sz < sizeof(chunk_header_t) ||
+	    img->chunk_hdr_sz > sizeof(img->hdr)) {
+		pr_err("Unsupported sparse image\n");
+		return -EINVAL;
+	}
+
+	ret = img->dfu->get_medium_size(img->dfu, &medium_size);
+	if (ret < 0)
+		return ret;
+	if (size > medium_size) {
+		pr_err("Sparse image (%llu bytes) larger than %s\n", size,
+		       img->dfu->name);
+		return -EFBIG;
+	}
+
+	printf("\nDFU %s: sparse image, %u blocks of %u bytes in %u chunks\n",
+	       img->dfu->name, le32_to_cpu(hdr->total_blks), img->blk_sz,
+	       img->chunks_left);
+	dfu_image_skip(img, le16_to_cpu(hdr->file_hdr_sz) - sizeof(*hdr));
+
+	return 0;
+}
+
+static int dfu_image_chunk_header(struct dfu_image *img)
+{
+	chunk_header_t *chunk = (chunk_header_t *)img->hdr;
+	u32 total_sz = le32_to_cpu(chunk->total_sz);
+	u64 size = (u64)img->blk_sz * le32_to_cpu(chunk->chunk_sz);
+	u32 data_sz = total_sz - img->chunk_hdr_sz;
+
+	if (total_sz < img->chunk_hdr_sz)
+		goto bad_chunk;
+
+	img->chunks_left--;
+	switch (le16_to_cpu(chunk->chunk_type)) {
+	case CHUNK_TYPE_RAW:
+		if (data_sz != size)
+			goto bad_chunk;
+		img->chunk_left = size;
+		img->state = DFU_IMAGE_CHUNK_RAW;
+		if (!size)
+			dfu_image_skip(img, 0);
+		break;
+	case CHUNK_TYPE_FILL:
+		if (data_sz != sizeof(u32))
+			goto bad_chunk;
+		img->chunk_left = size;
+		dfu_image_expect(img, DFU_IMAGE_CHUNK_FILL, sizeof(u32));
+		break;
+	case CHUNK_TYPE_DONT_CARE:
+		if (data_sz)
+			goto bad_chunk;
+		dfu_image_skip(img, 0);
+		return dfu_image_seek(img, img->out_offset + img->out_len +
+				      size);
+	case CHUNK_TYPE_CRC32:
+		dfu_image_skip(img, data_sz);
+		break;
+	default:
+		pr_err("Unknown sparse chunk type 0x%x\n",
+		       le16_to_cpu(chunk->chunk_type));
+		return -EINVAL;
+	}
+
+	return 0;
+
+bad_chunk:
+	pr_err("Invalid sparse chunk\n");
+	return -EINVAL;
+}
+
+/* Process data of the (decompressed) image */
+static int dfu_image_data(struct dfu_image *img, const u8 *data, ulong len)
+{
+	ulong n;
+	u32 value;
+	int ret = 0;
+
+	while (len && !ret) {
+		switch (img->state) {
+		case DFU_IMAGE_DETECT:
+			if (!dfu_image_collect(img, &data, &len))
+				break;
+			if (is_sparse_image(img->hdr)) {
+				ret = dfu_image_sparse_header(img);
+			} else {
+				img->state = DFU_IMAGE_RAW;
+				ret = dfu_image_out(img, img->hdr,
+						    img->hdr_len);
+			}
+			break;
+		case DFU_IMAGE_RAW:
+			ret = dfu_image_out(img, data, len);
+			len = 0;
+			break;
+		case DFU_IMAGE_SKIP:
+			n = min_t(u64, len, img->chunk_left);
+			data += n;
+			len -= n;
+			dfu_image_skip(img, img->chunk_left - n);
+			break;
+		case DFU_IMAGE_CHUNK_HDR:
+			if (!img->chunks_left) {
+				img->state = DFU_IMAGE_DONE;
+				break;
+			}
+			if (dfu_image_collect(img, &data, &len))
+				ret = dfu_image_chunk_header(img);
+			break;
+		case DFU_IMAGE_CHUNK_RAW:
+			n = min_t(u64, len, img->chunk_left);
+			ret = dfu_image_out(img, data, n);
+			img->chunk_left -= n;
+			data += n;
+			len -= n;
+			if (!img->chunk_left)
+				dfu_image_skip(img, 0);
+			break;
+		case DFU_IMAGE_CHUNK_FILL:
+			if (!dfu_image_collect(img, &data, &len))
+				break;
+			memcpy(&value, img->hdr, sizeof(value));
+			if (value)
+				ret = dfu_image_fill(img, value,
+						     img->chunk_left);
+			else
+				ret = dfu_image_zero(img, img->chunk_left);
+			dfu_image_skip(img, 0);
+			break;
+		case DFU_IMAGE_DONE:
+			/* Padding after the last chunk */
+			len = 0;
+			break;
+		}
+	}
+
+	return ret;
+}
+
+#if CONFIG_IS_ENABLED(DFU_IMAGE_GZIP)
+static int dfu_image_gzip_start(struct dfu_image *img)
+{
+	int ret;
+
+	img->zs.zalloc = gzalloc;
+	img->zs.zfree = gzfree;
+	/* Let zlib parse the gzip header and check the trailer */
+	ret = inflateInit2(&img->zs, 16 + MAX_WBITS);
+	if (ret != Z_OK) {
+		pr_err("inflateInit2() returned %d\n", ret);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int dfu_image_gzip(struct dfu_image *img, const void *buf, ulong len)
+{
+	z_stream *zs = &img->zs;
+	ulong n;
+	int ret;
+
+	zs->next_in = (u8 *)buf;
+	zs->avail_in = len;
+	do {
+		zs->next_out = img->dec;
+		zs->avail_out = DFU_IMAGE_DEC_SIZE;
+		ret = inflate(zs, Z_NO_FLUSH);
+		if (ret == Z_STREAM_END) {
+			img->comp_end = true;
+		} else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+			pr_err("inflate() returned %d\n", ret);
+			return -EIO;
+		}
+		n = DFU_IMAGE_DEC_SIZE - zs->avail_out;
+		if (!n)
+			break;
+		ret = dfu_image_data(img, img->dec, n);
+		if (ret)
+			return ret;
+	} while (!img->comp_end && (zs->avail_in || !zs->avail_out));
+
+	return 0;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(DFU_IMAGE_ZSTD)
+static int dfu_image_zstd_start(struct dfu_image *img)
+{
+	size_t size = ZSTD_DStreamWorkspaceBound(CONFIG_DFU_IMAGE_ZSTD_WINDOW);
+
+	img->zws = malloc(size);
+	if (!img->zws)
+		return -ENOMEM;
+	img->zds = ZSTD_initDStream(CONFIG_DFU_IMAGE_ZSTD_WINDOW, img->zws,
+				    size);
+	if (!img->zds) {
+		pr_err("ZSTD_initDStream failed\n");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int dfu_image_zstd(struct dfu_image *img, const void *buf, ulong len)
+{
+	ZSTD_inBuffer in = { .src = buf, .size = len, .pos = 0 };
+	ZSTD_outBuffer out;
+	size_t ret;
+	int err;
+
+	do {
+		out.dst = img->dec;
+		out.size = DFU_IMAGE_DEC_SIZE;
+		out.pos = 0;
+		ret = ZSTD_decompressStream(img->zds, &out, &in);
+		if (ZSTD_isError(ret)) {
+			pr_err("ZSTD_decompressStream error %d\n",
+			       ZSTD_getErrorCode(ret));
+			return -EIO;
+		}
+		if (!ret)
+			img->comp_end = true;
+		if (!out.pos)
+			break;
+		err = dfu_image_data(img, img->dec, out.pos);
+		if (err)
+			return err;
+	} while (!img->comp_end && (in.pos < in.size || out.pos == out.size));
+
+	return 0;
+}
+#endif
+
+int dfu_image_start(struct dfu_entity *dfu, const void *buf, long len)
+{
+	struct dfu_image *img = &dfu_image;
+	const char *name = "sparse";
+	enum dfu_image_comp comp;
+	int ret = 0;
+
+	if (len >= sizeof(sparse_header_t) && is_sparse_image((void *)buf)) {
+		comp = DFU_IMAGE_NONE;
+	} else if (CONFIG_IS_ENABLED(DFU_IMAGE_GZIP) && len >= 2 &&
+		   get_unaligned_le16(buf) == GZIP_MAGIC) {
+		comp = DFU_IMAGE_GZIP;
+		name = "gzip";
+	} else if (CONFIG_IS_ENABLED(DFU_IMAGE_ZSTD) && len >= 4 &&
+		   get_unaligned_le32(buf) == ZSTD_MAGIC) {
+		comp = DFU_IMAGE_ZSTD;
+		name = "zstd";
+	} else {
+		return 0;
+	}
+
+	memset(img, '\0', sizeof(*img));
+	img->dfu = dfu;
+	img->comp = comp;
+	dfu_image_expect(img, DFU_IMAGE_DETECT, sizeof(sparse_header_t));
+
+	img->out = memalign(ARCH_DMA_MINALIGN, DFU_IMAGE_OUT_SIZE);
+	if (comp != DFU_IMAGE_NONE)
+		img->dec = malloc(DFU_IMAGE_DEC_SIZE);
+	if (!img->out || (comp != DFU_IMAGE_NONE && !img->dec))
+		ret = -ENOMEM;
+#if CONFIG_IS_ENABLED(DFU_IMAGE_GZIP)
+	if (!ret && comp == DFU_IMAGE_GZIP)
+		ret = dfu_image_gzip_start(img);
+#endif
+#if CONFIG_IS_ENABLED(DFU_IMAGE_ZSTD)
+	if (!ret && comp == DFU_IMAGE_ZSTD)
+		ret = dfu_image_zstd_start(img);
+#endif
+	dfu->decoding = 1;
+	if (ret) {
+		dfu_image_abort(dfu);
+		return ret;
+	}
+	if (comp != DFU_IMAGE_NONE)
+		printf("\nDFU %s: decompressing %s image\n", dfu->name, name);
+
+	return 1;
+}
+
+int dfu_image_write(struct dfu_entity *dfu, const void *buf, long len)
+{
+	struct dfu_image *img = &dfu_image;
+
+	switch (img->comp) {
+#if CONFIG_IS_ENABLED(DFU_IMAGE_GZIP)
+	case DFU_IMAGE_GZIP:
+		return dfu_image_gzip(img, buf, len);
+#endif
+#if CONFIG_IS_ENABLED(DFU_IMAGE_ZSTD)
+	case DFU_IMAGE_ZSTD:
+		return dfu_image_zstd(img, buf, len);
+#endif
+	default:
+		return dfu_image_data(img, buf, len);
+	}
+}
+
+int dfu_image_finish(struct dfu_entity *dfu)
+{
+	struct dfu_image *img = &dfu_image;
+	int ret = 0;
+
+	/* A stream shorter than a sparse header is not sparse */
+	if (img->state == DFU_IMAGE_DETECT)
+		ret = dfu_image_out(img, img->hdr, img->hdr_len);
+	if (!ret)
+		ret = dfu_image_flush(img, true);
+
+	if (!ret && img->comp != DFU_IMAGE_NONE && !img->comp_end) {
+		pr_err("Compressed image is truncated\n");
+		ret = -EIO;
+	}
+	if (!ret && img->state != DFU_IMAGE_DETECT &&
+	    img->state != DFU_IMAGE_RAW && img->state != DFU_IMAGE_DONE &&
+	    (img->state != DFU_IMAGE_CHUNK_HDR || img->hdr_len ||
+	     img->chunks_left)) {
+		pr_err("Sparse image is truncated\n");
+		ret = -EIO;
+	}
+	dfu_image_abort(dfu);
+
+	return ret;
+}
+
+void dfu_image_abort(struct dfu_entity *dfu)
+{
+	struct dfu_image *img = &dfu_image;
+
+	if (!dfu->decoding)
+		return;
+
+#if CONFIG_IS_ENABLED(DFU_IMAGE_GZIP)
+	if (img->comp == DFU_IMAGE_GZIP)
+		inflateEnd(&img->zs);
+#endif
+#if CONFIG_IS_ENABLED(DFU_IMAGE_ZSTD)
+	free(img->zws);
+	img->zws = NULL;
+#endif
+	free(img->dec);
+	free(img->out);
+	img->dec = NULL;
+	img->out = NULL;
+	dfu->decoding = 0;
+}
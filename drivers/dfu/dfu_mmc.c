@@ -7,6 +7,7 @@
  */
 
 #include <common.h>
+#include <blk.h>
 #include <log.h>
 #include <malloc.h>
 #include <errno.h>
@@ -20,6 +21,9 @@
 static unsigned char *dfu_file_buf;
 static u64 dfu_file_buf_len;
 static u64 dfu_file_buf_offset;
+#if CONFIG_IS_ENABLED(DFU_WRITE_BEHIND)
+static struct blk_req dfu_mmc_req;
+#endif
 
 static int mmc_block_op(enum dfu_op op, struct dfu_entity *dfu,
 			u64 offset, void *buf, long *len)
@@ -212,6 +216,107 @@ int dfu_write_medium_mmc(struct dfu_entity *dfu,
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(DFU_WRITE_BEHIND)
+static int dfu_write_medium_mmc_async(struct dfu_entity *dfu, u64 offset,
+				      void *buf, long *len)
+{
+	struct mmc *mmc;
+	u32 blk_start, blk_count;
+
+	/* Only raw writes to the current hardware partition */
+	if (dfu->layout != DFU_RAW_ADDR || dfu->data.mmc.hw_partition >= 0)
+		return -ENOSYS;
+
+	mmc = find_mmc_device(dfu->data.mmc.dev_num);
+	if (!mmc) {
+		pr_err("Device MMC %d - not found!", dfu->data.mmc.dev_num);
+		return -ENODEV;
+	}
+
+	/* A partial last block is padded, but *len stays what was received */
+	blk_start = dfu->data.mmc.lba_start +
+			(u32)lldiv(offset, dfu->data.mmc.lba_blk_size);
+	blk_count = DIV_ROUND_UP(*len, dfu->data.mmc.lba_blk_size);
+	if (blk_start + blk_count >
+			dfu->data.mmc.lba_start + dfu->data.mmc.lba_size) {
+		puts("Request would exceed designated area!\n");
+		return -EINVAL;
+	}
+
+	debug("%s: MMC WRITE dev: %d start: %d cnt: %d buf: 0x%p\n", __func__,
+	      dfu->data.mmc.dev_num, blk_start, blk_count, buf);
+	dfu_mmc_req.complete = NULL;
+
+	return blk_dwrite_async(mmc_get_blk_desc(mmc), blk_start, blk_count,
+				buf, &dfu_mmc_req);
+}
+
+static int dfu_poll_medium_mmc(struct dfu_entity *dfu)
+{
+	long ret = blk_poll(&dfu_mmc_req);
+
+	if (ret == -EINPROGRESS)
+		return ret;
+	if (ret != dfu_mmc_req.blkcnt) {
+		pr_err("MMC operation failed");
+		return -EIO;
+	}
+
+	return 0;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(DFU_IMAGE_DECODE)
+static int dfu_erase_medium_mmc(struct dfu_entity *dfu, u64 offset, u64 len)
+{
+	struct mmc *mmc = find_mmc_device(dfu->data.mmc.dev_num);
+	u32 blk_start, blk_count;
+
+	if (!mmc)
+		return -ENODEV;
+
+	blk_start = dfu->data.mmc.lba_start +
+			(u32)lldiv(offset, dfu->data.mmc.lba_blk_size);
+	blk_count = lldiv(len, dfu->data.mmc.lba_blk_size);
+	if (blk_start + blk_count >
+			dfu->data.mmc.lba_start + dfu->data.mmc.lba_size) {
+		puts("Request would exceed designated area!\n");
+		return -EINVAL;
+	}
+
+	debug("%s: MMC ERASE dev: %d start: %d cnt: %d\n", __func__,
+	      dfu->data.mmc.dev_num, blk_start, blk_count);
+	if (blk_derase(mmc_get_blk_desc(mmc), blk_start, blk_count) !=
+	    blk_count) {
+		pr_err("MMC erase failed");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/*
+ * Size of the erase groups if erased data reads as zeroes and the entity
+ * starts on an erase group, otherwise 0
+ */
+static u32 dfu_mmc_erase_size(struct dfu_entity *dfu, struct mmc *mmc)
+{
+	bool zeroes;
+
+	if (IS_SD(mmc))
+		zeroes = !(mmc->scr[0] & SD_SCR_DATA_STAT_AFTER_ERASE);
+	else
+		zeroes = mmc->ext_csd && !mmc->ext_csd[EXT_CSD_ERASED_MEM_CONT];
+
+	if (!zeroes || !mmc->erase_grp_size ||
+	    dfu->data.mmc.lba_blk_size != 512 ||
+	    dfu->data.mmc.lba_start % mmc->erase_grp_size)
+		return 0;
+
+	return mmc->erase_grp_size * 512;
+}
+#endif
+
 int dfu_flush_medium_mmc(struct dfu_entity *dfu)
 {
 	int ret = 0;
@@ -323,6 +428,8 @@ int dfu_fill_entity_mmc(struct dfu_entity *dfu, char *devstr, char *s)
 
 	const char *argv[3];
 	const char **parg = argv;
+	const char *opt;
+	bool __maybe_unused nodecode = false;
 
 	dfu->data.mmc.dev_num = simple_strtoul(devstr, NULL, 10);
 
@@ -362,13 +469,17 @@ int dfu_fill_entity_mmc(struct dfu_entity *dfu, char *devstr, char *s)
 		dfu->data.mmc.lba_blk_size	= mmc->read_bl_len;
 
 		/*
-		 * Check for an extra entry at dfu_alt_info env variable
-		 * specifying the mmc HW defined partition number
+		 * Check for extra entries at dfu_alt_info env variable
+		 * specifying the mmc HW defined partition number, or that
+		 * images are written as they are
 		 */
-		if (s)
-			if (!strcmp(strsep(&s, " "), "mmcpart"))
+		while ((opt = strsep(&s, " "))) {
+			if (!strcmp(opt, "mmcpart") && s)
 				dfu->data.mmc.hw_partition =
-					simple_strtoul(s, NULL, 0);
+					simple_strtoul(strsep(&s, " "), NULL, 0);
+			else if (!strcmp(opt, "nodecode"))
+				nodecode = true;
+		}
 
 	} else if (!strcmp(entity_type, "part")) {
 		struct disk_partition partinfo;
@@ -384,12 +495,17 @@ int dfu_fill_entity_mmc(struct dfu_entity *dfu, char *devstr, char *s)
 		}
 
 		/*
-		 * Check for an extra entry at dfu_alt_info env variable
-		 * specifying the mmc HW defined partition number
+		 * Check for extra entries at dfu_alt_info env variable
+		 * specifying an offset into the partition, or that images
+		 * are written as they are
 		 */
-		if (s)
-			if (!strcmp(strsep(&s, " "), "offset"))
-				offset = simple_strtoul(s, NULL, 0);
+		while ((opt = strsep(&s, " "))) {
+			if (!strcmp(opt, "offset") && s)
+				offset = simple_strtoul(strsep(&s, " "), NULL,
+							0);
+			else if (!strcmp(opt, "nodecode"))
+				nodecode = true;
+		}
 
 		dfu->layout			= DFU_RAW_ADDR;
 		dfu->data.mmc.lba_start		= partinfo.start + offset;
@@ -415,6 +531,20 @@ int dfu_fill_entity_mmc(struct dfu_entity *dfu, char *devstr, char *s)
 	dfu->read_medium = dfu_read_medium_mmc;
 	dfu->write_medium = dfu_write_medium_mmc;
 	dfu->flush_medium = dfu_flush_medium_mmc;
+#if CONFIG_IS_ENABLED(DFU_WRITE_BEHIND)
+	dfu->write_medium_async = dfu_write_medium_mmc_async;
+	dfu->poll_medium = dfu_poll_medium_mmc;
+#endif
+#if CONFIG_IS_ENABLED(DFU_IMAGE_DECODE)
+	if (dfu->layout == DFU_RAW_ADDR && !nodecode) {
+		dfu->decode = 1;
+		/* Erasing does not switch hardware partitions */
+		if (dfu->data.mmc.hw_partition < 0) {
+			dfu->erase_medium = dfu_erase_medium_mmc;
+			dfu->erase_size = dfu_mmc_erase_size(dfu, mmc);
+		}
+	}
+#endif
 	dfu->inited = 0;
 	dfu->free_entity = dfu_free_entity_mmc;
 
@@ -14,6 +14,8 @@
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
+#include <watchdog.h>
 #include <asm/cache.h>
 #include <dm/read.h>
 #include <dma-uclass.h>
@@ -250,6 +252,59 @@ int dma_memcpy(void *dst, void *src, size_t len)
 	return ops->transfer(dev, DMA_MEM_TO_MEM, dst, src, len);
 }
 
+int dma_transfer_async(struct udevice *dev, int direction, void *dst,
+		       void *src, size_t len)
+{
+	const struct dma_ops *ops = device_get_ops(dev);
+
+	if (!ops->transfer_async)
+		return -ENOSYS;
+
+	/* Write the source back to RAM, where the controller reads it */
+	flush_dcache_range(rounddown((unsigned long)src, ARCH_DMA_MINALIGN),
+			   roundup((unsigned long)src + len, ARCH_DMA_MINALIGN));
+	if (direction == DMA_MEM_TO_MEM)
+		invalidate_dcache_range((unsigned long)dst,
+					(unsigned long)dst +
+					roundup(len, ARCH_DMA_MINALIGN));
+
+	return ops->transfer_async(dev, direction, dst, src, len);
+}
+
+int dma_poll(struct udevice *dev)
+{
+	const struct dma_ops *ops = device_get_ops(dev);
+
+	if (!ops->poll)
+		return -ENOSYS;
+
+	return ops->poll(dev);
+}
+
+int dma_wait(struct udevice *dev, ulong timeout_ms)
+{
+	ulong start = get_timer(0);
+	int ret;
+
+	while ((ret = dma_poll(dev)) == -EBUSY) {
+		if (get_timer(start) > timeout_ms)
+			return -ETIMEDOUT;
+		WATCHDOG_RESET();
+	}
+
+	return ret;
+}
+
+int dma_stop(struct udevice *dev)
+{
+	const struct dma_ops *ops = device_get_ops(dev);
+
+	if (!ops->stop)
+		return -ENOSYS;
+
+	return ops->stop(dev);
+}
+
 UCLASS_DRIVER(dma) = {
 	.id		= UCLASS_DMA,
 	.name		= "dma",
@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * ARM PL330 DMA controller
+ *
+ * Only memory-to-memory and memory-to-device copies are supported, on a
+ * single channel. Each transfer runs a small program, built here, which
+ * moves the data in bursts of 16 words and then signals an event. The
+ * event is polled for, so no interrupt handler is needed.
+ */
+
+#include <common.h>
+#include <cpu_func.h>
+#include <dm.h>
+#include <dma-uclass.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <asm/cache.h>
+#include <asm/io.h>
+#include <asm/unaligned.h>
+#include <dm/device_compat.h>
+#include <linux/bitops.h>
+#include <linux/iopoll.h>
+#include <linux/kernel.h>
+
+/* Registers */
+#define PL330_INTEN		0x020
+#define PL330_INTSTATUS		0x028
+#define PL330_INTCLR		0x02c
+#define PL330_FSC		0x034
+#define PL330_FTC(ch)		(0x040 + (ch) * 4)
+#define PL330_CSR(ch)		(0x100 + (ch) * 8)
+#define PL330_DBGSTATUS		0xd00
+#define PL330_DBGCMD		0xd04
+#define PL330_DBGINST0		0xd08
+#define PL330_DBGINST1		0xd0c
+
+#define PL330_CSR_STATE		GENMASK(3, 0)	/* 0 means stopped */
+#define PL330_DBGSTATUS_BUSY	BIT(0)
+#define PL330_DBGINST0_CHAN	BIT(0)	/* Run on the channel, not manager */
+
+/* Instructions */
+#define PL330_DMAEND		0x00
+#define PL330_DMAKILL		0x01
+#define PL330_DMALD		0x04
+#define PL330_DMAST		0x08
+#define PL330_DMAWMB		0x13
+#define PL330_DMALP		0x20
+#define PL330_DMALPEND		0x28
+#define PL330_DMALPEND_NF	BIT(4)	/* Not DMALPFE: uses a loop counter */
+#define PL330_DMASEV		0x34
+#define PL330_DMAMOV		0xbc
+#define PL330_DMAGO		0xa0
+
+/* DMAMOV destination registers */
+#define PL330_SAR		0
+#define PL330_CCR		1
+#define PL330_DAR		2
+
+/* Channel control: word-sized accesses, secure and unprivileged */
+#define PL330_CCR_SRC_INC	BIT(0)
+#define PL330_CCR_SRC_WORDS	(2 << 1)
+#define PL330_CCR_SRC_LEN(n)	(((n) - 1) << 4)
+#define PL330_CCR_DST_INC	BIT(14)
+#define PL330_CCR_DST_WORDS	(2 << 15)
+#define PL330_CCR_DST_LEN(n)	(((n) - 1) << 18)
+
+enum {
+	PL330_CHAN		= 0,
+	PL330_BURST_WORDS	= 16,
+	PL330_LOOP_MAX		= 256,
+	PL330_PROG_SIZE		= 256,
+	/* Each 4MB needs another 10-byte pair of loops in the program */
+	PL330_MAX_LEN		= 64 << 20,
+	PL330_TIMEOUT_MS	= 1000,
+	PL330_KILL_TIMEOUT_US	= 1000,
+};
+
+struct pl330_priv {
+	void __iomem *base;
+	u8 *prog;		/* Channel program, read by the controller */
+	bool busy;
+};
+
+static u8 *pl330_mov(u8 *p, int reg, u32 val)
+{
+	*p++ = PL330_DMAMOV;
+	*p++ = reg;
+	put_unaligned_le32(val, p);
+
+	return p + 4;
+}
+
+static u8 *pl330_lp(u8 *p, int lc, int count)
+{
+	*p++ = PL330_DMALP | lc << 1;
+	*p++ = count - 1;
+
+	return p;
+}
+
+static u8 *pl330_lpend(u8 *p, int lc, u8 *body)
+{
+	int jump = p - body;
+
+	*p++ = PL330_DMALPEND | PL330_DMALPEND_NF | lc << 2;
+	*p++ = jump;
+
+	return p;
+}
+
+/* Add a loop which runs @count DMALD/DMAST pairs */
+static u8 *pl330_copy(u8 *p, ulong count)
+{
+	u8 *outer, *inner;
+	ulong n;
+
+	while (count >= PL330_LOOP_MAX) {
+		n = min(count / PL330_LOOP_MAX, (ulong)PL330_LOOP_MAX);
+		p = pl330_lp(p, 0, n);
+		outer = p;
+		p = pl330_lp(p, 1, PL330_LOOP_MAX);
+		inner = p;
+		*p++ = PL330_DMALD;
+		*p++ = PL330_DMAST;
+		p = pl330_lpend(p, 1, inner);
+		p = pl330_lpend(p, 0, outer);
+		count -= n * PL330_LOOP_MAX;
+	}
+	if (count) {
+		p = pl330_lp(p, 0, count);
+		inner = p;
+		*p++ = PL330_DMALD;
+		*p++ = PL330_DMAST;
+		p = pl330_lpend(p, 0, inner);
+	}
+
+	return p;
+}
+
+/* Execute an instruction through the debug interface */
+static int pl330_exec(struct pl330_priv *priv, u32 inst0, u32 inst1)
+{
+	if (readl(priv->base + PL330_DBGSTATUS) & PL330_DBGSTATUS_BUSY)
+		return -EBUSY;
+	writel(inst0, priv->base + PL330_DBGINST0);
+	writel(inst1, priv->base + PL330_DBGINST1);
+	writel(0, priv->base + PL330_DBGCMD);
+
+	return 0;
+}
+
+/* Kill the channel and wait until it has stopped */
+static int pl330_kill(struct pl330_priv *priv)
+{
+	u32 val;
+	int ret;
+
+	ret = readl_poll_timeout(priv->base + PL330_DBGSTATUS, val,
+				 !(val & PL330_DBGSTATUS_BUSY),
+				 PL330_KILL_TIMEOUT_US);
+	if (!ret)
+		ret = pl330_exec(priv, PL330_DMAKILL << 16 | PL330_CHAN << 8 |
+				 PL330_DBGINST0_CHAN, 0);
+	if (!ret)
+		ret = readl_poll_timeout(priv->base + PL330_CSR(PL330_CHAN),
+					 val, !(val & PL330_CSR_STATE),
+					 PL330_KILL_TIMEOUT_US);
+	if (ret)
+		return ret;
+	writel(BIT(PL330_CHAN), priv->base + PL330_INTCLR);
+	priv->busy = false;
+
+	return 0;
+}
+
+static int pl330_transfer_async(struct udevice *dev, int direction,
+				void *dst, void *src, size_t len)
+{
+	struct pl330_priv *priv = dev_get_priv(dev);
+	u32 ccr = PL330_CCR_SRC_INC | PL330_CCR_SRC_WORDS | PL330_CCR_DST_WORDS;
+	ulong words = len / 4;
+	u8 *p = priv->prog;
+	int ret;
+
+	if (direction != DMA_MEM_TO_MEM && direction != DMA_MEM_TO_DEV)
+		return -EINVAL;
+	if (((ulong)dst | (ulong)src | len) & 3 || len > PL330_MAX_LEN)
+		return -EINVAL;
+	if (priv->busy)
+		return -EBUSY;
+	if (direction == DMA_MEM_TO_MEM)
+		ccr |= PL330_CCR_DST_INC;
+
+	p = pl330_mov(p, PL330_SAR, (ulong)src);
+	p = pl330_mov(p, PL330_DAR, (ulong)dst);
+	if (words >= PL330_BURST_WORDS) {
+		p = pl330_mov(p, PL330_CCR,
+			      ccr | PL330_CCR_SRC_LEN(PL330_BURST_WORDS) |
+			      PL330_CCR_DST_LEN(PL330_BURST_WORDS));
+		p = pl330_copy(p, words / PL330_BURST_WORDS);
+	}
+	if (words % PL330_BURST_WORDS) {
+		p = pl330_mov(p, PL330_CCR, ccr | PL330_CCR_SRC_LEN(1) |
+			      PL330_CCR_DST_LEN(1));
+		p = pl330_copy(p, words % PL330_BURST_WORDS);
+	}
+	*p++ = PL330_DMAWMB;
+	*p++ = PL330_DMASEV;
+	*p++ = PL330_CHAN << 3;
+	*p++ = PL330_DMAEND;
+	flush_dcache_range((ulong)priv->prog,
+			   (ulong)priv->prog + PL330_PROG_SIZE);
+
+	writel(BIT(PL330_CHAN), priv->base + PL330_INTCLR);
+	ret = pl330_exec(priv, PL330_DMAGO << 16 | PL330_CHAN << 24,
+			 (ulong)priv->prog);
+	if (ret)
+		return ret;
+	priv->busy = true;
+
+	return 0;
+}
+
+static int pl330_poll(struct udevice *dev)
+{
+	struct pl330_priv *priv = dev_get_priv(dev);
+
+	if (!priv->busy)
+		return 0;
+
+	if (readl(priv->base + PL330_FSC) & BIT(PL330_CHAN)) {
+		dev_err(dev, "Channel fault %x\n",
+			readl(priv->base + PL330_FTC(PL330_CHAN)));
+		pl330_kill(priv);
+		return -EIO;
+	}
+	if (!(readl(priv->base + PL330_INTSTATUS) & BIT(PL330_CHAN)))
+		return -EBUSY;
+	writel(BIT(PL330_CHAN), priv->base + PL330_INTCLR);
+	priv->busy = false;
+
+	return 0;
+}
+
+/* Wait for the transfer to finish, stopping it if it takes too long */
+static int pl330_wait(struct udevice *dev)
+{
+	struct pl330_priv *priv = dev_get_priv(dev);
+	ulong start = get_timer(0);
+	int ret;
+
+	while ((ret = pl330_poll(dev)) == -EBUSY) {
+		if (get_timer(start) > PL330_TIMEOUT_MS) {
+			ret = pl330_kill(priv);
+			return ret ? ret : -ETIMEDOUT;
+		}
+	}
+
+	return ret;
+}
+
+static int pl330_stop(struct udevice *dev)
+{
+	struct pl330_priv *priv = dev_get_priv(dev);
+	int ret;
+
+	if (!priv->busy)
+		return 0;
+
+	ret = pl330_kill(priv);
+	if (ret)
+		dev_err(dev, "Cannot stop channel (err=%d)\n", ret);
+
+	return ret;
+}
+
+static int pl330_transfer(struct udevice *dev, int direction, void *dst,
+			  void *src, size_t len)
+{
+	int ret;
+
+	flush_dcache_range(rounddown((ulong)src, ARCH_DMA_MINALIGN),
+			   roundup((ulong)src + len, ARCH_DMA_MINALIGN));
+	ret = pl330_transfer_async(dev, direction, dst, src, len);
+	if (ret)
+		return ret;
+
+	ret = pl330_wait(dev);
+	if (!ret && direction == DMA_MEM_TO_MEM)
+		invalidate_dcache_range((ulong)dst, (ulong)dst +
+					roundup(len, ARCH_DMA_MINALIGN));
+
+	return ret;
+}
+
+static int pl330_probe(struct udevice *dev)
+{
+	struct dma_dev_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct pl330_priv *priv = dev_get_priv(dev);
+
+	priv->base = dev_read_addr_ptr(dev);
+	if (!priv->base)
+		return -EINVAL;
+
+	priv->prog = memalign(ARCH_DMA_MINALIGN, PL330_PROG_SIZE);
+	if (!priv->prog)
+		return -ENOMEM;
+
+	/* Events raise the interrupt status; the GIC line stays disabled */
+	setbits_le32(priv->base + PL330_INTEN, BIT(PL330_CHAN));
+	uc_priv->supported = DMA_SUPPORTS_MEM_TO_MEM | DMA_SUPPORTS_MEM_TO_DEV;
+
+	return 0;
+}
+
+static int pl330_remove(struct udevice *dev)
+{
+	struct pl330_priv *priv = dev_get_priv(dev);
+
+	/* Let a transfer finish, e.g. a display update, before booting */
+	pl330_wait(dev);
+	free(priv->prog);
+
+	return 0;
+}
+
+static const struct dma_ops pl330_ops = {
+	.transfer	= pl330_transfer,
+	.transfer_async	= pl330_transfer_async,
+	.poll		= pl330_poll,
+	.stop		= pl330_stop,
+};
+
+static const struct udevice_id pl330_ids[] = {
+	{ .compatible = "arm,pl330" },
+	{ }
+};
+
+U_BOOT_DRIVER(pl330) = {
+	.name	= "pl330",
+	.id	= UCLASS_DMA,
+	.of_match = pl330_ids,
+	.ops	= &pl330_ops,
+	.probe	= pl330_probe,
+	.remove	= pl330_remove,
+	.flags	= DM_FLAG_OS_PREPARE,
+	.priv_auto_alloc_size = sizeof(struct pl330_priv),
+};
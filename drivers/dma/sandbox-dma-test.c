@@ -36,6 +36,9 @@ struct sandbox_dma_dev {
 	uchar	*buf_rx;
 	size_t	data_len;
 	u32	meta;
+	void	*async_dst;
+	void	*async_src;
+	size_t	async_len;
 };
 
 static int sandbox_dma_transfer(struct udevice *dev, int direction,
@@ -46,6 +49,49 @@ static int sandbox_dma_transfer(struct udevice *dev, int direction,
 	return 0;
 }
 
+static int sandbox_dma_transfer_async(struct udevice *dev, int direction,
+				      void *dst, void *src, size_t len)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	if (direction != DMA_MEM_TO_MEM)
+		return -EINVAL;
+	if (ud->async_len)
+		return -EBUSY;
+
+	/*
+	 * Nothing is copied until the transfer is polled, so that tests show
+	 * up callers which use the data before waiting for it
+	 */
+	ud->async_dst = dst;
+	ud->async_src = src;
+	ud->async_len = len;
+
+	return 0;
+}
+
+static int sandbox_dma_poll(struct udevice *dev)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	if (ud->async_len) {
+		memcpy(ud->async_dst, ud->async_src, ud->async_len);
+		ud->async_len = 0;
+	}
+
+	return 0;
+}
+
+static int sandbox_dma_stop(struct udevice *dev)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	/* The transfer has not started copying, so dropping it is enough */
+	ud->async_len = 0;
+
+	return 0;
+}
+
 static int sandbox_dma_of_xlate(struct dma *dma,
 				struct ofnode_phandle_args *args)
 {
@@ -229,6 +275,9 @@ static int sandbox_dma_prepare_rcv_buf(struct dma *dma, void *dst, size_t size)
 
 static const struct dma_ops sandbox_dma_ops = {
 	.transfer	= sandbox_dma_transfer,
+	.transfer_async	= sandbox_dma_transfer_async,
+	.poll		= sandbox_dma_poll,
+	.stop		= sandbox_dma_stop,
 	.of_xlate	= sandbox_dma_of_xlate,
 	.request	= sandbox_dma_request,
 	.rfree		= sandbox_dma_rfree,
@@ -155,16 +155,20 @@ static void *check_data(u8 *buf, size_t bsize, u32 *swap)
 	return NULL;
 }
 
-static int zynq_dma_transfer(u32 srcbuf, u32 srclen, u32 dstbuf, u32 dstlen)
+static void zynq_dma_xfer_start(u32 srcbuf, u32 srclen, u32 dstbuf,
+				u32 dstlen)
 {
-	unsigned long ts;
-	u32 isr_status;
-
 	/* Set up the transfer */
 	writel((u32)srcbuf, &devcfg_base->dma_src_addr);
 	writel(dstbuf, &devcfg_base->dma_dst_addr);
 	writel(srclen, &devcfg_base->dma_src_len);
 	writel(dstlen, &devcfg_base->dma_dst_len);
+}
+
+static int zynq_dma_xfer_wait(void)
+{
+	unsigned long ts;
+	u32 isr_status;
 
 	isr_status = readl(&devcfg_base->int_sts);
 
@@ -197,6 +201,13 @@ static int zynq_dma_transfer(u32 srcbuf, u32 srclen, u32 dstbuf, u32 dstlen)
 	return FPGA_SUCCESS;
 }
 
+static int zynq_dma_transfer(u32 srcbuf, u32 srclen, u32 dstbuf, u32 dstlen)
+{
+	zynq_dma_xfer_start(srcbuf, srclen, dstbuf, dstlen);
+
+	return zynq_dma_xfer_wait();
+}
+
 static int zynq_dma_xfer_init(bitstream_type bstype)
 {
 	u32 status, control, isr_status;
@@ -419,64 +430,78 @@ static int zynq_load(xilinx_desc *desc, const void *buf, size_t bsize,
 }
 
 #if defined(CONFIG_CMD_FPGA_LOADFS) && !defined(CONFIG_SPL_BUILD)
+/*
+ * The bitstream is streamed in chunks of fsinfo->blocksize through two
+ * buffers: while the PCAP DMA drains one of them, the next chunk is read
+ * from the filesystem into the other one. The second buffer is placed
+ * right after the first, so 2 * blocksize bytes are needed at buf.
+ */
 static int zynq_loadfs(xilinx_desc *desc, const void *buf, size_t bsize,
 		       fpga_fs_info *fsinfo)
 {
 	unsigned long ts; /* Timestamp */
 	u32 isr_status, swap;
 	u32 partialbit = 0;
-	loff_t blocksize, actread;
-	loff_t pos = 0;
-	int fstype;
-	char *interface, *dev_part;
-	const char *filename;
+	loff_t blocksize, chunk, actread;
+	struct fs_file *file;
+	u32 *chunk_buf[2];
+	u32 *dma_buf;
+	bool dma_busy = false;
+	int cur = 0;
 
 	blocksize = fsinfo->blocksize;
-	interface = fsinfo->interface;
-	dev_part = fsinfo->dev_part;
-	filename = fsinfo->filename;
-	fstype = fsinfo->fstype;
 
-	if (fs_set_blk_dev(interface, dev_part, fstype))
+	if (fs_set_blk_dev(fsinfo->interface, fsinfo->dev_part,
+			   fsinfo->fstype))
 		return FPGA_FAIL;
 
-	if (fs_read(filename, (u32) buf, pos, blocksize, &actread) < 0)
+	file = fs_file_open(fsinfo->filename);
+	if (!file)
 		return FPGA_FAIL;
 
-	if (zynq_validate_bitstream(desc, buf, bsize, blocksize, &swap,
+	chunk = min_t(loff_t, blocksize, bsize);
+	if (fs_file_read(file, (u32)buf, chunk, &actread) < 0 ||
+	    actread != chunk)
+		goto fail;
+
+	if (zynq_validate_bitstream(desc, buf, bsize, chunk, &swap,
 				    &partialbit))
-		return FPGA_FAIL;
+		goto fail;
 
-	dcache_disable();
+	chunk_buf[0] = (u32 *)buf;
+	chunk_buf[1] = (u32 *)ALIGN((u32)buf + (u32)blocksize,
+				     ARCH_DMA_MINALIGN);
 
-	do {
-		buf = zynq_align_dma_buffer((u32 *)buf, blocksize, swap);
+	while (bsize) {
+		dma_buf = zynq_align_dma_buffer(chunk_buf[cur], chunk, swap);
 
-		if (zynq_dma_transfer((u32)buf | 1, blocksize >> 2,
-				      0xffffffff, 0))
-			return FPGA_FAIL;
+		/* flush(clean & invalidate) d-cache range of the chunk */
+		flush_dcache_range((u32)dma_buf, (u32)dma_buf +
+				   roundup(chunk, ARCH_DMA_MINALIGN));
 
-		bsize -= blocksize;
-		pos   += blocksize;
+		if (dma_busy && zynq_dma_xfer_wait())
+			goto fail;
 
-		if (fs_set_blk_dev(interface, dev_part, fstype))
-			return FPGA_FAIL;
+		zynq_dma_xfer_start((u32)dma_buf | 1, chunk >> 2,
+				    0xffffffff, 0);
+		dma_busy = true;
 
-		if (bsize > blocksize) {
-			if (fs_read(filename, (u32) buf, pos, blocksize, &actread) < 0)
-				return FPGA_FAIL;
-		} else {
-			if (fs_read(filename, (u32) buf, pos, bsize, &actread) < 0)
-				return FPGA_FAIL;
-		}
-	} while (bsize > blocksize);
+		bsize -= chunk;
+		if (!bsize)
+			break;
 
-	buf = zynq_align_dma_buffer((u32 *)buf, blocksize, swap);
+		/* Read the next chunk while the DMA is running */
+		cur ^= 1;
+		chunk = min_t(loff_t, blocksize, bsize);
+		if (fs_file_read(file, (u32)chunk_buf[cur], chunk,
+				 &actread) < 0 || actread != chunk)
+			goto fail;
+	}
 
-	if (zynq_dma_transfer((u32)buf | 1, bsize >> 2, 0xffffffff, 0))
-		return FPGA_FAIL;
+	if (zynq_dma_xfer_wait())
+		goto fail;
 
-	dcache_enable();
+	fs_file_close(file);
 
 	isr_status = readl(&devcfg_base->int_sts);
 
@@ -497,6 +522,13 @@ static int zynq_loadfs(xilinx_desc *desc, const void *buf, size_t bsize,
 		zynq_slcr_devcfg_enable();
 
 	return FPGA_SUCCESS;
+
+fail:
+	if (dma_busy)
+		zynq_dma_xfer_wait();
+	fs_file_close(file);
+
+	return FPGA_FAIL;
 }
 #endif
 
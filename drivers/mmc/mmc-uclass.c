@@ -53,6 +53,52 @@ int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 	return dm_mmc_send_cmd(mmc->dev, cmd, data);
 }
 
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+int dm_mmc_send_cmd_async(struct udevice *dev, struct mmc_cmd *cmd,
+			  struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+	int ret;
+
+	mmmc_trace_before_send(mmc, cmd);
+	if (ops->send_cmd_async)
+		ret = ops->send_cmd_async(dev, cmd, data);
+	else
+		ret = -ENOSYS;
+	mmmc_trace_after_send(mmc, cmd, ret);
+
+	return ret;
+}
+
+int mmc_send_cmd_async(struct mmc *mmc, struct mmc_cmd *cmd,
+		       struct mmc_data *data)
+{
+	return dm_mmc_send_cmd_async(mmc->dev, cmd, data);
+}
+
+int dm_mmc_poll_data(struct udevice *dev, struct mmc_data *data)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(dev);
+
+	if (!ops->poll_data)
+		return -ENOSYS;
+	return ops->poll_data(dev, data);
+}
+
+int mmc_poll_data(struct mmc *mmc, struct mmc_data *data)
+{
+	return dm_mmc_poll_data(mmc->dev, data);
+}
+
+bool mmc_can_async(struct mmc *mmc)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(mmc->dev);
+
+	return ops->send_cmd_async && ops->poll_data;
+}
+#endif
+
 int dm_mmc_set_ios(struct udevice *dev)
 {
 	struct dm_mmc_ops *ops = mmc_get_ops(dev);
@@ -487,6 +533,13 @@ static const struct blk_ops mmc_blk_ops = {
 	.erase	= mmc_berase,
 #endif
 	.select_hwpart	= mmc_select_hwpart,
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	.read_async	= mmc_bread_async,
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	.write_async	= mmc_bwrite_async,
+#endif
+	.poll		= mmc_bpoll,
+#endif
 };
 
 U_BOOT_DRIVER(mmc_blk) = {
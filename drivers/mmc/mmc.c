@@ -395,44 +395,87 @@ int mmc_send_tuning(struct mmc *mmc, u32 opcode, int *cmd_error)
 }
 #endif
 
-static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
-			   lbaint_t blkcnt)
+static bool mmc_can_cmd23(struct mmc *mmc)
 {
-	struct mmc_cmd cmd;
-	struct mmc_data data;
+	if (!IS_ENABLED(CONFIG_MMC_CMD23) || mmc_host_is_spi(mmc))
+		return false;
+
+	if (IS_SD(mmc))
+		return mmc->scr[0] & SD_SCR_CMD23_SUPPORT;
+
+	return mmc->version >= MMC_VERSION_3;
+}
+
+/*
+ * Set up a block read. On cards which know CMD23 the block count is
+ * announced right away and *sbc is set, the card then stops on its own.
+ */
+static int mmc_prepare_read(struct mmc *mmc, struct mmc_cmd *cmd,
+			    struct mmc_data *data, void *dst, lbaint_t start,
+			    lbaint_t blkcnt, bool *sbc)
+{
+	*sbc = blkcnt > 1 && mmc_can_cmd23(mmc);
+	if (*sbc) {
+		cmd->cmdidx = MMC_CMD_SET_BLOCK_COUNT;
+		cmd->cmdarg = blkcnt;
+		cmd->resp_type = MMC_RSP_R1;
+		if (mmc_send_cmd(mmc, cmd, NULL))
+			return -EIO;
+	}
 
 	if (blkcnt > 1)
-		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
+		cmd->cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
 	else
-		cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
+		cmd->cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
 
 	if (mmc->high_capacity)
-		cmd.cmdarg = start;
+		cmd->cmdarg = start;
 	else
-		cmd.cmdarg = start * mmc->read_bl_len;
+		cmd->cmdarg = start * mmc->read_bl_len;
 
-	cmd.resp_type = MMC_RSP_R1;
+	cmd->resp_type = MMC_RSP_R1;
 
-	data.dest = dst;
-	data.blocks = blkcnt;
-	data.blocksize = mmc->read_bl_len;
-	data.flags = MMC_DATA_READ;
+	data->dest = dst;
+	data->blocks = blkcnt;
+	data->blocksize = mmc->read_bl_len;
+	data->flags = MMC_DATA_READ;
 
-	if (mmc_send_cmd(mmc, &cmd, &data))
-		return 0;
+	return 0;
+}
 
-	if (blkcnt > 1) {
-		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
-		cmd.cmdarg = 0;
-		cmd.resp_type = MMC_RSP_R1b;
-		if (mmc_send_cmd(mmc, &cmd, NULL)) {
+static int mmc_stop_read(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+
+	cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
+	cmd.cmdarg = 0;
+	cmd.resp_type = MMC_RSP_R1b;
+	if (mmc_send_cmd(mmc, &cmd, NULL)) {
 #if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
-			pr_err("mmc fail to send stop cmd\n");
+		pr_err("mmc fail to send stop cmd\n");
 #endif
-			return 0;
-		}
+		return -EIO;
 	}
 
+	return 0;
+}
+
+static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
+			   lbaint_t blkcnt)
+{
+	struct mmc_cmd cmd;
+	struct mmc_data data;
+	bool sbc;
+
+	if (mmc_prepare_read(mmc, &cmd, &data, dst, start, blkcnt, &sbc))
+		return 0;
+
+	if (mmc_send_cmd(mmc, &cmd, &data))
+		return 0;
+
+	if (blkcnt > 1 && !sbc && mmc_stop_read(mmc))
+		return 0;
+
 	return blkcnt;
 }
 
@@ -446,27 +489,22 @@ static int mmc_get_b_max(struct mmc *mmc, void *dst, lbaint_t blkcnt)
 }
 #endif
 
-#if CONFIG_IS_ENABLED(BLK)
-ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *dst)
-#else
-ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
-		void *dst)
-#endif
+/* Common checks and setup of all block reads, returns NULL on error */
+static struct mmc *mmc_bread_setup(struct blk_desc *block_dev, lbaint_t start,
+				   lbaint_t blkcnt)
 {
-#if CONFIG_IS_ENABLED(BLK)
-	struct blk_desc *block_dev = dev_get_uclass_platdata(dev);
-#endif
-	int dev_num = block_dev->devnum;
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
 	int err;
-	lbaint_t cur, blocks_todo = blkcnt;
-	uint b_max;
 
-	if (blkcnt == 0)
-		return 0;
-
-	struct mmc *mmc = find_mmc_device(dev_num);
 	if (!mmc)
-		return 0;
+		return NULL;
+
+#if CONFIG_IS_ENABLED(BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+	if (mmc->async_req) {
+		pr_debug("%s: Asynchronous transfer in progress\n", __func__);
+		return NULL;
+	}
+#endif
 
 	if (CONFIG_IS_ENABLED(MMC_TINY))
 		err = mmc_switch_part(mmc, block_dev->hwpart);
@@ -474,21 +512,45 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 		err = blk_dselect_hwpart(block_dev, block_dev->hwpart);
 
 	if (err < 0)
-		return 0;
+		return NULL;
 
 	if ((start + blkcnt) > block_dev->lba) {
 #if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
 		pr_err("MMC: block number 0x" LBAF " exceeds max(0x" LBAF ")\n",
 		       start + blkcnt, block_dev->lba);
 #endif
-		return 0;
+		return NULL;
 	}
 
 	if (mmc_set_blocklen(mmc, mmc->read_bl_len)) {
 		pr_debug("%s: Failed to set blocklen\n", __func__);
-		return 0;
+		return NULL;
 	}
 
+	return mmc;
+}
+
+#if CONFIG_IS_ENABLED(BLK)
+ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *dst)
+#else
+ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
+		void *dst)
+#endif
+{
+#if CONFIG_IS_ENABLED(BLK)
+	struct blk_desc *block_dev = dev_get_uclass_platdata(dev);
+#endif
+	lbaint_t cur, blocks_todo = blkcnt;
+	struct mmc *mmc;
+	uint b_max;
+
+	if (blkcnt == 0)
+		return 0;
+
+	mmc = mmc_bread_setup(block_dev, start, blkcnt);
+	if (!mmc)
+		return 0;
+
 	b_max = mmc_get_b_max(mmc, dst, blkcnt);
 
 	do {
@@ -505,6 +567,83 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	return blkcnt;
 }
 
+#if CONFIG_IS_ENABLED(BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+/* Start the next transfer of the asynchronous read in flight */
+static int mmc_bread_async_next(struct mmc *mmc)
+{
+	struct blk_req *req = mmc->async_req;
+	void *dst = req->buffer + req->done * mmc->read_bl_len;
+	lbaint_t cnt = req->blkcnt - req->done;
+	struct mmc_cmd cmd;
+	int ret;
+
+	cnt = min(cnt, (lbaint_t)mmc_get_b_max(mmc, dst, cnt));
+	mmc->async_cnt = cnt;
+	ret = mmc_prepare_read(mmc, &cmd, &mmc->async_data, dst,
+			       req->start + req->done, cnt, &mmc->async_sbc);
+	if (ret)
+		return ret;
+
+	return mmc_send_cmd_async(mmc, &cmd, &mmc->async_data);
+}
+
+int mmc_bread_async(struct udevice *dev, struct blk_req *req)
+{
+	struct blk_desc *block_dev = dev_get_uclass_platdata(dev);
+	struct mmc *mmc;
+	int ret;
+
+	mmc = find_mmc_device(block_dev->devnum);
+	if (!mmc || !mmc_can_async(mmc))
+		return -ENOSYS;
+	if (!req->blkcnt)
+		return -EINVAL;
+
+	mmc = mmc_bread_setup(block_dev, req->start, req->blkcnt);
+	if (!mmc)
+		return -EIO;
+
+	mmc->async_req = req;
+	ret = mmc_bread_async_next(mmc);
+	if (ret)
+		mmc->async_req = NULL;
+
+	return ret;
+}
+
+long mmc_bpoll(struct udevice *dev, struct blk_req *req)
+{
+	struct blk_desc *block_dev = dev_get_uclass_platdata(dev);
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
+	int ret;
+
+	if (!mmc || mmc->async_req != req)
+		return -EINVAL;
+
+	if (CONFIG_IS_ENABLED(MMC_WRITE) && req->write)
+		return mmc_bwrite_poll(mmc, req);
+
+	ret = mmc_poll_data(mmc, &mmc->async_data);
+	if (ret == -EINPROGRESS)
+		return ret;
+
+	if (!ret && mmc->async_cnt > 1 && !mmc->async_sbc)
+		ret = mmc_stop_read(mmc);
+
+	if (!ret) {
+		req->done += mmc->async_cnt;
+		if (req->done < req->blkcnt) {
+			ret = mmc_bread_async_next(mmc);
+			if (!ret)
+				return -EINPROGRESS;
+		}
+	}
+	mmc->async_req = NULL;
+
+	return ret ? ret : req->done;
+}
+#endif
+
 static int mmc_go_idle(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
@@ -21,6 +21,16 @@ int mmc_set_blocklen(struct mmc *mmc, int len);
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+int mmc_send_cmd_async(struct mmc *mmc, struct mmc_cmd *cmd,
+		       struct mmc_data *data);
+int mmc_poll_data(struct mmc *mmc, struct mmc_data *data);
+bool mmc_can_async(struct mmc *mmc);
+int mmc_bread_async(struct udevice *dev, struct blk_req *req);
+long mmc_bpoll(struct udevice *dev, struct blk_req *req);
+int mmc_bwrite_async(struct udevice *dev, struct blk_req *req);
+long mmc_bwrite_poll(struct mmc *mmc, struct blk_req *req);
+#endif
 #else
 ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
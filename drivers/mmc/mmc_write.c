@@ -127,6 +127,43 @@ ulong mmc_berase(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt)
 	return blk;
 }
 
+static void mmc_prepare_write(struct mmc *mmc, struct mmc_cmd *cmd,
+			      struct mmc_data *data, lbaint_t start,
+			      lbaint_t blkcnt, const void *src)
+{
+	if (blkcnt == 1)
+		cmd->cmdidx = MMC_CMD_WRITE_SINGLE_BLOCK;
+	else
+		cmd->cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
+
+	if (mmc->high_capacity)
+		cmd->cmdarg = start;
+	else
+		cmd->cmdarg = start * mmc->write_bl_len;
+
+	cmd->resp_type = MMC_RSP_R1;
+
+	data->src = src;
+	data->blocks = blkcnt;
+	data->blocksize = mmc->write_bl_len;
+	data->flags = MMC_DATA_WRITE;
+}
+
+static int mmc_stop_write(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+
+	cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
+	cmd.cmdarg = 0;
+	cmd.resp_type = MMC_RSP_R1b;
+	if (mmc_send_cmd(mmc, &cmd, NULL)) {
+		printf("mmc fail to send stop cmd\n");
+		return -EIO;
+	}
+
+	return 0;
+}
+
 static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 		lbaint_t blkcnt, const void *src)
 {
@@ -142,23 +179,8 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 
 	if (blkcnt == 0)
 		return 0;
-	else if (blkcnt == 1)
-		cmd.cmdidx = MMC_CMD_WRITE_SINGLE_BLOCK;
-	else
-		cmd.cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
-
-	if (mmc->high_capacity)
-		cmd.cmdarg = start;
-	else
-		cmd.cmdarg = start * mmc->write_bl_len;
-
-	cmd.resp_type = MMC_RSP_R1;
-
-	data.src = src;
-	data.blocks = blkcnt;
-	data.blocksize = mmc->write_bl_len;
-	data.flags = MMC_DATA_WRITE;
 
+	mmc_prepare_write(mmc, &cmd, &data, start, blkcnt, src);
 	if (mmc_send_cmd(mmc, &cmd, &data)) {
 		printf("mmc write failed\n");
 		return 0;
@@ -167,15 +189,8 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 	/* SPI multiblock writes terminate using a special
 	 * token, not a STOP_TRANSMISSION request.
 	 */
-	if (!mmc_host_is_spi(mmc) && blkcnt > 1) {
-		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
-		cmd.cmdarg = 0;
-		cmd.resp_type = MMC_RSP_R1b;
-		if (mmc_send_cmd(mmc, &cmd, NULL)) {
-			printf("mmc fail to send stop cmd\n");
-			return 0;
-		}
-	}
+	if (!mmc_host_is_spi(mmc) && blkcnt > 1 && mmc_stop_write(mmc))
+		return 0;
 
 	/* Waiting for the ready status */
 	if (mmc_poll_for_busy(mmc, timeout_ms))
@@ -203,6 +218,13 @@ ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	if (!mmc)
 		return 0;
 
+#if CONFIG_IS_ENABLED(BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+	if (mmc->async_req) {
+		pr_debug("%s: Asynchronous transfer in progress\n", __func__);
+		return 0;
+	}
+#endif
+
 	err = blk_select_hwpart_devnum(IF_TYPE_MMC, dev_num, block_dev->hwpart);
 	if (err < 0)
 		return 0;
@@ -222,3 +244,127 @@ ulong mmc_bwrite(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 
 	return blkcnt;
 }
+
+#if CONFIG_IS_ENABLED(BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+/* Time allowed for the card to program the data of one transfer */
+#define MMC_WRITE_BUSY_TIMEOUT_MS	1000
+
+/* Start the next transfer of the asynchronous write in flight */
+static int mmc_bwrite_async_next(struct mmc *mmc)
+{
+	struct blk_req *req = mmc->async_req;
+	const void *src = req->buffer + req->done * mmc->write_bl_len;
+	lbaint_t cnt = req->blkcnt - req->done;
+	struct mmc_cmd cmd;
+
+	cnt = min(cnt, (lbaint_t)mmc->cfg->b_max);
+	mmc->async_cnt = cnt;
+	mmc->async_busy = false;
+	mmc_prepare_write(mmc, &cmd, &mmc->async_data, req->start + req->done,
+			  cnt, src);
+
+	return mmc_send_cmd_async(mmc, &cmd, &mmc->async_data);
+}
+
+/*
+ * Check once whether the card has finished programming the last transfer,
+ * like mmc_poll_for_busy() without waiting
+ */
+static int mmc_check_busy(struct mmc *mmc)
+{
+	unsigned int status;
+	int err;
+
+	err = mmc_send_status(mmc, &status);
+	if (err)
+		return err;
+
+	if ((status & MMC_STATUS_RDY_FOR_DATA) &&
+	    (status & MMC_STATUS_CURR_STATE) != MMC_STATE_PRG)
+		return 0;
+
+	if (status & MMC_STATUS_MASK) {
+		pr_err("Status Error: 0x%08x\n", status);
+		return -ECOMM;
+	}
+
+	if (get_timer(mmc->async_busy_start) > MMC_WRITE_BUSY_TIMEOUT_MS) {
+		pr_err("Timeout waiting card ready\n");
+		return -ETIMEDOUT;
+	}
+
+	return -EINPROGRESS;
+}
+
+int mmc_bwrite_async(struct udevice *dev, struct blk_req *req)
+{
+	struct blk_desc *block_dev = dev_get_uclass_platdata(dev);
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
+	int ret;
+
+	if (!mmc || !mmc_can_async(mmc))
+		return -ENOSYS;
+	if (!req->blkcnt)
+		return -EINVAL;
+	if (mmc->async_req)
+		return -EBUSY;
+
+	ret = blk_select_hwpart_devnum(IF_TYPE_MMC, block_dev->devnum,
+				       block_dev->hwpart);
+	if (ret < 0)
+		return ret;
+
+	if (req->start + req->blkcnt > block_dev->lba) {
+		printf("MMC: block number 0x" LBAF " exceeds max(0x" LBAF ")\n",
+		       req->start + req->blkcnt, block_dev->lba);
+		return -EINVAL;
+	}
+
+	if (mmc_set_blocklen(mmc, mmc->write_bl_len))
+		return -EIO;
+
+	mmc->async_req = req;
+	ret = mmc_bwrite_async_next(mmc);
+	if (ret)
+		mmc->async_req = NULL;
+
+	return ret;
+}
+
+long mmc_bwrite_poll(struct mmc *mmc, struct blk_req *req)
+{
+	int ret;
+
+	if (!mmc->async_busy) {
+		ret = mmc_poll_data(mmc, &mmc->async_data);
+		if (ret == -EINPROGRESS)
+			return ret;
+
+		if (!ret && !mmc_host_is_spi(mmc) && mmc->async_cnt > 1)
+			ret = mmc_stop_write(mmc);
+		if (ret)
+			goto out;
+
+		/* The card is programming the data, check it on each poll */
+		mmc->async_busy = true;
+		mmc->async_busy_start = get_timer(0);
+	}
+
+	ret = mmc_check_busy(mmc);
+	if (ret == -EINPROGRESS)
+		return ret;
+
+	if (!ret) {
+		req->done += mmc->async_cnt;
+		if (req->done < req->blkcnt) {
+			ret = mmc_bwrite_async_next(mmc);
+			if (!ret)
+				return -EINPROGRESS;
+		}
+	}
+out:
+	mmc->async_req = NULL;
+
+	return ret ? ret : req->done;
+}
+#endif
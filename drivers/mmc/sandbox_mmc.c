@@ -15,6 +15,7 @@
 struct sandbox_mmc_plat {
 	struct mmc_config cfg;
 	struct mmc mmc;
+	bool data_pending;
 };
 
 /**
@@ -90,6 +91,35 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+/* Transfers look busy until they are polled for the first time */
+static int sandbox_mmc_send_cmd_async(struct udevice *dev,
+				      struct mmc_cmd *cmd,
+				      struct mmc_data *data)
+{
+	struct sandbox_mmc_plat *plat = dev_get_platdata(dev);
+	int ret;
+
+	ret = sandbox_mmc_send_cmd(dev, cmd, data);
+	if (!ret && data)
+		plat->data_pending = true;
+
+	return ret;
+}
+
+static int sandbox_mmc_poll_data(struct udevice *dev, struct mmc_data *data)
+{
+	struct sandbox_mmc_plat *plat = dev_get_platdata(dev);
+
+	if (plat->data_pending) {
+		plat->data_pending = false;
+		return -EINPROGRESS;
+	}
+
+	return 0;
+}
+#endif
+
 static int sandbox_mmc_set_ios(struct udevice *dev)
 {
 	return 0;
@@ -102,6 +132,10 @@ static int sandbox_mmc_get_cd(struct udevice *dev)
 
 static const struct dm_mmc_ops sandbox_mmc_ops = {
 	.send_cmd = sandbox_mmc_send_cmd,
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	.send_cmd_async = sandbox_mmc_send_cmd_async,
+	.poll_data = sandbox_mmc_poll_data,
+#endif
 	.set_ios = sandbox_mmc_set_ios,
 	.get_cd = sandbox_mmc_get_cd,
 };
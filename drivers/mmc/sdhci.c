@@ -124,7 +124,27 @@ static void sdhci_prepare_dma(struct sdhci_host *host, struct mmc_data *data,
 			      int *is_aligned, int trans_bytes)
 {}
 #endif
-static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data)
+
+/*
+ * ADMA2 descriptors can only point to 32-bit aligned data, anything else is
+ * transferred by PIO.
+ */
+static bool sdhci_can_dma(struct sdhci_host *host, struct mmc_data *data)
+{
+	const void *buf;
+
+	if (!(host->flags & USE_DMA))
+		return false;
+	if (!(host->flags & (USE_ADMA | USE_ADMA64)))
+		return true;
+
+	buf = data->flags == MMC_DATA_READ ? data->dest : data->src;
+
+	return !((unsigned long)buf & 0x3);
+}
+
+static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
+			       bool dma)
 {
 	dma_addr_t start_addr = host->start_addr;
 	unsigned int stat, rdy, mask, timeout, block = 0;
@@ -155,8 +175,7 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data)
 				continue;
 			}
 		}
-		if ((host->flags & USE_DMA) && !transfer_done &&
-		    (stat & SDHCI_INT_DMA_END)) {
+		if (dma && !transfer_done && (stat & SDHCI_INT_DMA_END)) {
 			sdhci_writel(host, SDHCI_INT_DMA_END, SDHCI_INT_STATUS);
 			if (host->flags & USE_SDMA) {
 				start_addr &=
@@ -174,8 +193,10 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data)
 		}
 	} while (!(stat & SDHCI_INT_DATA_END));
 
-	dma_unmap_single(host->start_addr, data->blocks * data->blocksize,
-			 mmc_get_dma_dir(data));
+	if (dma)
+		dma_unmap_single(host->start_addr,
+				 data->blocks * data->blocksize,
+				 mmc_get_dma_dir(data));
 
 	return 0;
 }
@@ -191,22 +212,48 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data)
 #define SDHCI_CMD_DEFAULT_TIMEOUT		100
 #define SDHCI_READ_STATUS_TIMEOUT		1000
 
-#ifdef CONFIG_DM_MMC
-static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
+#define SDHCI_DATA_TIMEOUT			10000
+
+static int sdhci_finish_command(struct sdhci_host *host,
+				struct mmc_data *data, int ret,
+				int is_aligned, int trans_bytes)
 {
-	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	unsigned int stat;
 
-#else
-static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
+	if (host->quirks & SDHCI_QUIRK_WAIT_SEND_CMD)
+		udelay(1000);
+
+	stat = sdhci_readl(host, SDHCI_INT_STATUS);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	if (!ret) {
+		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
+				!is_aligned && (data->flags == MMC_DATA_READ))
+			memcpy(data->dest, host->align_buffer, trans_bytes);
+		return 0;
+	}
+
+	sdhci_reset(host, SDHCI_RESET_CMD);
+	sdhci_reset(host, SDHCI_RESET_DATA);
+	if (stat & SDHCI_INT_TIMEOUT)
+		return -ETIMEDOUT;
+	else
+		return -ECOMM;
+}
+
+/*
+ * Send a command and run its data transfer. With 'async' set, an ADMA2 data
+ * transfer is left running once the command has been accepted and is
+ * completed by sdhci_poll_data().
+ */
+static int sdhci_do_command(struct mmc *mmc, struct mmc_cmd *cmd,
+			    struct mmc_data *data, bool async)
 {
-#endif
 	struct sdhci_host *host = mmc->priv;
 	unsigned int stat = 0;
 	int ret = 0;
 	int trans_bytes = 0, is_aligned = 1;
 	u32 mask, flags, mode;
+	bool dma = false;
 	unsigned int time = 0;
 	int mmc_dev = mmc_get_blk_desc(mmc)->devnum;
 	ulong start = get_timer(0);
@@ -277,7 +324,8 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		if (data->flags == MMC_DATA_READ)
 			mode |= SDHCI_TRNS_READ;
 
-		if (host->flags & USE_DMA) {
+		dma = sdhci_can_dma(host, data);
+		if (dma) {
 			mode |= SDHCI_TRNS_DMA;
 			sdhci_prepare_dma(host, data, &is_aligned, trans_bytes);
 		}
@@ -316,28 +364,77 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	} else
 		ret = -1;
 
-	if (!ret && data)
-		ret = sdhci_transfer_data(host, data);
+	if (!ret && data) {
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+		if (async && dma && (host->flags & (USE_ADMA | USE_ADMA64))) {
+			host->data_start = get_timer(0);
+			host->data_pending = true;
+			return 0;
+		}
+#endif
+		ret = sdhci_transfer_data(host, data, dma);
+	}
 
-	if (host->quirks & SDHCI_QUIRK_WAIT_SEND_CMD)
-		udelay(1000);
+	return sdhci_finish_command(host, data, ret, is_aligned, trans_bytes);
+}
 
-	stat = sdhci_readl(host, SDHCI_INT_STATUS);
-	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
-	if (!ret) {
-		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				!is_aligned && (data->flags == MMC_DATA_READ))
-			memcpy(data->dest, host->align_buffer, trans_bytes);
+#ifdef CONFIG_DM_MMC
+static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+	return sdhci_do_command(mmc_get_mmc_dev(dev), cmd, data, false);
+}
+
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+static int sdhci_send_command_async(struct udevice *dev, struct mmc_cmd *cmd,
+				    struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	host->data_pending = false;
+
+	/* PIO and SDMA transfers need the CPU, so they are done right away */
+	return sdhci_do_command(mmc, cmd, data, true);
+}
+
+static int sdhci_poll_data(struct udevice *dev, struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+	unsigned int stat;
+	int ret = 0;
+
+	if (!host->data_pending)
 		return 0;
+
+	stat = sdhci_readl(host, SDHCI_INT_STATUS);
+	if (stat & SDHCI_INT_ERROR) {
+		pr_debug("%s: Error detected in status(0x%X)!\n",
+			 __func__, stat);
+		ret = -EIO;
+	} else if (!(stat & SDHCI_INT_DATA_END)) {
+		if (get_timer(host->data_start) < SDHCI_DATA_TIMEOUT)
+			return -EINPROGRESS;
+		printf("%s: Transfer data timeout\n", __func__);
+		ret = -ETIMEDOUT;
+	} else {
+		dma_unmap_single(host->start_addr,
+				 data->blocks * data->blocksize,
+				 mmc_get_dma_dir(data));
 	}
+	host->data_pending = false;
 
-	sdhci_reset(host, SDHCI_RESET_CMD);
-	sdhci_reset(host, SDHCI_RESET_DATA);
-	if (stat & SDHCI_INT_TIMEOUT)
-		return -ETIMEDOUT;
-	else
-		return -ECOMM;
+	return sdhci_finish_command(host, data, ret, 1, 0);
 }
+#endif
+#else
+static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+	return sdhci_do_command(mmc, cmd, data, false);
+}
+#endif
 
 #if defined(CONFIG_DM_MMC) && defined(MMC_SUPPORTS_TUNING)
 static int sdhci_execute_tuning(struct udevice *dev, uint opcode)
@@ -667,6 +764,10 @@ static int sdhci_get_cd(struct udevice *dev)
 
 const struct dm_mmc_ops sdhci_ops = {
 	.send_cmd	= sdhci_send_command,
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	.send_cmd_async	= sdhci_send_command_async,
+	.poll_data	= sdhci_poll_data,
+#endif
 	.set_ios	= sdhci_set_ios,
 	.get_cd		= sdhci_get_cd,
 	.deferred_probe	= sdhci_deferred_probe,
@@ -711,18 +812,27 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 #endif
 #if CONFIG_IS_ENABLED(MMC_SDHCI_ADMA)
 	if (!(caps & SDHCI_CAN_DO_ADMA2)) {
-		printf("%s: Your controller doesn't support SDMA!!\n",
+		printf("%s: Your controller doesn't support ADMA!!\n",
 		       __func__);
-		return -EINVAL;
-	}
-	host->adma_desc_table = sdhci_adma_init();
-	host->adma_addr = (dma_addr_t)host->adma_desc_table;
+		if (!(host->flags & USE_SDMA))
+			return -EINVAL;
+	} else {
+		host->adma_desc_table = sdhci_adma_init();
+		if (!host->adma_desc_table)
+			return -ENOMEM;
+		host->adma_addr = (dma_addr_t)host->adma_desc_table;
 
+		/*
+		 * ADMA2 has no boundary interrupts to service, so prefer it
+		 * over SDMA when both are available.
+		 */
+		host->flags &= ~USE_SDMA;
 #ifdef CONFIG_DMA_ADDR_T_64BIT
-	host->flags |= USE_ADMA64;
+		host->flags |= USE_ADMA64;
 #else
-	host->flags |= USE_ADMA;
+		host->flags |= USE_ADMA;
 #endif
+	}
 #endif
 	if (host->quirks & SDHCI_QUIRK_REG32_RW)
 		host->version =
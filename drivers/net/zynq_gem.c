@@ -180,25 +180,32 @@ struct emac_bd {
 #endif
 };
 
-/* Reduce amount of BUFs if you have limited amount of memory */
-#define RX_BUF 32
 /* Page table entries are set to 1MB, or multiples of 1MB
  * (not < 1MB). driver uses less bd's so use 1MB bdspace.
  */
 #define BD_SPACE	0x100000
-/* BD separation space */
-#define BD_SEPRN_SPACE	(RX_BUF * sizeof(struct emac_bd))
+/* BD separation space, the TX BDs come first */
+#define BD_SEPRN_SPACE	(32 * sizeof(struct emac_bd))
+/* Largest RX ring which fits into the BD space */
+#define RX_BUF_MAX	((BD_SPACE - BD_SEPRN_SPACE) / sizeof(struct emac_bd))
 
 /* Setup the first free TX descriptor */
 #define TX_FREE_DESC	2
 
-/* Initialized, rxbd_current, rx_first_buf must be 0 after init */
+/*
+ * Initialized, rxbd_current, rx_first_buf, rx_ready must be 0 after init
+ *
+ * rx_count is the number of RX BDs and buffers. rx_ready is the number of
+ * frames from rxbd_current on whose buffers were already invalidated.
+ */
 struct zynq_gem_priv {
 	struct emac_bd *tx_bd;
 	struct emac_bd *rx_bd;
 	char *rxbuffers;
+	u32 rx_count;
 	u32 rxbd_current;
 	u32 rx_first_buf;
+	u32 rx_ready;
 	int phyaddr;
 	int init;
 	struct zynq_gem_regs *iobase;
@@ -386,9 +393,9 @@ static int zynq_gem_init(struct udevice *dev)
 			readl(&regs->stat[i]);
 
 		/* Setup RxBD space */
-		memset(priv->rx_bd, 0, RX_BUF * sizeof(struct emac_bd));
+		memset(priv->rx_bd, 0, priv->rx_count * sizeof(struct emac_bd));
 
-		for (i = 0; i < RX_BUF; i++) {
+		for (i = 0; i < priv->rx_count; i++) {
 			priv->rx_bd[i].status = 0xF0000000;
 			priv->rx_bd[i].addr =
 					(lower_32_bits((ulong)(priv->rxbuffers)
@@ -554,11 +561,50 @@ static int zynq_gem_send(struct udevice *dev, void *ptr, int len)
 				 true, 20000, true);
 }
 
+static dma_addr_t zynq_gem_rx_addr(struct emac_bd *bd)
+{
+#if defined(CONFIG_PHYS_64BIT)
+	return (dma_addr_t)((bd->addr & ZYNQ_GEM_RXBUF_ADD_MASK)
+		| ((dma_addr_t)bd->addr_hi << 32));
+#else
+	return bd->addr & ZYNQ_GEM_RXBUF_ADD_MASK;
+#endif
+}
+
+/*
+ * Invalidate the buffers of all frames received from the current BD up to
+ * the end of the ring with one operation, the buffers are contiguous.
+ *
+ * Return: number of frames whose buffers were invalidated
+ */
+static u32 zynq_gem_rx_invalidate(struct zynq_gem_priv *priv)
+{
+	struct emac_bd *bd = &priv->rx_bd[priv->rxbd_current];
+	struct emac_bd *last = bd;
+	dma_addr_t start, end;
+	u32 i, count = 0;
+
+	for (i = priv->rxbd_current; i < priv->rx_count; i++, bd++) {
+		if (!(bd->addr & ZYNQ_GEM_RXBUF_NEW_MASK))
+			break;
+		last = bd;
+		count++;
+	}
+
+	start = zynq_gem_rx_addr(&priv->rx_bd[priv->rxbd_current]);
+	end = zynq_gem_rx_addr(last) +
+	      roundup(last->status & ZYNQ_GEM_RXBUF_LEN_MASK,
+		      ARCH_DMA_MINALIGN);
+	invalidate_dcache_range(start, end);
+	barrier();
+
+	return count;
+}
+
 /* Do not check frame_recd flag in rx_status register 0x20 - just poll BD */
 static int zynq_gem_recv(struct udevice *dev, int flags, uchar **packetp)
 {
 	int frame_len;
-	dma_addr_t addr;
 	struct zynq_gem_priv *priv = dev_get_priv(dev);
 	struct emac_bd *current_bd = &priv->rx_bd[priv->rxbd_current];
 
@@ -577,18 +623,14 @@ static int zynq_gem_recv(struct udevice *dev, int flags, uchar **packetp)
 		return -1;
 	}
 
-#if defined(CONFIG_PHYS_64BIT)
-	addr = (dma_addr_t)((current_bd->addr & ZYNQ_GEM_RXBUF_ADD_MASK)
-		      | ((dma_addr_t)current_bd->addr_hi << 32));
-#else
-	addr = current_bd->addr & ZYNQ_GEM_RXBUF_ADD_MASK;
-#endif
-	addr &= ~(ARCH_DMA_MINALIGN - 1);
-
-	*packetp = (uchar *)(uintptr_t)addr;
+	/*
+	 * The stack works on the frame in the DMA buffer, which goes back
+	 * to the GEM in zynq_gem_free_pkt()
+	 */
+	*packetp = (uchar *)(uintptr_t)zynq_gem_rx_addr(current_bd);
 
-	invalidate_dcache_range(addr, addr + roundup(PKTSIZE_ALIGN, ARCH_DMA_MINALIGN));
-	barrier();
+	if (!priv->rx_ready)
+		priv->rx_ready = zynq_gem_rx_invalidate(priv);
 
 	return frame_len;
 }
@@ -600,6 +642,16 @@ static int zynq_gem_free_pkt(struct udevice *dev, uchar *packet, int length)
 	struct emac_bd *first_bd;
 	dma_addr_t addr;
 
+	/*
+	 * Drop whatever the stack wrote to the frame before the GEM owns
+	 * the buffer again, so that no dirty line is written back over the
+	 * next frame
+	 */
+	addr = zynq_gem_rx_addr(current_bd);
+	invalidate_dcache_range(addr, addr + roundup(length,
+						     ARCH_DMA_MINALIGN));
+	barrier();
+
 	if (current_bd->status & ZYNQ_GEM_RXBUF_SOF_MASK) {
 		priv->rx_first_buf = priv->rxbd_current;
 	} else {
@@ -613,18 +665,9 @@ static int zynq_gem_free_pkt(struct udevice *dev, uchar *packet, int length)
 		first_bd->status = 0xF0000000;
 	}
 
-	/* Flush the cache for the packet as well */
-#if defined(CONFIG_PHYS_64BIT)
-	addr = (dma_addr_t)((current_bd->addr & ZYNQ_GEM_RXBUF_ADD_MASK)
-		| ((dma_addr_t)current_bd->addr_hi << 32));
-#else
-	addr = current_bd->addr & ZYNQ_GEM_RXBUF_ADD_MASK;
-#endif
-	flush_dcache_range(addr, addr + roundup(PKTSIZE_ALIGN,
-						ARCH_DMA_MINALIGN));
-	barrier();
-
-	if ((++priv->rxbd_current) >= RX_BUF)
+	if (priv->rx_ready)
+		priv->rx_ready--;
+	if ((++priv->rxbd_current) >= priv->rx_count)
 		priv->rxbd_current = 0;
 
 	return 0;
@@ -682,13 +725,15 @@ static int zynq_gem_probe(struct udevice *dev)
 	int ret;
 
 	/* Align rxbuffers to ARCH_DMA_MINALIGN */
-	priv->rxbuffers = memalign(ARCH_DMA_MINALIGN, RX_BUF * PKTSIZE_ALIGN);
+	priv->rxbuffers = memalign(ARCH_DMA_MINALIGN,
+				   priv->rx_count * PKTSIZE_ALIGN);
 	if (!priv->rxbuffers)
 		return -ENOMEM;
 
-	memset(priv->rxbuffers, 0, RX_BUF * PKTSIZE_ALIGN);
+	memset(priv->rxbuffers, 0, priv->rx_count * PKTSIZE_ALIGN);
 	ulong addr = (ulong)priv->rxbuffers;
-	flush_dcache_range(addr, addr + roundup(RX_BUF * PKTSIZE_ALIGN, ARCH_DMA_MINALIGN));
+	flush_dcache_range(addr, addr + roundup(priv->rx_count * PKTSIZE_ALIGN,
+						ARCH_DMA_MINALIGN));
 	barrier();
 
 	/* Align bd_space to MMU_SECTION_SHIFT */
@@ -807,6 +852,14 @@ static int zynq_gem_ofdata_to_platdata(struct udevice *dev)
 
 	priv->int_pcs = dev_read_bool(dev, "is-internal-pcspma");
 
+	priv->rx_count = dev_read_u32_default(dev, "rx-ring-size",
+					      CONFIG_ZYNQ_GEM_RX_BUFFERS);
+	if (priv->rx_count < 2 || priv->rx_count > RX_BUF_MAX) {
+		debug("%s: Invalid RX ring size %u\n", __func__,
+		      priv->rx_count);
+		return -EINVAL;
+	}
+
 	printf("\nZYNQ GEM: %lx, mdio bus %lx, phyaddr %d, interface %s\n",
 	       (ulong)priv->iobase, (ulong)priv->mdiobase, priv->phyaddr,
 	       phy_string_for_interface(priv->interface));
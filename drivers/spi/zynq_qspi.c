@@ -17,6 +17,7 @@
 #include <asm/io.h>
 #include <clk.h>
 #include <spi-mem.h>
+#include <linux/sizes.h>
 #include "../mtd/spi/sf_internal.h"
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -56,6 +57,11 @@ DECLARE_GLOBAL_DATA_PTR;
 #define ZYNQ_QSPI_LCFG_SEP_BUS_MASK	0x20000000 /* QSPI Enable Bit Mask */
 #define ZYNQ_QSPI_LCFG_U_PAGE		0x10000000 /* QSPI Upper memory set */
 #define ZYNQ_QSPI_LCFG_DUMMY_SHIFT	8
+#define ZYNQ_QSPI_LCFG_DUMMY_MAX	7
+
+/* Linear mode maps 16MiB of each memory, 32MiB for a dual parallel pair */
+#define ZYNQ_QSPI_LINEAR_BASE		0xFC000000
+#define ZYNQ_QSPI_LINEAR_SIZE		SZ_16M
 
 #define ZYNQ_QSPI_TXFIFO_THRESHOLD	1	/* Tx FIFO threshold level*/
 #define ZYNQ_QSPI_RXFIFO_THRESHOLD	32	/* Rx FIFO threshold level */
@@ -916,8 +922,95 @@ static int zynq_qspi_exec_op(struct spi_slave *slave,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+static int zynq_qspi_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	struct zynq_qspi_priv *priv = dev_get_priv(desc->slave->dev->parent);
+	const struct spi_mem_op *op = &desc->info.op_tmpl;
+
+	/* The U_PAGE memory select of a stacked pair is ignored by linear mode */
+	if (priv->is_dual == SF_DUAL_STACKED_FLASH)
+		return -ENOTSUPP;
+
+	/* Linear mode only sends 3 address bytes and no mode bits */
+	switch (op->cmd.opcode) {
+	case SPINOR_OP_READ:
+	case SPINOR_OP_READ_FAST:
+	case SPINOR_OP_READ_1_1_2:
+	case SPINOR_OP_READ_1_1_4:
+		break;
+	default:
+		return -ENOTSUPP;
+	}
+	if (op->cmd.buswidth != 1 || op->addr.nbytes != 3 ||
+	    op->addr.buswidth != 1 ||
+	    op->dummy.nbytes > ZYNQ_QSPI_LCFG_DUMMY_MAX)
+		return -ENOTSUPP;
+
+	return 0;
+}
+
+/**
+ * zynq_qspi_dirmap_read - Read from the flash through the linear window
+ * @desc:	Direct mapping descriptor
+ * @offs:	Flash offset, per memory for a dual parallel pair
+ * @len:	Number of bytes to read
+ * @buf:	Buffer to read into
+ *
+ * The controller is switched to linear mode for the read, so that it issues
+ * the read command and address itself for each AXI burst and the data can
+ * be copied out of the linear window instead of the RX FIFO. Then the
+ * previous I/O mode setup is restored.
+ *
+ * returns:	Number of bytes read, which is less than @len if the read
+ *		crosses the end of the 3-byte address space
+ */
+static ssize_t zynq_qspi_dirmap_read(struct spi_mem_dirmap_desc *desc,
+				     u64 offs, size_t len, void *buf)
+{
+	struct zynq_qspi_priv *priv = dev_get_priv(desc->slave->dev->parent);
+	const struct spi_mem_op *op = &desc->info.op_tmpl;
+	struct zynq_qspi_regs *regs = priv->regs;
+	u32 confr, lqspicfg, addr;
+	int shift;
+
+	/* Both memories of a dual parallel pair are interleaved in one window */
+	shift = priv->is_dual == SF_DUAL_PARALLEL_FLASH;
+	addr = ((desc->info.offset + offs) & (ZYNQ_QSPI_LINEAR_SIZE - 1)) <<
+		shift;
+	len = min_t(size_t, len, (ZYNQ_QSPI_LINEAR_SIZE << shift) - addr);
+
+	confr = readl(&regs->cr);
+	lqspicfg = readl(&regs->lqspicfg);
+
+	/* Linear mode drives the chip select and starts transfers itself */
+	writel(~ZYNQ_QSPI_ENR_SPI_EN_MASK, &regs->enr);
+	writel(confr & ~(ZYNQ_QSPI_CR_MSA_MASK | ZYNQ_QSPI_CR_MCS_MASK |
+			 ZYNQ_QSPI_CR_SS_MASK), &regs->cr);
+	writel(ZYNQ_QSPI_LQSPICFG_LQMODE_MASK |
+	       (lqspicfg & (ZYNQ_QSPI_LCFG_TWO_MEM_MASK |
+			    ZYNQ_QSPI_LCFG_SEP_BUS_MASK)) |
+	       (op->dummy.nbytes << ZYNQ_QSPI_LCFG_DUMMY_SHIFT) |
+	       op->cmd.opcode, &regs->lqspicfg);
+	writel(ZYNQ_QSPI_ENR_SPI_EN_MASK, &regs->enr);
+
+	memcpy(buf, (void *)ZYNQ_QSPI_LINEAR_BASE + addr, len);
+
+	writel(~ZYNQ_QSPI_ENR_SPI_EN_MASK, &regs->enr);
+	writel(lqspicfg, &regs->lqspicfg);
+	writel(confr, &regs->cr);
+	writel(ZYNQ_QSPI_ENR_SPI_EN_MASK, &regs->enr);
+
+	return len;
+}
+#endif
+
 static const struct spi_controller_mem_ops zynq_qspi_mem_ops = {
 	.exec_op = zynq_qspi_exec_op,
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	.dirmap_create = zynq_qspi_dirmap_create,
+	.dirmap_read = zynq_qspi_dirmap_read,
+#endif
 };
 
 static const struct dm_spi_ops zynq_qspi_ops = {
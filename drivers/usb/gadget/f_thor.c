@@ -144,6 +144,20 @@ static int process_rqt_cmd(const struct rqt_box *rqt)
 	return true;
 }
 
+/*
+ * Get the size of the next unit. It is received at the write position of
+ * the DFU buffer, after the data which dfu_write() still holds, so it is
+ * capped to the free part of the buffer.
+ */
+static unsigned long thor_unit_size(struct dfu_entity *dfu,
+				    unsigned int packet_size)
+{
+	unsigned long space = dfu->i_buf_end - dfu->i_buf;
+
+	return rounddown(min_t(unsigned long, space, THOR_STORE_UNIT_SIZE),
+			 packet_size);
+}
+
 static long long int download_head(unsigned long long total,
 				   unsigned int packet_size,
 				   long long int *left,
@@ -151,17 +165,30 @@ static long long int download_head(unsigned long long total,
 {
 	long long int rcv_cnt = 0, left_to_rcv, ret_rcv;
 	struct dfu_entity *dfu_entity = dfu_get_entity(alt_setting_num);
-	void *transfer_buffer = dfu_get_buf(dfu_entity);
-	void *buf = transfer_buffer;
+	void *transfer_buffer, *buf;
+	unsigned long unit;
 	int usb_pkt_cnt = 0, ret;
 
+	ret = dfu_transaction_initiate(dfu_entity, false);
+	if (ret)
+		return ret;
+
 	/*
-	 * Files smaller than THOR_STORE_UNIT_SIZE (now 32 MiB) are stored on
-	 * the medium.
+	 * Data is stored on the medium in units of at most THOR_STORE_UNIT_SIZE
+	 * (now 32 MiB), which must fit into the free part of the DFU buffer.
 	 * The packet response is sent on the purpose after successful data
-	 * chunk write. There is a room for improvement when asynchronous write
-	 * is performed.
+	 * chunk write. With CONFIG_DFU_WRITE_BEHIND, dfu_write() only starts
+	 * writing a unit and the next one is received into the other half of
+	 * the DFU buffer meanwhile.
 	 */
+	unit = thor_unit_size(dfu_entity, packet_size);
+	if (!unit) {
+		pr_err("DFU buffer smaller than a packet\n");
+		return -ENOBUFS;
+	}
+	transfer_buffer = dfu_entity->i_buf;
+	buf = transfer_buffer;
+
 	while (total - rcv_cnt >= packet_size) {
 		thor_set_dma(buf, packet_size);
 		buf += packet_size;
@@ -172,16 +199,29 @@ static long long int download_head(unsigned long long total,
 		debug("%d: RCV data count: %llu cnt: %d\n", usb_pkt_cnt,
 		      rcv_cnt, *cnt);
 
-		if ((rcv_cnt % THOR_STORE_UNIT_SIZE) == 0) {
-			ret = dfu_write(dfu_get_entity(alt_setting_num),
-					transfer_buffer, THOR_STORE_UNIT_SIZE,
+		if (buf - transfer_buffer == unit) {
+			ret = dfu_write(dfu_entity, transfer_buffer, unit,
 					(*cnt)++);
 			if (ret) {
 				pr_err("DFU write failed [%d] cnt: %d\n",
 				      ret, *cnt);
 				return ret;
 			}
+			/* The next unit is received where dfu_write() wants it */
+			transfer_buffer = dfu_entity->i_buf;
 			buf = transfer_buffer;
+			unit = thor_unit_size(dfu_entity, packet_size);
+			if (!unit) {
+				pr_err("DFU buffer full\n");
+				return -ENOBUFS;
+			}
+		} else {
+			ret = dfu_write_poll(dfu_entity);
+			if (ret) {
+				pr_err("DFU write failed [%d] cnt: %d\n",
+				      ret, *cnt);
+				return ret;
+			}
 		}
 		send_data_rsp(0, ++usb_pkt_cnt);
 	}
@@ -191,7 +231,7 @@ static long long int download_head(unsigned long long total,
 
 	/*
 	 * Calculate number of data already received. but not yet stored
-	 * on the medium (they are smaller than THOR_STORE_UNIT_SIZE)
+	 * on the medium (they are smaller than a unit)
 	 */
 	*left = left_to_rcv + buf - transfer_buffer;
 	debug("%s: left: %llu left_to_rcv: %llu buf: 0x%p\n", __func__,
@@ -225,7 +265,8 @@ static int download_tail(long long int left, int cnt)
 		return -ENOENT;
 	}
 
-	transfer_buffer = dfu_get_buf(dfu_entity);
+	/* download_head() left the data where dfu_write() expects it */
+	transfer_buffer = dfu_entity->i_buf;
 	if (!transfer_buffer) {
 		pr_err("Transfer buffer not allocated!\n");
 		return -ENXIO;
@@ -56,6 +56,8 @@ static int console_normal_set_row(struct udevice *dev, uint row, int clr)
 	ret = vidconsole_sync_copy(dev, line, end);
 	if (ret)
 		return ret;
+	video_damage(dev->parent, 0, VIDEO_FONT_HEIGHT * row, vid_priv->xsize,
+		     VIDEO_FONT_HEIGHT);
 
 	return 0;
 }
@@ -75,6 +77,8 @@ static int console_normal_move_rows(struct udevice *dev, uint rowdst,
 	ret = vidconsole_memmove(dev, dst, src, size);
 	if (ret)
 		return ret;
+	video_damage(dev->parent, 0, VIDEO_FONT_HEIGHT * rowdst,
+		     vid_priv->xsize, VIDEO_FONT_HEIGHT * count);
 
 	return 0;
 }
@@ -146,6 +150,8 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
+	video_damage(vid, VID_TO_PIXEL(x_frac), y, VIDEO_FONT_WIDTH,
+		     VIDEO_FONT_HEIGHT);
 
 	return VID_TO_POS(VIDEO_FONT_WIDTH);
 }
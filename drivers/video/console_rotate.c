@@ -56,6 +56,9 @@ static int console_set_row_1(struct udevice *dev, uint row, int clr)
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
+	video_damage(dev->parent,
+		     vid_priv->xsize - (row + 1) * VIDEO_FONT_HEIGHT, 0,
+		     VIDEO_FONT_HEIGHT, vid_priv->ysize);
 
 	return 0;
 }
@@ -82,6 +85,9 @@ static int console_move_rows_1(struct udevice *dev, uint rowdst, uint rowsrc,
 		src += vid_priv->line_length;
 		dst += vid_priv->line_length;
 	}
+	video_damage(dev->parent,
+		     vid_priv->xsize - (rowdst + count) * VIDEO_FONT_HEIGHT, 0,
+		     VIDEO_FONT_HEIGHT * count, vid_priv->ysize);
 
 	return 0;
 }
@@ -149,6 +155,8 @@ static int console_putc_xy_1(struct udevice *dev, uint x_frac, uint y, char ch)
 	ret = vidconsole_sync_copy(dev, start - vid_priv->line_length, line);
 	if (ret)
 		return ret;
+	video_damage(vid, vid_priv->xsize - x - VIDEO_FONT_HEIGHT + 1,
+		     linenum - 1, VIDEO_FONT_HEIGHT, VIDEO_FONT_HEIGHT);
 
 	return VID_TO_POS(VIDEO_FONT_WIDTH);
 }
@@ -198,6 +206,9 @@ static int console_set_row_2(struct udevice *dev, uint row, int clr)
 	ret = vidconsole_sync_copy(dev, start, end);
 	if (ret)
 		return ret;
+	video_damage(dev->parent, 0,
+		     vid_priv->ysize - (row + 1) * VIDEO_FONT_HEIGHT,
+		     vid_priv->xsize, VIDEO_FONT_HEIGHT);
 
 	return 0;
 }
@@ -217,6 +228,9 @@ static int console_move_rows_2(struct udevice *dev, uint rowdst, uint rowsrc,
 		vid_priv->line_length;
 	vidconsole_memmove(dev, dst, src,
 			   VIDEO_FONT_HEIGHT * vid_priv->line_length * count);
+	video_damage(dev->parent, 0,
+		     vid_priv->ysize - (rowdst + count) * VIDEO_FONT_HEIGHT,
+		     vid_priv->xsize, VIDEO_FONT_HEIGHT * count);
 
 	return 0;
 }
@@ -287,6 +301,9 @@ static int console_putc_xy_2(struct udevice *dev, uint x_frac, uint y, char ch)
 	ret = vidconsole_sync_copy(dev, start + 4, line);
 	if (ret)
 		return ret;
+	video_damage(vid, x - VIDEO_FONT_WIDTH + 1,
+		     linenum - VIDEO_FONT_HEIGHT + 1, VIDEO_FONT_WIDTH,
+		     VIDEO_FONT_HEIGHT);
 
 	return VID_TO_POS(VIDEO_FONT_WIDTH);
 }
@@ -334,6 +351,8 @@ static int console_set_row_3(struct udevice *dev, uint row, int clr)
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
+	video_damage(dev->parent, row * VIDEO_FONT_HEIGHT, 0, VIDEO_FONT_HEIGHT,
+		     vid_priv->ysize);
 
 	return 0;
 }
@@ -358,6 +377,8 @@ static int console_move_rows_3(struct udevice *dev, uint rowdst, uint rowsrc,
 		src += vid_priv->line_length;
 		dst += vid_priv->line_length;
 	}
+	video_damage(dev->parent, rowdst * VIDEO_FONT_HEIGHT, 0,
+		     VIDEO_FONT_HEIGHT * count, vid_priv->ysize);
 
 	return 0;
 }
@@ -423,6 +444,8 @@ static int console_putc_xy_3(struct udevice *dev, uint x_frac, uint y, char ch)
 	ret = vidconsole_sync_copy(dev, start + vid_priv->line_length, line);
 	if (ret)
 		return ret;
+	video_damage(vid, y, x - VIDEO_FONT_HEIGHT + 1, VIDEO_FONT_HEIGHT,
+		     VIDEO_FONT_HEIGHT);
 
 	return VID_TO_POS(VIDEO_FONT_WIDTH);
 }
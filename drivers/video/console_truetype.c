@@ -9,6 +9,7 @@
 #include <malloc.h>
 #include <video.h>
 #include <video_console.h>
+#include <linux/list.h>
 
 /* Functions needed by stb_truetype.h */
 static int tt_floor(double val)
@@ -93,6 +94,38 @@ struct pos_info {
  */
 #define POS_HISTORY_SIZE	(CONFIG_SYS_CBSIZE * 11 / 10)
 
+/* Marks an unused entry in the glyph cache */
+#define TT_NO_CHAR	INT_MIN
+
+/**
+ * struct tt_glyph - A character rendered in the display's pixel format
+ *
+ * Glyphs are kept so that text which is printed again, such as a status line
+ * or progress message, is copied to the display rather than rasterised again.
+ * Each console has its own cache, so the font and its size are implied.
+ *
+ * @sibling:	Position in the list of glyphs, most recently used first
+ * @ch:		Character, or TT_NO_CHAR if this entry is unused
+ * @x_shift:	Sub-pixel X offset the character was rendered at
+ * @inverted:	true if rendered for a non-black background
+ * @width:	Width of the image in pixels
+ * @height:	Height of the image in pixels
+ * @xoff:	X offset of the image from the cursor position
+ * @yoff:	Y offset of the image from the baseline
+ * @pixels:	@width * @height pixels, or NULL if the character is blank
+ */
+struct tt_glyph {
+	struct list_head sibling;
+	int ch;
+	double x_shift;
+	bool inverted;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	void *pixels;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -112,6 +145,8 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @glyph:	CONFIG_CONSOLE_TRUETYPE_GLYPHS rendered characters
+ * @glyphs:	List of @glyph, most recently used first
  */
 struct console_tt_priv {
 	int font_size;
@@ -121,6 +156,8 @@ struct console_tt_priv {
 	int pos_ptr;
 	int baseline;
 	double scale;
+	struct tt_glyph *glyph;
+	struct list_head glyphs;
 };
 
 static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
@@ -169,6 +206,8 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 	ret = vidconsole_sync_copy(dev, line, end);
 	if (ret)
 		return ret;
+	video_damage(dev->parent, 0, priv->font_size * row, vid_priv->xsize,
+		     priv->font_size);
 
 	return 0;
 }
@@ -188,6 +227,8 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 				 vid_priv->line_length * count);
 	if (ret)
 		return ret;
+	video_damage(dev->parent, 0, priv->font_size * rowdst, vid_priv->xsize,
+		     priv->font_size * count);
 
 	/* Scroll up our position history */
 	diff = (rowsrc - rowdst) * priv->font_size;
@@ -197,6 +238,102 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/**
+ * console_truetype_get_glyph() - Get a character rendered for the display
+ *
+ * The character is rendered, replacing the least recently used glyph, if
+ * it is not already in the cache.
+ *
+ * @dev:	Device to render for
+ * @ch:		Character to render
+ * @x_shift:	Sub-pixel X offset to render at
+ * @glyphp:	Returns the glyph
+ * @return 0 if OK, -ENOSYS if the display depth is not supported, -ENOMEM
+ *	if out of memory
+ */
+static int console_truetype_get_glyph(struct udevice *dev, int ch,
+				      double x_shift, struct tt_glyph **glyphp)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	bool inverted = vid_priv->colour_bg;
+	struct tt_glyph *glyph;
+	int pixels, i;
+	u8 *data;
+
+	list_for_each_entry(glyph, &priv->glyphs, sibling) {
+		if (glyph->ch == ch && glyph->x_shift == x_shift &&
+		    glyph->inverted == inverted) {
+			list_move(&glyph->sibling, &priv->glyphs);
+			*glyphp = glyph;
+			return 0;
+		}
+	}
+
+	glyph = list_last_entry(&priv->glyphs, struct tt_glyph, sibling);
+	free(glyph->pixels);
+	glyph->pixels = NULL;
+	glyph->ch = TT_NO_CHAR;
+
+	/*
+	 * This returns an 8-bit-per-pixel image of the character, with
+	 * x_shift telling how far past the start of a pixel it starts. For
+	 * empty characters, like ' ', data is NULL.
+	 */
+	data = stbtt_GetCodepointBitmapSubpixel(&priv->font, priv->scale,
+						priv->scale, x_shift, 0, ch,
+						&glyph->width, &glyph->height,
+						&glyph->xoff, &glyph->yoff);
+	if (data) {
+		pixels = glyph->width * glyph->height;
+		glyph->pixels = malloc(pixels * VNBYTES(vid_priv->bpix));
+		if (!glyph->pixels) {
+			free(data);
+			return -ENOMEM;
+		}
+
+		/*
+		 * Convert the image into the colour depth of the display. We
+		 * only expect white-on-black or the reverse so the code only
+		 * handles this simple case.
+		 */
+		for (i = 0; i < pixels; i++) {
+			int val = data[i];
+
+			if (inverted)
+				val = 255 - val;
+			switch (vid_priv->bpix) {
+#ifdef CONFIG_VIDEO_BPP16
+			case VIDEO_BPP16:
+				((u16 *)glyph->pixels)[i] = val >> 3 |
+					(val >> 2) << 5 |
+					(val >> 3) << 11;
+				break;
+#endif
+#ifdef CONFIG_VIDEO_BPP32
+			case VIDEO_BPP32:
+				((u32 *)glyph->pixels)[i] = val | val << 8 |
+					val << 16;
+				break;
+#endif
+			default:
+				free(glyph->pixels);
+				glyph->pixels = NULL;
+				free(data);
+				return -ENOSYS;
+			}
+		}
+		free(data);
+	}
+	glyph->ch = ch;
+	glyph->x_shift = x_shift;
+	glyph->inverted = inverted;
+	list_move(&glyph->sibling, &priv->glyphs);
+	*glyphp = glyph;
+
+	return 0;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    char ch)
 {
@@ -205,14 +342,13 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	stbtt_fontinfo *font = &priv->font;
-	int width, height, xoff, yoff;
+	struct tt_glyph *glyph;
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
 	int advance;
-	void *start, *end, *line;
+	void *start, *line;
 	int row, ret;
 
 	/* First get some basic metrics about this character */
@@ -249,81 +385,59 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	}
 
 	/*
-	 * Figure out how much past the start of a pixel we are, and pass this
-	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * Figure out how much past the start of a pixel we are, and get the
+	 * character rendered with that offset
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, priv->scale, priv->scale,
-						x_shift, 0, ch, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+	ret = console_truetype_get_glyph(dev, ch, x_shift, &glyph);
+	if (ret)
+		return ret;
+	if (!glyph->pixels)
 		return width_frac;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
 	start = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = priv->baseline + yoff;
+	linenum = priv->baseline + glyph->yoff;
 	if (linenum > 0)
 		start += linenum * vid_priv->line_length;
 	line = start;
 
-	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
-	 */
-	for (row = 0; row < height; row++) {
+	/* Write a row at a time, blending the glyph with the background */
+	for (row = 0; row < glyph->height; row++) {
 		switch (vid_priv->bpix) {
 #ifdef CONFIG_VIDEO_BPP16
 		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
+			u16 *dst = (u16 *)line + glyph->xoff;
+			u16 *src = (u16 *)glyph->pixels + row * glyph->width;
 			int i;
 
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val >> 3 |
-					(val >> 2) << 5 |
-					(val >> 3) << 11;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
+			if (vid_priv->colour_fg) {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ |= *src++;
+			} else {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ &= *src++;
 			}
-			end = dst;
 			break;
 		}
 #endif
 #ifdef CONFIG_VIDEO_BPP32
 		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
+			u32 *dst = (u32 *)line + glyph->xoff;
+			u32 *src = (u32 *)glyph->pixels + row * glyph->width;
 			int i;
 
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val | val << 8 | val << 16;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
+			if (vid_priv->colour_fg) {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ |= *src++;
+			} else {
+				for (i = 0; i < glyph->width; i++)
+					*dst++ &= *src++;
 			}
-			end = dst;
 			break;
 		}
 #endif
 		default:
-			free(data);
 			return -ENOSYS;
 		}
 
@@ -332,7 +446,8 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
-	free(data);
+	video_damage(vid, VID_TO_PIXEL(x) + glyph->xoff, y + max(linenum, 0),
+		     glyph->width, glyph->height);
 
 	return width_frac;
 }
@@ -399,6 +514,7 @@ static int console_truetype_erase(struct udevice *dev, int xstart, int ystart,
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
+	video_damage(dev->parent, xstart, ystart, xend - xstart, yend - ystart);
 
 	return 0;
 }
@@ -541,7 +657,7 @@ static int console_truetype_probe(struct udevice *dev)
 	struct udevice *vid_dev = dev->parent;
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid_dev);
 	stbtt_fontinfo *font = &priv->font;
-	int ascent;
+	int ascent, i;
 
 	debug("%s: start\n", __func__);
 	if (vid_priv->font_size)
@@ -570,11 +686,33 @@ static int console_truetype_probe(struct udevice *dev)
 	priv->scale = stbtt_ScaleForPixelHeight(font, priv->font_size);
 	stbtt_GetFontVMetrics(font, &ascent, 0, 0);
 	priv->baseline = (int)(ascent * priv->scale);
+
+	priv->glyph = calloc(CONFIG_CONSOLE_TRUETYPE_GLYPHS,
+			     sizeof(struct tt_glyph));
+	if (!priv->glyph)
+		return -ENOMEM;
+	INIT_LIST_HEAD(&priv->glyphs);
+	for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_GLYPHS; i++) {
+		priv->glyph[i].ch = TT_NO_CHAR;
+		list_add_tail(&priv->glyph[i].sibling, &priv->glyphs);
+	}
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_GLYPHS; i++)
+		free(priv->glyph[i].pixels);
+	free(priv->glyph);
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -588,5 +726,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto_alloc_size	= sizeof(struct console_tt_priv),
 };
@@ -6,11 +6,14 @@
  * Based on drivers/gpu/drm/tiny/ili9488.c from the Linux repo
  */
 
+#include <asm/cache.h>
 #include <asm/gpio.h>
 #include <backlight.h>
 #include <common.h>
 #include <dm.h>
 #include <dm/device_compat.h>
+#include <dm/device-internal.h>
+#include <dma.h>
 #include <fdtdec.h>
 #include <fdt_support.h>
 #include <mipi_display.h>
@@ -21,6 +24,7 @@
 #include <linux/delay.h>
 #include <linux/io.h>
 #include <linux/ioport.h>
+#include <malloc.h>
 
 
 #define MIPI_DBI_B_BASE (volatile void __iomem *)0x43C10000
@@ -40,6 +44,8 @@
 #define ILI9488_DPI_16_BPP                      0x5
 #define ILI9488_DBI_16_BPP                      0x5
 
+#define ILI9488_DMA_TIMEOUT_MS                  100
+
 
 struct clip_rect {
 	int x1, x2, y1, y2;
@@ -47,7 +53,11 @@ struct clip_rect {
 
 struct ili9488_priv {
 	void __iomem *mmio_base;
+	phys_addr_t data_reg;
 	struct udevice *backlight;
+	struct udevice *dma;	/* DMA controller, if updates use one */
+	void *dma_buf;		/* Window being sent by DMA */
+	bool dma_busy;		/* CS is held while DMA sends the window */
 };
 
 static void mipi_dbi_type_b_hw_reset(struct ili9488_priv *priv)
@@ -99,23 +109,135 @@ static int mipi_dbi_command_buf(struct ili9488_priv *priv, u8 cmd, u8 *data, siz
 	mipi_dbi_command_buf(priv, cmd, d, ARRAY_SIZE(d)); \
 })
 
-static int ili9488_video_sync(struct udevice *dev)
+/* Write a window of the frame buffer to the panel's memory, row by row */
+static int mipi_dbi_type_b_write_memory(struct ili9488_priv *priv,
+					const void *fb, int line_length,
+					size_t row_len, int rows)
+{
+	const u32 *pix;
+	int i;
+
+	/* Assert CS */
+	iowrite32(MIPI_DBI_B_CONTROL_CS, priv->mmio_base + MIPI_DBI_B_REG_CONTROL);
+	iowrite8(MIPI_DCS_WRITE_MEMORY_START,
+		 priv->mmio_base + MIPI_DBI_B_REG_COMMAND);
+	for (; rows; rows--) {
+		pix = fb;
+		for (i = 0; i < row_len / 4; i++)
+			iowrite32(pix[i], priv->mmio_base + MIPI_DBI_B_REG_DATA);
+		fb += line_length;
+	}
+	/* Deassert CS */
+	iowrite32(0, priv->mmio_base + MIPI_DBI_B_REG_CONTROL);
+	return 0;
+}
+
+/*
+ * Start sending a window of the frame buffer by DMA. The window is packed
+ * into a separate buffer first, so that drawing can go on while it is sent.
+ */
+static int ili9488_write_memory_dma(struct ili9488_priv *priv,
+				    const void *fb, int line_length,
+				    size_t row_len, int rows)
+{
+	void *buf = priv->dma_buf;
+	int ret, i;
+
+	for (i = 0; i < rows; i++) {
+		memcpy(buf, fb, row_len);
+		buf += row_len;
+		fb += line_length;
+	}
+
+	/* Assert CS; it is released by ili9488_dma_finish() */
+	iowrite32(MIPI_DBI_B_CONTROL_CS, priv->mmio_base + MIPI_DBI_B_REG_CONTROL);
+	iowrite8(MIPI_DCS_WRITE_MEMORY_START,
+		 priv->mmio_base + MIPI_DBI_B_REG_COMMAND);
+	ret = dma_transfer_async(priv->dma, DMA_MEM_TO_DEV,
+				 (void *)priv->data_reg, priv->dma_buf,
+				 row_len * rows);
+	if (ret) {
+		iowrite32(0, priv->mmio_base + MIPI_DBI_B_REG_CONTROL);
+		return ret;
+	}
+	priv->dma_busy = true;
+
+	return 0;
+}
+
+/* Wait for the last update sent by DMA, then release CS */
+static int ili9488_dma_finish(struct ili9488_priv *priv)
+{
+	int ret = 0;
+
+	if (!priv->dma_busy)
+		return 0;
+
+	/* Removing the controller before booting also waits for it */
+	if (device_active(priv->dma))
+		ret = dma_wait(priv->dma, ILI9488_DMA_TIMEOUT_MS);
+	/*
+	 * The transfer must not carry on into the FIFO behind the CPU writes
+	 * of the next update. If it cannot be stopped, keep CS held and stay
+	 * busy so that no further update is sent.
+	 */
+	if (ret == -ETIMEDOUT) {
+		int err = dma_stop(priv->dma);
+
+		if (err) {
+			log_err("Cannot stop display DMA (err=%d)\n", err);
+			return err;
+		}
+	}
+	/* Deassert CS */
+	iowrite32(0, priv->mmio_base + MIPI_DBI_B_REG_CONTROL);
+	priv->dma_busy = false;
+
+	return ret;
+}
+
+static int ili9488_sync_rect(struct udevice *dev, const struct video_rect *rect)
 {
 	struct video_priv *uc_priv = dev_get_uclass_priv(dev);
 	struct ili9488_priv *priv = dev_get_priv(dev);
-	/* For now, we always update the entire screen. If U-boot supports
-	 * partial framebuffer updates in the future, we can easily support
-	 * that as well. */
-	struct clip_rect clip = {0, uc_priv->xsize, 0, uc_priv->ysize};
+	/* The data register takes two pixels at a time, so the window must
+	 * start and end on an even column. */
+	struct clip_rect clip = {
+		rect->xstart & ~1, min(ALIGN(rect->xend, 2), (int)uc_priv->xsize),
+		rect->ystart, rect->yend
+	};
+	int x_end = clip.x2 - 1;
+	int y_end = clip.y2 - 1;
+	const void *fb = uc_priv->fb + clip.y1 * uc_priv->line_length +
+			 clip.x1 * sizeof(u16);
+	size_t row_len = (clip.x2 - clip.x1) * sizeof(u16);
+	int ret;
+
+	ret = ili9488_dma_finish(priv);
+	if (ret)
+		return ret;
+
 	mipi_dbi_command(priv, MIPI_DCS_SET_COLUMN_ADDRESS,
 	                 (clip.x1 >> 8) & 0xFF, clip.x1 & 0xFF,
-	                 (clip.x2 >> 8) & 0xFF, (clip.x2 - 1) & 0xFF);
+	                 (x_end >> 8) & 0xFF, x_end & 0xFF);
 	mipi_dbi_command(priv, MIPI_DCS_SET_PAGE_ADDRESS,
 	                 (clip.y1 >> 8) & 0xFF, clip.y1 & 0xFF,
-	                 (clip.y2 >> 8) & 0xFF, (clip.y2 - 1) & 0xFF);
-	mipi_dbi_command_buf(priv, MIPI_DCS_WRITE_MEMORY_START, uc_priv->fb,
-	                 (clip.x2 - clip.x1) * (clip.y2 - clip.y1) * sizeof(u16));
-	return 0;
+	                 (y_end >> 8) & 0xFF, y_end & 0xFF);
+	if (priv->dma && !ili9488_write_memory_dma(priv, fb,
+						   uc_priv->line_length,
+						   row_len, clip.y2 - clip.y1))
+		return 0;
+
+	return mipi_dbi_type_b_write_memory(priv, fb, uc_priv->line_length,
+					    row_len, clip.y2 - clip.y1);
+}
+
+static int ili9488_video_sync(struct udevice *dev)
+{
+	struct video_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct video_rect rect = {0, 0, uc_priv->xsize, uc_priv->ysize};
+
+	return ili9488_sync_rect(dev, &rect);
 }
 
 static int ili9488_init(struct ili9488_priv *priv)
@@ -185,6 +307,7 @@ static int ili9488_probe(struct udevice *dev)
         dev_err(dev, "Could not read resource: %d\n", ret);
         return ret;
     }
+	priv->data_reg = res.start + MIPI_DBI_B_REG_DATA;
 	priv->mmio_base = devm_ioremap(dev, res.start, resource_size(&res));
 	if (IS_ERR(priv->mmio_base)) {
         dev_err(dev, "Could not remap IO: %d\n", ret);
@@ -197,6 +320,16 @@ static int ili9488_probe(struct udevice *dev)
 	uc_priv->rot = 0;
 	uc_priv->bpix = VIDEO_BPP16;
 
+	if (IS_ENABLED(CONFIG_VIDEO_LCD_ILI9488_DMA) &&
+	    !dma_get_device(DMA_SUPPORTS_MEM_TO_DEV, &priv->dma)) {
+		priv->dma_buf = memalign(ARCH_DMA_MINALIGN, uc_priv->xsize *
+					 uc_priv->ysize * sizeof(u16));
+		if (!priv->dma_buf)
+			return -ENOMEM;
+	} else {
+		priv->dma = NULL;
+	}
+
 	/* init sequence */
 	ret = ili9488_init(priv);
 	if (ret) {
@@ -222,11 +355,19 @@ static int ili9488_probe(struct udevice *dev)
 
 static int ili9488_remove(struct udevice *dev)
 {
-	return 0;
+	struct ili9488_priv *priv = dev_get_priv(dev);
+	int ret;
+
+	/* Finish the last update before the OS takes over */
+	ret = ili9488_dma_finish(priv);
+	free(priv->dma_buf);
+
+	return ret;
 }
 
 static const struct video_ops ili9488_video_ops = {
 	.video_sync = ili9488_video_sync,
+	.sync_rect = ili9488_sync_rect,
 };
 
 static const struct udevice_id ili9488_ids[] = {
@@ -241,5 +382,6 @@ U_BOOT_DRIVER(ili9488) = {
 	.ops = &ili9488_video_ops,
 	.probe = ili9488_probe,
 	.remove = ili9488_remove,
+	.flags = DM_FLAG_OS_PREPARE,
 	.priv_auto_alloc_size = sizeof(struct ili9488_priv),
 };
@@ -142,6 +142,7 @@ int video_clear(struct udevice *dev)
 	ret = video_sync_copy(dev, priv->fb, priv->fb + priv->fb_size);
 	if (ret)
 		return ret;
+	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
 
 	return video_sync(dev, false);
 }
@@ -175,14 +176,24 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 /* Flush video activity to the caches */
 int video_sync(struct udevice *vid, bool force)
 {
+	struct video_priv *priv = dev_get_uclass_priv(vid);
 	struct video_ops *ops = video_get_ops(vid);
 	int ret;
 
-	if (ops && ops->video_sync) {
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE) && ops && ops->sync_rect) {
+		/* Only send what has changed, if anything */
+		if (priv->damage.xend > priv->damage.xstart) {
+			ret = ops->sync_rect(vid, &priv->damage);
+			if (ret)
+				return ret;
+		}
+	} else if (ops && ops->video_sync) {
 		ret = ops->video_sync(vid);
 		if (ret)
 			return ret;
 	}
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		memset(&priv->damage, '\0', sizeof(priv->damage));
 
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
@@ -190,15 +201,12 @@ int video_sync(struct udevice *vid, bool force)
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-
 	if (priv->flush_dcache) {
 		flush_dcache_range((ulong)priv->fb,
 				   ALIGN((ulong)priv->fb + priv->fb_size,
 					 CONFIG_SYS_CACHELINE_SIZE));
 	}
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
 	if (force || get_timer(last_sync) > 10) {
@@ -239,6 +247,33 @@ int video_get_ysize(struct udevice *dev)
 	return priv->ysize;
 }
 
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_rect *damage = &priv->damage;
+	int xend = min(x + width, (int)priv->xsize);
+	int yend = min(y + height, (int)priv->ysize);
+
+	x = max(x, 0);
+	y = max(y, 0);
+	if (xend <= x || yend <= y)
+		return;
+
+	if (damage->xend <= damage->xstart) {
+		damage->xstart = x;
+		damage->ystart = y;
+		damage->xend = xend;
+		damage->yend = yend;
+	} else {
+		damage->xstart = min(damage->xstart, x);
+		damage->ystart = min(damage->ystart, y);
+		damage->xend = max(damage->xend, xend);
+		damage->yend = max(damage->yend, yend);
+	}
+}
+#endif
+
 #ifdef CONFIG_VIDEO_COPY
 int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
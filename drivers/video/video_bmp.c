@@ -7,18 +7,21 @@
 #include <bmp_layout.h>
 #include <dm.h>
 #include <log.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <splash.h>
 #include <video.h>
 #include <watchdog.h>
 #include <asm/unaligned.h>
+#include <u-boot/crc.h>
 
-#ifdef CONFIG_VIDEO_BMP_RLE8
+/* Escape codes, shared by RLE8 and RLE4 */
 #define BMP_RLE8_ESCAPE		0
 #define BMP_RLE8_EOL		0
 #define BMP_RLE8_EOBMP		1
 #define BMP_RLE8_DELTA		2
 
+#ifdef CONFIG_VIDEO_BMP_RLE8
 static void draw_unencoded_bitmap(ushort **fbp, uchar *bmap, ushort *cmap,
 				  int cnt)
 {
@@ -127,18 +130,202 @@ static void video_display_rle8_bitmap(struct udevice *dev,
 }
 #endif
 
-__weak void fb_put_byte(uchar **fb, uchar **from)
+#ifdef CONFIG_VIDEO_BMP_RLE4
+static void video_display_rle4_bitmap(struct udevice *dev,
+				      struct bmp_image *bmp, ushort *cmap,
+				      int x_off, int y_off, int width,
+				      int height)
 {
-	*(*fb)++ = *(*from)++;
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	ushort *fb;
+	uchar *bmap;
+	int x, y, i, runlen, cnt;
+	bool encoded;
+
+	bmap = (uchar *)bmp + get_unaligned_le32(&bmp->header.data_offset);
+
+	/* Rows are stored bottom-up, and the bottom ones may be clipped */
+	x = 0;
+	y = get_unaligned_le32(&bmp->header.height) - 1;
+
+	for (;;) {
+		if (bmap[0] == BMP_RLE8_ESCAPE) {
+			switch (bmap[1]) {
+			case BMP_RLE8_EOL:
+				x = 0;
+				y--;
+				bmap += 2;
+				continue;
+			case BMP_RLE8_EOBMP:
+				return;
+			case BMP_RLE8_DELTA:
+				x += bmap[2];
+				y -= bmap[3];
+				bmap += 4;
+				continue;
+			}
+			/* unencoded run, one pixel per nibble */
+			runlen = bmap[1];
+			encoded = false;
+			bmap += 2;
+		} else {
+			/* encoded run, alternating the two nibbles of bmap[1] */
+			runlen = bmap[0];
+			encoded = true;
+			bmap++;
+		}
+
+		if (x < width && y >= 0 && y < height) {
+			cnt = min(runlen, width - x);
+			fb = (ushort *)(priv->fb + (y + y_off) *
+					priv->line_length) + x + x_off;
+			for (i = 0; i < cnt; i++) {
+				uchar pair = encoded ? *bmap : bmap[i / 2];
+
+				*fb++ = cmap[i & 1 ? pair & 0xf : pair >> 4];
+			}
+		}
+		x += runlen;
+
+		/* unencoded runs are padded to a 16-bit boundary */
+		bmap += encoded ? 1 : ALIGN(runlen, 4) / 2;
+	}
 }
+#endif
 
-#if defined(CONFIG_BMP_16BPP)
-__weak void fb_put_word(uchar **fb, uchar **from)
+#ifdef CONFIG_VIDEO_BMP_CACHE
+/**
+ * struct video_bmp_cache - The last image drawn, in framebuffer format
+ *
+ * Converting an image from the BMP format can take much longer than copying
+ * it, so the result is kept. It is found again by the address of the BMP
+ * and a hash of its contents, so an image which is changed in place, e.g.
+ * by loading another file there, is converted again.
+ *
+ * @addr: Address of the BMP image
+ * @crc: CRC32 of the BMP image, header and palette included
+ * @bpix: Framebuffer depth the image was converted to (enum video_log2_bpp)
+ * @width: Width of the image drawn, in pixels, after clipping
+ * @height: Height of the image drawn, in pixels, after clipping
+ * @pixels: The pixels drawn, top row first, with no padding between rows
+ *
+ * RLE images are not cached, since the pixels they skip over show the
+ * framebuffer as it is when they are drawn.
+ */
+static struct video_bmp_cache {
+	ulong addr;
+	u32 crc;
+	int bpix;
+	ulong width;
+	ulong height;
+	void *pixels;
+} bmp_cache;
+
+/*
+ * Get the CRC32 of an image, 0 if it is not to be cached. The size to hash
+ * comes from the header, so it must fit what the other fields allow.
+ */
+static int video_bmp_hash(struct bmp_image *bmp, u32 *crcp)
 {
-	*(*fb)++ = *(*from)++;
-	*(*fb)++ = *(*from)++;
+	u32 compression = get_unaligned_le32(&bmp->header.compression);
+	ulong size = get_unaligned_le32(&bmp->header.file_size);
+	ulong offset = get_unaligned_le32(&bmp->header.data_offset);
+	u64 width = get_unaligned_le32(&bmp->header.width);
+	u64 height = get_unaligned_le32(&bmp->header.height);
+	uint bpp = get_unaligned_le16(&bmp->header.bit_count);
+	u64 max_offset, max_size;
+
+	*crcp = 0;
+	if (compression == BMP_BI_RLE8 || compression == BMP_BI_RLE4)
+		return 0;
+
+	/* Headers, colour masks, a palette of up to 256 colours, then rows */
+	max_offset = 14 + get_unaligned_le16(&bmp->header.size) + 12 + 4 * 256;
+	max_size = max_offset + ALIGN(width * bpp, 32) / 8 * height;
+	if (offset > max_offset || size > max_size) {
+		printf("Error: BMP file size %lu does not match the image\n",
+		       size);
+		return -EINVAL;
+	}
+	if (size >= offset)
+		*crcp = crc32(0, (uchar *)bmp, size);
+
+	return 0;
 }
-#endif /* CONFIG_BMP_16BPP */
+
+/* Copy the image from the cache if it is there, returning true if so */
+static bool video_bmp_cache_draw(struct video_priv *priv, ulong addr, u32 crc,
+				 uchar *fb, ulong width, ulong height)
+{
+	ulong byte_width = width * VNBYTES(priv->bpix);
+	uchar *pixels = bmp_cache.pixels;
+	int i;
+
+	if (!pixels || !crc || bmp_cache.addr != addr ||
+	    bmp_cache.crc != crc || bmp_cache.bpix != priv->bpix ||
+	    bmp_cache.width != width || bmp_cache.height != height)
+		return false;
+
+	for (i = 0; i < height; i++) {
+		memcpy(fb, pixels, byte_width);
+		pixels += byte_width;
+		fb += priv->line_length;
+	}
+
+	return true;
+}
+
+/* Copy the image just drawn at @fb into the cache, replacing the last one */
+static void video_bmp_cache_store(struct video_priv *priv, ulong addr, u32 crc,
+				  uchar *fb, ulong width, ulong height)
+{
+	ulong byte_width = width * VNBYTES(priv->bpix);
+	uchar *pixels;
+	int i;
+
+	free(bmp_cache.pixels);
+	bmp_cache.pixels = NULL;
+	if (!crc || priv->bpix < VIDEO_BPP8 || !byte_width || !height)
+		return;
+
+	/* The cache is only an optimisation, so carry on without it */
+	pixels = malloc(byte_width * height);
+	if (!pixels)
+		return;
+
+	bmp_cache.addr = addr;
+	bmp_cache.crc = crc;
+	bmp_cache.bpix = priv->bpix;
+	bmp_cache.width = width;
+	bmp_cache.height = height;
+	bmp_cache.pixels = pixels;
+	for (i = 0; i < height; i++) {
+		memcpy(pixels, fb, byte_width);
+		pixels += byte_width;
+		fb += priv->line_length;
+	}
+}
+#else
+static inline int video_bmp_hash(struct bmp_image *bmp, u32 *crcp)
+{
+	*crcp = 0;
+
+	return 0;
+}
+
+static inline bool video_bmp_cache_draw(struct video_priv *priv, ulong addr,
+					u32 crc, uchar *fb, ulong width,
+					ulong height)
+{
+	return false;
+}
+
+static inline void video_bmp_cache_store(struct video_priv *priv, ulong addr,
+					 u32 crc, uchar *fb, ulong width,
+					 ulong height)
+{
+}
+#endif
 
 /**
  * video_splash_align_axis() - Align a single coordinate
@@ -192,15 +379,16 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 	ushort *cmap_base = NULL;
 	int i, j;
-	uchar *start, *fb;
+	uchar *start, *fb, *top;
 	struct bmp_image *bmp = map_sysmem(bmp_image, 0);
 	uchar *bmap;
 	ushort padded_width;
-	unsigned long width, height, byte_width;
+	unsigned long width, height, byte_width, row_bytes;
 	unsigned long pwidth = priv->xsize;
 	unsigned colours, bpix, bmp_bpix;
 	struct bmp_color_table_entry *palette;
 	int hdr_size;
+	u32 crc;
 	int ret;
 
 	if (!bmp || !(bmp->header.signature[0] == 'B' &&
@@ -229,10 +417,14 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	}
 
 	/*
-	 * We support displaying 8bpp and 24bpp BMPs on 16bpp LCDs
-	 * and displaying 24bpp BMPs on 32bpp LCDs
+	 * We support displaying 4bpp, 8bpp and 24bpp BMPs on 16bpp LCDs
+	 * and displaying 4bpp, 8bpp and 24bpp BMPs on 32bpp LCDs
 	 */
 	if (bpix != bmp_bpix &&
+	    !(bmp_bpix == 4 && bpix == 8) &&
+	    !(bmp_bpix == 4 && bpix == 16) &&
+	    !(bmp_bpix == 4 && bpix == 24) &&
+	    !(bmp_bpix == 4 && bpix == 32) &&
 	    !(bmp_bpix == 8 && bpix == 16) &&
 	    !(bmp_bpix == 8 && bpix == 24) &&
 	    !(bmp_bpix == 8 && bpix == 32) &&
@@ -246,10 +438,15 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	debug("Display-bmp: %d x %d  with %d colours, display %d\n",
 	      (int)width, (int)height, (int)colours, 1 << bpix);
 
-	if (bmp_bpix == 8)
+	if (bmp_bpix == 4 || bmp_bpix == 8)
 		video_set_cmap(dev, palette, colours);
 
 	padded_width = (width & 0x3 ? (width & ~0x3) + 4 : width);
+	/* Rows of a 4bpp image are padded to 8 pixels, i.e. 32 bits */
+	if (bmp_bpix == 4)
+		row_bytes = ALIGN(width, 8) / 2;
+	else
+		row_bytes = padded_width;
 
 	if (align) {
 		video_splash_align_axis(&x, priv->xsize, width);
@@ -265,17 +462,29 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	start = (uchar *)(priv->fb +
 		(y + height) * priv->line_length + x * bpix / 8);
 
+	/* Find the position of the top left of the image in the framebuffer */
+	top = (uchar *)(priv->fb + y * priv->line_length + x * bpix / 8);
+
 	/* Move back to the final line to be drawn */
 	fb = start - priv->line_length;
 
+	ret = video_bmp_hash(bmp, &crc);
+	if (ret)
+		return ret;
+	if (video_bmp_cache_draw(priv, bmp_image, crc, top, width, height))
+		goto sync;
+
 	switch (bmp_bpix) {
 	case 1:
+	case 4:
 	case 8: {
 		struct bmp_color_table_entry *cte;
+		u32 compression = get_unaligned_le32(&bmp->header.compression);
+		uint idx;
+
 		cmap_base = priv->cmap;
+		debug("compressed %d\n", compression);
 #ifdef CONFIG_VIDEO_BMP_RLE8
-		u32 compression = get_unaligned_le32(&bmp->header.compression);
-		debug("compressed %d %d\n", compression, BMP_BI_RLE8);
 		if (compression == BMP_BI_RLE8) {
 			if (bpix != 16) {
 				/* TODO implement render code for bpix != 16 */
@@ -286,6 +495,17 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 						  y, width, height);
 			break;
 		}
+#endif
+#ifdef CONFIG_VIDEO_BMP_RLE4
+		if (compression == BMP_BI_RLE4) {
+			if (bpix != 16) {
+				printf("Error: only support 16 bpix");
+				return -EPROTONOSUPPORT;
+			}
+			video_display_rle4_bitmap(dev, bmp, cmap_base, x, y,
+						  width, height);
+			break;
+		}
 #endif
 		byte_width = width * (bpix / 8);
 		if (!byte_width)
@@ -293,17 +513,27 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 
 		for (i = 0; i < height; ++i) {
 			WATCHDOG_RESET();
+			if (bpix == bmp_bpix) {
+				/* Already in framebuffer format */
+				memcpy(fb, bmap, byte_width);
+				bmap += row_bytes;
+				fb -= priv->line_length;
+				continue;
+			}
 			for (j = 0; j < width; j++) {
+				if (bmp_bpix == 4)
+					idx = bmap[j / 2] >> (j & 1 ? 0 : 4) &
+						0xf;
+				else
+					idx = bmap[j];
 				if (bpix == 8) {
-					fb_put_byte(&fb, &bmap);
+					*fb++ = idx;
 				} else if (bpix == 16) {
-					*(uint16_t *)fb = cmap_base[*bmap];
-					bmap++;
+					*(uint16_t *)fb = cmap_base[idx];
 					fb += sizeof(uint16_t) / sizeof(*fb);
 				} else {
 					/* Only support big endian */
-					cte = &palette[*bmap];
-					bmap++;
+					cte = &palette[idx];
 					if (bpix == 24) {
 						*(fb++) = cte->red;
 						*(fb++) = cte->green;
@@ -316,20 +546,19 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 					}
 				}
 			}
-			bmap += (padded_width - width);
+			bmap += row_bytes;
 			fb -= byte_width + priv->line_length;
 		}
 		break;
 	}
 #if defined(CONFIG_BMP_16BPP)
 	case 16:
+		/* Rows are copied as they are, with no conversion */
 		for (i = 0; i < height; ++i) {
 			WATCHDOG_RESET();
-			for (j = 0; j < width; j++)
-				fb_put_word(&fb, &bmap);
-
-			bmap += (padded_width - width) * 2;
-			fb -= width * 2 + priv->line_length;
+			memcpy(fb, bmap, width * 2);
+			bmap += padded_width * 2;
+			fb -= priv->line_length;
 		}
 		break;
 #endif /* CONFIG_BMP_16BPP */
@@ -359,25 +588,23 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 #if defined(CONFIG_BMP_32BPP)
 	case 32:
 		for (i = 0; i < height; ++i) {
-			for (j = 0; j < width; j++) {
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-			}
-			fb -= priv->line_length + width * (bpix / 8);
+			WATCHDOG_RESET();
+			memcpy(fb, bmap, width * 4);
+			bmap += width * 4;
+			fb -= priv->line_length;
 		}
 		break;
 #endif /* CONFIG_BMP_32BPP */
 	default:
 		break;
 	};
+	video_bmp_cache_store(priv, bmp_image, crc, top, width, height);
 
-	/* Find the position of the top left of the image in the framebuffer */
-	fb = (uchar *)(priv->fb + y * priv->line_length + x * bpix / 8);
-	ret = video_sync_copy(dev, start, fb);
+sync:
+	ret = video_sync_copy(dev, start, top);
 	if (ret)
 		return log_ret(ret);
+	video_damage(dev, x, y, width, height);
 
 	return video_sync(dev, false);
 }
@@ -1528,11 +1528,12 @@ void ext4fs_allocate_blocks(struct ext2_inode *file_inode,
 static struct ext4_extent_header *ext4fs_get_extent_block
 	(struct ext2_data *data, struct ext_block_cache *cache,
 		struct ext4_extent_header *ext_block,
-		uint32_t fileblock, int log2_blksz)
+		uint32_t fileblock, int log2_blksz, int readahead)
 {
 	struct ext4_extent_idx *index;
-	unsigned long long block;
+	unsigned long long block, next;
 	int blksz = EXT2_BLOCK_SIZE(data);
+	int count;
 	int i;
 
 	while (1) {
@@ -1559,10 +1560,26 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 
 		block = le16_to_cpu(index[i].ei_leaf_hi);
 		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
+
+		/*
+		 * A sequential read visits the following entries next, so pull
+		 * in their blocks as well when they are adjacent on disk.
+		 */
+		for (count = 1; count < readahead &&
+		     i + count < le16_to_cpu(ext_block->eh_entries); count++) {
+			next = le16_to_cpu(index[i + count].ei_leaf_hi);
+			next = (next << 32) +
+				le32_to_cpu(index[i + count].ei_leaf_lo);
+			if (next != block + count)
+				break;
+		}
+
 		block <<= log2_blksz;
-		if (!ext_cache_read(cache, (lbaint_t)block, blksz))
+		ext_block = ext_cache_read(cache,
+					   le16_to_cpu(ext_block->eh_depth) - 1,
+					   (lbaint_t)block, blksz, count);
+		if (!ext_block)
 			return NULL;
-		ext_block = (struct ext4_extent_header *)cache->buf;
 	}
 }
 
@@ -1675,7 +1692,8 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock,
 			ext4fs_get_extent_block(ext4fs_root, c,
 						(struct ext4_extent_header *)
 						inode->b.blocks.dir_blocks,
-						fileblock, log2_blksz);
+						fileblock, log2_blksz,
+						cache ? EXT_CACHE_READAHEAD : 1);
 		if (!ext_block) {
 			printf("invalid extent block\n");
 			if (!cache)
@@ -1995,6 +2013,105 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock,
 	return blknr;
 }
 
+static long int ext4fs_map_extent(struct ext2_inode *inode, lbaint_t fileblock,
+				  lbaint_t maxblocks,
+				  struct ext_block_cache *cache,
+				  lbaint_t *blknr)
+{
+	struct ext4_extent_header *ext_block;
+	struct ext4_extent *extent;
+	lbaint_t startblock, endblock, count = 1;
+	unsigned long long start;
+	int log2_blksz;
+	int extlen, uninit;
+	int i;
+
+	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root)
+		- get_fs()->dev_desc->log2blksz;
+	ext_block = ext4fs_get_extent_block(ext4fs_root, cache,
+					    (struct ext4_extent_header *)
+					    inode->b.blocks.dir_blocks,
+					    fileblock, log2_blksz,
+					    EXT_CACHE_READAHEAD);
+	if (!ext_block) {
+		printf("invalid extent block\n");
+		return -EINVAL;
+	}
+
+	*blknr = 0;
+	extent = (struct ext4_extent *)(ext_block + 1);
+	for (i = 0; i < le16_to_cpu(ext_block->eh_entries); i++) {
+		extlen = le16_to_cpu(extent[i].ee_len);
+		uninit = extlen > EXT_INIT_MAX_LEN;
+		if (uninit)
+			extlen -= EXT_INIT_MAX_LEN;
+		startblock = le32_to_cpu(extent[i].ee_block);
+		endblock = startblock + extlen;
+
+		if (startblock > fileblock) {
+			/* Sparse file, the hole ends where this extent starts */
+			count = startblock - fileblock;
+			break;
+		} else if (fileblock < endblock) {
+			count = endblock - fileblock;
+			if (uninit)
+				break;
+			start = le16_to_cpu(extent[i].ee_start_hi);
+			start = (start << 32) +
+				le32_to_cpu(extent[i].ee_start_lo);
+			*blknr = (fileblock - startblock) + start;
+			break;
+		}
+	}
+
+	/*
+	 * Past the last extent of this leaf the hole may end anywhere in the
+	 * next leaf, so only a single block is reported in that case.
+	 */
+	return min(count, maxblocks);
+}
+
+/**
+ * ext4fs_map_blocks() - map a run of file blocks to disk blocks
+ *
+ * Looks up where @fileblock is stored and how many of the following blocks
+ * are stored right behind it, so that the whole run can be read at once.
+ * Extent based files are mapped an extent at a time, other files are probed
+ * block by block.
+ *
+ * @inode:	inode of the file
+ * @fileblock:	first logical block of the run
+ * @maxblocks:	maximum length of the run in blocks
+ * @cache:	cache for extent tree blocks, must be initialised
+ * @blknr:	returns the first filesystem block of the run, 0 if the run
+ *		is a hole which reads as zeros
+ * Return:	length of the run in blocks (at least 1), negative on error
+ */
+long int ext4fs_map_blocks(struct ext2_inode *inode, lbaint_t fileblock,
+			   lbaint_t maxblocks, struct ext_block_cache *cache,
+			   lbaint_t *blknr)
+{
+	long int first, next;
+	lbaint_t count;
+
+	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL)
+		return ext4fs_map_extent(inode, fileblock, maxblocks, cache,
+					 blknr);
+
+	first = read_allocated_block(inode, fileblock, cache);
+	if (first < 0)
+		return first;
+
+	for (count = 1; count < maxblocks; count++) {
+		next = read_allocated_block(inode, fileblock + count, cache);
+		if (next < 0 || next != (first ? first + count : 0))
+			break;
+	}
+	*blknr = first;
+
+	return count;
+}
+
 /**
  * ext4fs_reinit_global() - Reinitialize values of ext4 write implementation's
  *			    global pointers
@@ -2341,7 +2458,11 @@ int ext4fs_open(const char *filename, loff_t *len)
 	if (ext4fs_root == NULL)
 		return -1;
 
-	ext4fs_file = NULL;
+	/* Drop the node of a previously opened file */
+	if (ext4fs_file != NULL) {
+		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
+		ext4fs_file = NULL;
+	}
 	status = ext4fs_find_file(filename, &ext4fs_root->diropen, &fdiro,
 				  FILETYPE_REG);
 	if (status == 0)
@@ -45,144 +45,76 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot)
 }
 
 /*
- * Taken from openmoko-kernel mailing list: By Andy green
- * Optimized read file API : collects and defers contiguous sector
- * reads into one potentially more efficient larger sequential read action
+ * Read a file an extent at a time: every physically contiguous run of blocks
+ * is fetched with a single device read, holes are filled with zeros.
  */
-int ext4fs_read_file(struct ext2fs_node *node, loff_t pos,
-		loff_t len, char *buf, loff_t *actread)
+static int ext4fs_read_file_cached(struct ext2fs_node *node, loff_t pos,
+				   loff_t len, char *buf, loff_t *actread,
+				   struct ext_block_cache *cache)
 {
 	struct ext_filesystem *fs = get_fs();
-	int i;
-	lbaint_t blockcnt;
 	int log2blksz = fs->dev_desc->log2blksz;
 	int log2_fs_blocksize = LOG2_BLOCK_SIZE(node->data) - log2blksz;
 	int blocksize = (1 << (log2_fs_blocksize + log2blksz));
 	unsigned int filesize = le32_to_cpu(node->inode.size);
-	lbaint_t previous_block_number = -1;
-	lbaint_t delayed_start = 0;
-	lbaint_t delayed_extent = 0;
-	lbaint_t delayed_skipfirst = 0;
-	lbaint_t delayed_next = 0;
-	char *delayed_buf = NULL;
-	char *start_buf = buf;
-	short status;
-	struct ext_block_cache cache;
-
-	ext_cache_init(&cache);
+	lbaint_t fileblock, lastblock, blknr;
+	long int count;
+	loff_t end;
+	int skipfirst;
+	int n;
 
 	/* Adjust len so it we can't read past the end of the file. */
 	if (len + pos > filesize)
 		len = (filesize - pos);
 
-	if (blocksize <= 0 || len <= 0) {
-		ext_cache_fini(&cache);
+	if (blocksize <= 0 || len <= 0)
 		return -1;
-	}
-
-	blockcnt = lldiv(((len + pos) + blocksize - 1), blocksize);
 
-	for (i = lldiv(pos, blocksize); i < blockcnt; i++) {
-		long int blknr;
-		int blockoff = pos - (blocksize * i);
-		int blockend = blocksize;
-		int skipfirst = 0;
-		blknr = read_allocated_block(&node->inode, i, &cache);
-		if (blknr < 0) {
-			ext_cache_fini(&cache);
-			return -1;
-		}
+	end = pos + len;
+	lastblock = lldiv(end + blocksize - 1, blocksize);
 
-		blknr = blknr << log2_fs_blocksize;
+	while (pos < end) {
+		fileblock = lldiv(pos, blocksize);
+		skipfirst = pos - ((loff_t)fileblock << (log2_fs_blocksize +
+							  log2blksz));
 
-		/* Last block.  */
-		if (i == blockcnt - 1) {
-			blockend = (len + pos) - (blocksize * i);
-
-			/* The last portion is exactly blocksize. */
-			if (!blockend)
-				blockend = blocksize;
-		}
+		count = ext4fs_map_blocks(&node->inode, fileblock,
+					  min(lastblock - fileblock,
+					      (lbaint_t)(EXT4_MAX_READ_RUN /
+							 blocksize)),
+					  cache, &blknr);
+		if (count <= 0)
+			return -1;
 
-		/* First block. */
-		if (i == lldiv(pos, blocksize)) {
-			skipfirst = blockoff;
-			blockend -= skipfirst;
-		}
+		n = min((loff_t)count * blocksize - skipfirst, end - pos);
 		if (blknr) {
-			int status;
-
-			if (previous_block_number != -1) {
-				if (delayed_next == blknr) {
-					delayed_extent += blockend;
-					delayed_next += blockend >> log2blksz;
-				} else {	/* spill */
-					status = ext4fs_devread(delayed_start,
-							delayed_skipfirst,
-							delayed_extent,
-							delayed_buf);
-					if (status == 0) {
-						ext_cache_fini(&cache);
-						return -1;
-					}
-					previous_block_number = blknr;
-					delayed_start = blknr;
-					delayed_extent = blockend;
-					delayed_skipfirst = skipfirst;
-					delayed_buf = buf;
-					delayed_next = blknr +
-						(blockend >> log2blksz);
-				}
-			} else {
-				previous_block_number = blknr;
-				delayed_start = blknr;
-				delayed_extent = blockend;
-				delayed_skipfirst = skipfirst;
-				delayed_buf = buf;
-				delayed_next = blknr +
-					(blockend >> log2blksz);
-			}
+			if (!ext4fs_devread(blknr << log2_fs_blocksize,
+					    skipfirst, n, buf))
+				return -1;
 		} else {
-			int n;
-			int n_left;
-			if (previous_block_number != -1) {
-				/* spill */
-				status = ext4fs_devread(delayed_start,
-							delayed_skipfirst,
-							delayed_extent,
-							delayed_buf);
-				if (status == 0) {
-					ext_cache_fini(&cache);
-					return -1;
-				}
-				previous_block_number = -1;
-			}
-			/* Zero no more than `len' bytes. */
-			n = blocksize - skipfirst;
-			n_left = len - ( buf - start_buf );
-			if (n > n_left)
-				n = n_left;
 			memset(buf, 0, n);
 		}
-		buf += blocksize - skipfirst;
-	}
-	if (previous_block_number != -1) {
-		/* spill */
-		status = ext4fs_devread(delayed_start,
-					delayed_skipfirst, delayed_extent,
-					delayed_buf);
-		if (status == 0) {
-			ext_cache_fini(&cache);
-			return -1;
-		}
-		previous_block_number = -1;
+		buf += n;
+		pos += n;
 	}
 
 	*actread  = len;
-	ext_cache_fini(&cache);
 	return 0;
 }
 
+int ext4fs_read_file(struct ext2fs_node *node, loff_t pos,
+		loff_t len, char *buf, loff_t *actread)
+{
+	struct ext_block_cache cache;
+	int ret;
+
+	ext_cache_init(&cache);
+	ret = ext4fs_read_file_cached(node, pos, len, buf, actread, &cache);
+	ext_cache_fini(&cache);
+
+	return ret;
+}
+
 int ext4fs_ls(const char *dirname)
 {
 	struct ext2fs_node *dirnode = NULL;
@@ -259,6 +191,72 @@ int ext4_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	return ext4fs_read(buf, offset, len, len_read);
 }
 
+/* State of a file opened with ext4fs_open_file() */
+struct ext4fs_open_file {
+	struct ext2fs_node *node;
+	/* Last extent or indirect block looked up for this file */
+	struct ext_block_cache cache;
+};
+
+int ext4fs_open_file(const char *filename, loff_t *size, void **privp)
+{
+	struct ext4fs_open_file *file;
+	struct ext2fs_node *node = NULL;
+
+	if (ext4fs_root == NULL)
+		return -ENODEV;
+
+	if (ext4fs_find_file(filename, &ext4fs_root->diropen, &node,
+			     FILETYPE_REG) != 1)
+		goto fail;
+
+	if (!node->inode_read &&
+	    !ext4fs_read_inode(node->data, node->ino, &node->inode))
+		goto fail;
+
+	file = malloc(sizeof(*file));
+	if (!file) {
+		ext4fs_free_node(node, &ext4fs_root->diropen);
+		return -ENOMEM;
+	}
+	file->node = node;
+	ext_cache_init(&file->cache);
+
+	*size = le32_to_cpu(node->inode.size);
+	*privp = file;
+
+	return 0;
+fail:
+	if (node)
+		ext4fs_free_node(node, &ext4fs_root->diropen);
+	printf("** File not found %s **\n", filename);
+
+	return -ENOENT;
+}
+
+int ext4fs_pread(void *priv, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread)
+{
+	struct ext4fs_open_file *file = priv;
+
+	*actread = 0;
+	if (!len)
+		return 0;
+
+	return ext4fs_read_file_cached(file->node, offset, len, buf, actread,
+				       &file->cache);
+}
+
+void ext4fs_close_file(void *priv)
+{
+	struct ext4fs_open_file *file = priv;
+
+	/* The filesystem may already be closed, only release memory */
+	ext_cache_fini(&file->cache);
+	free(file->node);
+	free(file);
+}
+
 int ext4fs_uuid(char *uuid_str)
 {
 	if (ext4fs_root == NULL)
@@ -281,24 +279,48 @@ void ext_cache_init(struct ext_block_cache *cache)
 
 void ext_cache_fini(struct ext_block_cache *cache)
 {
-	free(cache->buf);
+	int i;
+
+	for (i = 0; i < EXT_CACHE_LEVELS; i++)
+		free(cache->level[i].buf);
 	ext_cache_init(cache);
 }
 
-int ext_cache_read(struct ext_block_cache *cache, lbaint_t block, int size)
+/**
+ * ext_cache_read() - read a block through the extent block cache
+ *
+ * On a miss, @count blocks of @size bytes starting at @block are read with a
+ * single device read, so that following lookups of neighbouring blocks are
+ * served from the cache. Only the blocks cached for @depth are replaced.
+ *
+ * @cache:	cache to use
+ * @depth:	depth of the block in the extent tree, 0 for a leaf
+ * @block:	first sector of the block to read
+ * @size:	size of the block in bytes
+ * @count:	number of contiguous blocks to read on a miss
+ * Return:	pointer to the data of @block or NULL on error
+ */
+void *ext_cache_read(struct ext_block_cache *cache, int depth, lbaint_t block,
+		     int size, int count)
 {
-	/* This could be more lenient, but this is simple and enough for now */
-	if (cache->buf && cache->block == block && cache->size == size)
-		return 1;
-	ext_cache_fini(cache);
-	cache->buf = memalign(ARCH_DMA_MINALIGN, size);
-	if (!cache->buf)
-		return 0;
-	if (!ext4fs_devread(block, 0, size, cache->buf)) {
-		ext_cache_fini(cache);
-		return 0;
+	int log2blksz = get_fs()->dev_desc->log2blksz;
+	struct ext_cache_level *lvl;
+
+	lvl = &cache->level[min(depth, EXT_CACHE_LEVELS - 1)];
+	if (lvl->buf && block >= lvl->block &&
+	    ((block - lvl->block) << log2blksz) + size <= lvl->size)
+		return lvl->buf + ((block - lvl->block) << log2blksz);
+	free(lvl->buf);
+	lvl->size = 0;
+	lvl->buf = memalign(ARCH_DMA_MINALIGN, size * count);
+	if (!lvl->buf)
+		return NULL;
+	if (!ext4fs_devread(block, 0, size * count, lvl->buf)) {
+		free(lvl->buf);
+		lvl->buf = NULL;
+		return NULL;
 	}
-	cache->block = block;
-	cache->size = size;
-	return 1;
+	lvl->block = block;
+	lvl->size = size * count;
+	return lvl->buf;
 }
@@ -11,6 +11,7 @@
 #include <common.h>
 #include <blk.h>
 #include <config.h>
+#include <div64.h>
 #include <exports.h>
 #include <fat.h>
 #include <fs.h>
@@ -1250,6 +1251,251 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	return ret;
 }
 
+/* A run of physically contiguous clusters of a file */
+struct fat_run {
+	loff_t offset;		/* file offset of the first cluster */
+	__u32 clust;		/* first cluster of the run */
+	__u32 count;		/* number of clusters in the run */
+};
+
+/* State of a file opened with fat_open_file() */
+typedef struct {
+	fsdata fsdata;
+	dir_entry dent;
+	struct fat_run *runs;	/* cluster chain mapped so far */
+	int nruns;
+	int maxruns;
+	__u32 next;		/* cluster following the last run, 0 at the end */
+} fat_file;
+
+/**
+ * fat_map_runs() - extend the cluster run list of a file
+ *
+ * The cluster chain is walked at most once per open file and recorded as a
+ * list of runs of contiguous clusters, so reads at any offset that has been
+ * mapped before need no FAT lookups and each run is read in one go.
+ *
+ * @file:	open file
+ * @end:	file offset up to which the chain must be mapped
+ * Return:	0 on success, -1 on error
+ */
+static int fat_map_runs(fat_file *file, loff_t end)
+{
+	fsdata *mydata = &file->fsdata;
+	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
+	struct fat_run *run = NULL;
+	loff_t mapped = 0;
+	__u32 clust = file->next;
+
+	if (file->nruns) {
+		run = &file->runs[file->nruns - 1];
+		mapped = run->offset + (loff_t)run->count * bytesperclust;
+	}
+
+	while (mapped < end && clust) {
+		if (!run || run->clust + run->count != clust) {
+			if (file->nruns == file->maxruns) {
+				int maxruns = max(16, file->maxruns * 2);
+				struct fat_run *runs;
+
+				runs = realloc(file->runs,
+					       maxruns * sizeof(*runs));
+				if (!runs) {
+					debug("Error: allocating run list\n");
+					return -1;
+				}
+				file->runs = runs;
+				file->maxruns = maxruns;
+			}
+			run = &file->runs[file->nruns++];
+			run->offset = mapped;
+			run->clust = clust;
+			run->count = 0;
+		}
+		run->count++;
+		mapped += bytesperclust;
+
+		clust = get_fatent(mydata, clust);
+		if (CHECK_CLUST(clust, mydata->fatsize))
+			clust = 0;
+	}
+	file->next = clust;
+
+	if (mapped < end) {
+		printf("Invalid FAT entry\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+int fat_open_file(const char *filename, loff_t *size, void **privp)
+{
+	fsdata *mydata;
+	fat_file *file;
+	fat_itr *itr;
+	int ret;
+
+	file = calloc(1, sizeof(*file));
+	itr = malloc_cache_aligned(sizeof(fat_itr));
+	if (!file || !itr) {
+		ret = -ENOMEM;
+		goto out_free_itr;
+	}
+
+	ret = fat_itr_root(itr, &file->fsdata);
+	if (ret)
+		goto out_free_itr;
+
+	ret = fat_itr_resolve(itr, filename, TYPE_FILE);
+	if (ret) {
+		printf("** Unable to read file %s **\n", filename);
+		free(file->fsdata.fatbuf);
+		goto out_free_itr;
+	}
+
+	mydata = &file->fsdata;
+	file->dent = *itr->dent;
+	file->next = START(&file->dent);
+	free(itr);
+
+	*size = FAT2CPU32(file->dent.size);
+	*privp = file;
+
+	return 0;
+
+out_free_itr:
+	free(itr);
+	free(file);
+	return ret;
+}
+
+/* Find the last run starting at or before offset, which must be mapped */
+static struct fat_run *fat_find_run(fat_file *file, loff_t offset)
+{
+	int lo, hi, mid;
+
+	lo = 0;
+	hi = file->nruns - 1;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (file->runs[mid].offset <= offset)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	return &file->runs[lo];
+}
+
+int fat_pread(void *priv, void *buf, loff_t offset, loff_t len,
+	      loff_t *actread)
+{
+	fat_file *file = priv;
+	fsdata *mydata = &file->fsdata;
+	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
+	loff_t filesize = FAT2CPU32(file->dent.size);
+	__u8 *buffer = buf;
+	struct fat_run *run;
+	loff_t runend, pos, n;
+	__u32 clust;
+
+	*actread = 0;
+	if (!len || offset >= filesize)
+		return 0;
+	if (len > filesize - offset)
+		len = filesize - offset;
+
+	if (fat_map_runs(file, offset + len))
+		return -1;
+
+	run = fat_find_run(file, offset);
+
+	while (len) {
+		runend = run->offset + (loff_t)run->count * bytesperclust;
+		if (offset >= runend) {
+			run++;
+			continue;
+		}
+
+		/* cluster holding offset and position within that cluster */
+		pos = offset - run->offset;
+		clust = run->clust + lldiv(pos, bytesperclust);
+		pos -= (loff_t)(clust - run->clust) * bytesperclust;
+
+		if (pos) {
+			__u8 *tmp_buffer;
+
+			n = min(len, (loff_t)bytesperclust - pos);
+			tmp_buffer = malloc_cache_aligned(bytesperclust);
+			if (!tmp_buffer) {
+				debug("Error: allocating buffer\n");
+				return -1;
+			}
+
+			if (get_cluster(mydata, clust, tmp_buffer,
+					pos + n) != 0) {
+				printf("Error reading cluster\n");
+				free(tmp_buffer);
+				return -1;
+			}
+			memcpy(buffer, tmp_buffer + pos, n);
+			free(tmp_buffer);
+		} else {
+			n = min(len, runend - offset);
+			if (get_cluster(mydata, clust, buffer, n) != 0) {
+				printf("Error reading cluster\n");
+				return -1;
+			}
+		}
+
+		buffer += n;
+		offset += n;
+		len -= n;
+		*actread += n;
+	}
+
+	return 0;
+}
+
+int fat_map_file(void *priv, loff_t offset, loff_t len, lbaint_t *blkp,
+		 loff_t *lenp)
+{
+	fat_file *file = priv;
+	fsdata *mydata = &file->fsdata;
+	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
+	loff_t filesize = FAT2CPU32(file->dent.size);
+	struct fat_run *run;
+	loff_t pos;
+
+	if (!cur_dev || mydata->sect_size != cur_dev->blksz)
+		return -ENOSYS;
+	if (!len || offset >= filesize)
+		return -EINVAL;
+	if (fat_map_runs(file, offset + 1))
+		return -EIO;
+
+	run = fat_find_run(file, offset);
+	pos = offset - run->offset;
+	if (pos & (mydata->sect_size - 1))
+		return -EINVAL;
+
+	*blkp = cur_part_info.start + clust_to_sect(mydata, run->clust) +
+		lldiv(pos, mydata->sect_size);
+	*lenp = min(len, (loff_t)run->count * bytesperclust - pos);
+
+	return 0;
+}
+
+void fat_close_file(void *priv)
+{
+	fat_file *file = priv;
+
+	free(file->runs);
+	free(file->fsdata.fatbuf);
+	free(file);
+}
+
 typedef struct {
 	struct fs_dir_stream parent;
 	struct fs_dirent dirent;
@@ -12,6 +12,7 @@
 #include <env.h>
 #include <lmb.h>
 #include <log.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <part.h>
 #include <ext4fs.h>
@@ -23,7 +24,10 @@
 #include <asm/io.h>
 #include <div64.h>
 #include <linux/math64.h>
+#include <linux/sizes.h>
 #include <efi_loader.h>
+#include <gzip.h>
+#include <memalign.h>
 #include <squashfs.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -171,6 +175,29 @@ struct fstype_info {
 	int (*unlink)(const char *filename);
 	int (*mkdir)(const char *dirname);
 	int (*ln)(const char *filename, const char *target);
+	/*
+	 * Open a file for reading.  On success return 0, the file size via
+	 * 'size' and the filesystem's per-file state via 'privp'.  On error
+	 * return -errno.  Optional, see fs_file_open().
+	 */
+	int (*open_file)(const char *filename, loff_t *size, void **privp);
+	/* see fs_file_pread() */
+	int (*pread)(void *priv, void *buf, loff_t offset, loff_t len,
+		     loff_t *actread);
+	/*
+	 * Find where the data at 'offset' in a file opened with open_file()
+	 * starts on the block device, which must be at a block boundary.
+	 * Return the block via 'blkp' and how many of the 'len' bytes from
+	 * 'offset' follow it contiguously via 'lenp'.  Optional, used to read
+	 * ahead with blk_dread_async().
+	 */
+	int (*map_file)(void *priv, loff_t offset, loff_t len, lbaint_t *blkp,
+			loff_t *lenp);
+	/*
+	 * Release the state returned by open_file().  The filesystem may
+	 * have been closed already, so this must only free memory.
+	 */
+	void (*close_file)(void *priv);
 };
 
 static struct fstype_info fstypes[] = {
@@ -199,6 +226,10 @@ static struct fstype_info fstypes[] = {
 		.readdir = fat_readdir,
 		.closedir = fat_closedir,
 		.ln = fs_ln_unsupported,
+		.open_file = fat_open_file,
+		.pread = fat_pread,
+		.map_file = fat_map_file,
+		.close_file = fat_close_file,
 	},
 #endif
 
@@ -224,6 +255,9 @@ static struct fstype_info fstypes[] = {
 		.opendir = fs_opendir_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
+		.open_file = ext4fs_open_file,
+		.pread = ext4fs_pread,
+		.close_file = ext4fs_close_file,
 	},
 #endif
 #ifdef CONFIG_SANDBOX
@@ -302,6 +336,9 @@ static struct fstype_info fstypes[] = {
 		.ln = fs_ln_unsupported,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
+		.open_file = sqfs_open_file,
+		.pread = sqfs_pread,
+		.close_file = sqfs_close_file,
 	},
 #endif
 	{
@@ -489,18 +526,15 @@ int fs_size(const char *filename, loff_t *size)
 
 #ifdef CONFIG_LMB
 /* Check if a file may be read to the given address */
-static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
-			     loff_t len, struct fstype_info *info)
+static int fs_read_lmb_check(struct fs_file *file, ulong addr, loff_t offset,
+			     loff_t len)
 {
 	struct lmb lmb;
-	int ret;
 	loff_t size;
 	loff_t read_len;
 
 	/* get the actual size of the file */
-	ret = info->size(filename, &size);
-	if (ret)
-		return ret;
+	size = fs_file_size(file);
 	if (offset >= size) {
 		/* offset >= EOF, no bytes will be written */
 		return 0;
@@ -525,15 +559,28 @@ static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
 static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 		    int do_lmb_check, loff_t *actread)
 {
-	struct fstype_info *info = fs_get_info(fs_type);
-	void *buf;
+	struct fs_file *file;
 	int ret;
 
+	file = fs_file_open(filename);
+	if (!file)
+		return -1;
+
+	/* Unlike fs_file_pread(), fail if there is nothing to read there */
+	if (offset && offset >= fs_file_size(file)) {
+		log_debug("** Offset 0x%llx is beyond the end of %s **\n",
+			  offset, filename);
+		fs_file_close(file);
+		return -EINVAL;
+	}
+
 #ifdef CONFIG_LMB
 	if (do_lmb_check) {
-		ret = fs_read_lmb_check(filename, addr, offset, len, info);
-		if (ret)
+		ret = fs_read_lmb_check(file, addr, offset, len);
+		if (ret) {
+			fs_file_close(file);
 			return ret;
+		}
 	}
 #endif
 
@@ -541,14 +588,12 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	 * We don't actually know how many bytes are being read, since len==0
 	 * means read the whole file.
 	 */
-	buf = map_sysmem(addr, len);
-	ret = info->read(filename, buf, offset, len, actread);
-	unmap_sysmem(buf);
+	ret = fs_file_pread(file, addr, offset, len, actread);
 
 	/* If we requested a specific number of bytes, check we got it */
 	if (ret == 0 && len && *actread != len)
 		log_debug("** %s shorter than offset + len **\n", filename);
-	fs_close();
+	fs_file_close(file);
 
 	return ret;
 }
@@ -559,6 +604,150 @@ int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	return _fs_read(filename, addr, offset, len, 0, actread);
 }
 
+static bool fs_file_is_current(struct fs_file *file);
+
+#if CONFIG_IS_ENABLED(GZIP)
+/* Size of the chunks of compressed data read by fs_read_decomp() */
+#define FS_DECOMP_CHUNK		SZ_256K
+
+/**
+ * struct fs_decomp - state of fs_read_decomp()
+ *
+ * While a chunk is decompressed, the next one is read into the other buffer
+ * with blk_dread_async(), if the filesystem can say where it is on the
+ * device. Otherwise each chunk is read when it is needed.
+ *
+ * @file: File being read
+ * @buf: Two buffers of FS_DECOMP_CHUNK bytes
+ * @cur: Index of the buffer being decompressed
+ * @req: Request reading ahead into the other buffer
+ * @ahead: Number of bytes being read ahead, 0 if none
+ */
+struct fs_decomp {
+	struct fs_file *file;
+	void *buf[2];
+	int cur;
+	struct blk_req req;
+	loff_t ahead;
+};
+
+/* Start reading the chunk at the file position into @buf */
+static void fs_decomp_read_ahead(struct fs_decomp *dec, void *buf, ulong len)
+{
+	struct fs_file *file = dec->file;
+	struct fstype_info *info = fs_get_info(file->fstype);
+	struct blk_desc *desc = file->desc;
+	lbaint_t blk;
+	loff_t n;
+
+	if (!info->map_file || !file->priv || !fs_file_is_current(file) ||
+	    file->pos >= file->size)
+		return;
+	len = min_t(loff_t, len, file->size - file->pos);
+	if (info->map_file(file->priv, file->pos, len, &blk, &n) || !n)
+		return;
+
+	/* The end of the last block is read too, the buffer has room for it */
+	memset(&dec->req, '\0', sizeof(dec->req));
+	if (blk_dread_async(desc, blk, DIV_ROUND_UP(n, desc->blksz), buf,
+			    &dec->req))
+		return;
+	dec->ahead = n;
+}
+
+static long fs_decomp_read(void *priv, void **bufp, ulong len)
+{
+	struct fs_decomp *dec = priv;
+	struct fs_file *file = dec->file;
+	loff_t actread;
+	void *buf;
+	long ret;
+
+	/* The other buffer is decompressed now, it was read ahead into */
+	dec->cur = !dec->cur;
+	buf = dec->buf[dec->cur];
+	if (dec->ahead) {
+		ret = blk_wait(&dec->req);
+		actread = dec->ahead;
+		dec->ahead = 0;
+		if (ret < 0)
+			return ret;
+		file->pos += actread;
+	} else {
+		ret = fs_file_read(file, map_to_sysmem(buf), len, &actread);
+		if (ret)
+			return ret;
+	}
+
+	/* gunzip_stream() has used all of the previous buffer */
+	fs_decomp_read_ahead(dec, dec->buf[!dec->cur], len);
+	*bufp = buf;
+
+	return actread;
+}
+
+int fs_read_decomp(const char *filename, ulong addr, loff_t len,
+		   loff_t *actread, loff_t *rawread)
+{
+	struct fs_decomp dec = {};
+	struct fs_file *file;
+	ulong maxlen, outlen;
+	void *dst;
+	int ret;
+
+	file = fs_file_open(filename);
+	if (!file)
+		return -1;
+
+	maxlen = len ? len : ~0UL - addr;
+#ifdef CONFIG_LMB
+	{
+		struct lmb lmb;
+		phys_size_t avail;
+
+		lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+		avail = lmb_get_free_size(&lmb, addr);
+		if (!avail) {
+			log_err("** Reading file would overwrite reserved memory **\n");
+			fs_file_close(file);
+			return -ENOSPC;
+		}
+		maxlen = min_t(phys_size_t, maxlen, avail);
+	}
+#endif
+
+	dec.file = file;
+	dec.buf[0] = malloc_cache_aligned(FS_DECOMP_CHUNK);
+	dec.buf[1] = malloc_cache_aligned(FS_DECOMP_CHUNK);
+	if (!dec.buf[0] || !dec.buf[1]) {
+		free(dec.buf[0]);
+		free(dec.buf[1]);
+		fs_file_close(file);
+		return -ENOMEM;
+	}
+
+	/* Start reading the first chunk into buf[1], used first */
+	dec.cur = 0;
+	fs_decomp_read_ahead(&dec, dec.buf[1], FS_DECOMP_CHUNK);
+
+	dst = map_sysmem(addr, maxlen);
+	ret = gunzip_stream(dst, maxlen, fs_decomp_read, &dec, dec.buf[0],
+			    FS_DECOMP_CHUNK, &outlen);
+	unmap_sysmem(dst);
+	/* Data read ahead past the end of the gzip stream is not needed */
+	if (dec.ahead)
+		blk_wait(&dec.req);
+	*actread = outlen;
+	*rawread = file->pos;
+
+	free(dec.buf[0]);
+	free(dec.buf[1]);
+	fs_file_close(file);
+
+	return ret;
+}
+#endif
+
 int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	     loff_t *actwrite)
 {
@@ -579,6 +768,139 @@ int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	return ret;
 }
 
+static int fs_file_open_priv(struct fs_file *file)
+{
+	struct fstype_info *info = fs_get_info(file->fstype);
+
+	if (!info->open_file)
+		return info->size(file->filename, &file->size) ? -ENOENT : 0;
+
+	return info->open_file(file->filename, &file->size, &file->priv);
+}
+
+static void fs_file_close_priv(struct fs_file *file)
+{
+	struct fstype_info *info = fs_get_info(file->fstype);
+
+	if (file->priv)
+		info->close_file(file->priv);
+	file->priv = NULL;
+}
+
+struct fs_file *fs_file_open(const char *filename)
+{
+	struct fs_file *file;
+	int ret;
+
+	file = calloc(1, sizeof(*file));
+	if (file)
+		file->filename = strdup(filename);
+	if (!file || !file->filename) {
+		free(file);
+		fs_close();
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	file->desc = fs_dev_desc;
+	file->part = fs_dev_part;
+	file->fstype = fs_type;
+
+	ret = fs_file_open_priv(file);
+	if (ret) {
+		free(file->filename);
+		free(file);
+		fs_close();
+		errno = -ret;
+		return NULL;
+	}
+
+	return file;
+}
+
+static bool fs_file_is_current(struct fs_file *file)
+{
+	return fs_type == file->fstype && fs_dev_desc == file->desc &&
+	       fs_dev_part == file->part;
+}
+
+/*
+ * Make sure the filesystem of an open file is the current one. If it was
+ * closed in the meantime, mount it again and re-open the file.
+ */
+static int fs_file_attach(struct fs_file *file)
+{
+	if (fs_file_is_current(file))
+		return 0;
+
+	fs_file_close_priv(file);
+
+	if (!file->desc || fs_set_blk_dev_with_part(file->desc, file->part))
+		return -ENODEV;
+
+	return fs_file_open_priv(file);
+}
+
+int fs_file_pread(struct fs_file *file, ulong addr, loff_t offset, loff_t len,
+		  loff_t *actread)
+{
+	struct fstype_info *info;
+	void *buf;
+	int ret;
+
+	ret = fs_file_attach(file);
+	if (ret)
+		return ret;
+	info = fs_get_info(fs_type);
+
+	*actread = 0;
+	if (offset >= file->size)
+		return 0;
+	if (!len || len > file->size - offset)
+		len = file->size - offset;
+
+	buf = map_sysmem(addr, len);
+	if (file->priv)
+		ret = info->pread(file->priv, buf, offset, len, actread);
+	else
+		ret = info->read(file->filename, buf, offset, len, actread);
+	unmap_sysmem(buf);
+
+	return ret < 0 ? ret : 0;
+}
+
+int fs_file_read(struct fs_file *file, ulong addr, loff_t len,
+		 loff_t *actread)
+{
+	int ret;
+
+	ret = fs_file_pread(file, addr, file->pos, len, actread);
+	if (ret)
+		return ret;
+
+	file->pos += *actread;
+
+	return 0;
+}
+
+loff_t fs_file_size(struct fs_file *file)
+{
+	return file->size;
+}
+
+void fs_file_close(struct fs_file *file)
+{
+	if (!file)
+		return;
+
+	fs_file_close_priv(file);
+	if (fs_file_is_current(file))
+		fs_close();
+
+	free(file->filename);
+	free(file);
+}
+
 struct fs_dir_stream *fs_opendir(const char *filename)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
@@ -701,13 +1023,22 @@ int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 	loff_t bytes;
 	loff_t pos;
 	loff_t len_read;
+	loff_t raw_read;
+	bool decomp = false;
 	int ret;
 	unsigned long time;
 	char *ep;
 
+	if (argc >= 2 && !strcmp(argv[1], "-z")) {
+		if (!CONFIG_IS_ENABLED(GZIP))
+			return CMD_RET_USAGE;
+		decomp = true;
+		argc--;
+		argv++;
+	}
 	if (argc < 2)
 		return CMD_RET_USAGE;
-	if (argc > 7)
+	if (argc > (decomp ? 6 : 7))
 		return CMD_RET_USAGE;
 
 	if (fs_set_blk_dev(argv[1], (argc >= 3) ? argv[2] : NULL, fstype))
@@ -743,7 +1074,13 @@ int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 		pos = 0;
 
 	time = get_timer(0);
-	ret = _fs_read(filename, addr, pos, bytes, 1, &len_read);
+#if CONFIG_IS_ENABLED(GZIP)
+	if (decomp)
+		ret = fs_read_decomp(filename, addr, bytes, &len_read,
+				     &raw_read);
+	else
+#endif
+		ret = _fs_read(filename, addr, pos, bytes, 1, &len_read);
 	time = get_timer(time);
 	if (ret < 0) {
 		log_err("Failed to load '%s'\n", filename);
@@ -754,10 +1091,16 @@ int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 		efi_set_bootdev(argv[1], (argc > 2) ? argv[2] : "",
 				(argc > 4) ? argv[4] : "");
 
-	printf("%llu bytes read in %lu ms", len_read, time);
+	if (decomp) {
+		printf("%llu bytes read, %llu bytes uncompressed in %lu ms",
+		       raw_read, len_read, time);
+	} else {
+		printf("%llu bytes read in %lu ms", len_read, time);
+		raw_read = len_read;
+	}
 	if (time > 0) {
 		puts(" (");
-		print_size(div_u64(len_read, time) * 1000, "/s");
+		print_size(div_u64(raw_read, time) * 1000, "/s");
 		puts(")");
 	}
 	puts("\n");
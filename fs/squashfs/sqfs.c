@@ -1253,7 +1253,7 @@ static int sqfs_get_regfile_info(struct squashfs_reg_inode *reg,
 				       fentry);
 		if (ret < 0)
 			return -EINVAL;
-		finfo->comp = true;
+		finfo->comp = ret;
 		if (fentry->size < 1 || fentry->start == 0x7FFFFFFF)
 			return -EINVAL;
 	} else {
@@ -1291,7 +1291,7 @@ static int sqfs_get_lregfile_info(struct squashfs_lreg_inode *lreg,
 				       fentry);
 		if (ret < 0)
 			return -EINVAL;
-		finfo->comp = true;
+		finfo->comp = ret;
 		if (fentry->size < 1 || fentry->start == 0x7FFFFFFF)
 			return -EINVAL;
 	} else {
@@ -1305,51 +1305,58 @@ static int sqfs_get_lregfile_info(struct squashfs_lreg_inode *lreg,
 	return datablk_count;
 }
 
-int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
-	      loff_t *actread)
+/* State of a file opened with sqfs_open_file() */
+struct squashfs_file {
+	struct squashfs_file_info finfo;
+	struct squashfs_fragment_block_entry frag_entry;
+	/* Number of data blocks, the fragment is not counted */
+	int datablk_count;
+	/* Device offset of each data block */
+	u64 *blk_offsets;
+	/* Last block read, see sqfs_load_block() */
+	char *block;
+	int cur_blk;
+	u32 cur_len;
+};
+
+static void sqfs_free_file(struct squashfs_file *file)
+{
+	free(file->finfo.blk_sizes);
+	free(file->blk_offsets);
+	free(file->block);
+	free(file);
+}
+
+int sqfs_open_file(const char *filename, loff_t *size, void **privp)
 {
-	char *dir = NULL, *fragment_block, *datablock = NULL, *data_buffer = NULL;
-	char *fragment = NULL, *file = NULL, *resolved, *data;
-	u64 start, n_blks, table_size, data_offset, table_offset;
-	int ret, j, i_number, datablk_count = 0;
 	struct squashfs_super_block *sblk = ctxt.sblk;
-	struct squashfs_fragment_block_entry frag_entry;
-	struct squashfs_file_info finfo = {0};
 	struct squashfs_symlink_inode *symlink;
 	struct fs_dir_stream *dirsp = NULL;
+	struct squashfs_file *file = NULL;
 	struct squashfs_dir_stream *dirs;
-	struct squashfs_lreg_inode *lreg;
 	struct squashfs_base_inode *base;
+	struct squashfs_lreg_inode *lreg;
 	struct squashfs_reg_inode *reg;
-	unsigned long dest_len;
+	char *dir = NULL, *name = NULL, *resolved;
+	int ret, i_number, datablk_count, j;
 	struct fs_dirent *dent;
 	unsigned char *ipos;
-
-	*actread = 0;
-
-	if (offset) {
-		/*
-		 * TODO: implement reading at an offset in file
-		 */
-		printf("Error: reading at a specific offset in a squashfs file is not supported yet.\n");
-		return -EINVAL;
-	}
+	u64 data_offset;
 
 	/*
 	 * sqfs_opendir will uncompress inode and directory tables, and will
 	 * return a pointer to the directory that contains the requested file.
 	 */
-	sqfs_split_path(&file, &dir, filename);
+	sqfs_split_path(&name, &dir, filename);
 	ret = sqfs_opendir(dir, &dirsp);
-	if (ret) {
+	if (ret)
 		goto out;
-	}
 
 	dirs = (struct squashfs_dir_stream *)dirsp;
 
 	/* For now, only regular files are able to be loaded */
 	while (!sqfs_readdir(dirsp, &dent)) {
-		ret = strcmp(dent->name, file);
+		ret = strcmp(dent->name, name);
 		if (!ret)
 			break;
 
@@ -1359,7 +1366,6 @@ int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
 
 	if (ret) {
 		printf("File not found.\n");
-		*actread = 0;
 		ret = -ENOENT;
 		goto out;
 	}
@@ -1367,39 +1373,36 @@ int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
 	i_number = dirs->dir_header->inode_number + dirs->entry->inode_offset;
 	ipos = sqfs_find_inode(dirs->inode_table, i_number, sblk->inodes,
 			       sblk->block_size);
+	free(dirs->entry);
+	dirs->entry = NULL;
+
+	file = calloc(1, sizeof(*file));
+	if (!file) {
+		ret = -ENOMEM;
+		goto out;
+	}
 
 	base = (struct squashfs_base_inode *)ipos;
 	switch (get_unaligned_le16(&base->inode_type)) {
 	case SQFS_REG_TYPE:
 		reg = (struct squashfs_reg_inode *)ipos;
-		datablk_count = sqfs_get_regfile_info(reg, &finfo, &frag_entry,
+		datablk_count = sqfs_get_regfile_info(reg, &file->finfo,
+						      &file->frag_entry,
 						      sblk->block_size);
-		if (datablk_count < 0) {
-			ret = -EINVAL;
-			goto out;
-		}
-
-		memcpy(finfo.blk_sizes, ipos + sizeof(*reg),
-		       datablk_count * sizeof(u32));
+		ipos += sizeof(*reg);
 		break;
 	case SQFS_LREG_TYPE:
 		lreg = (struct squashfs_lreg_inode *)ipos;
-		datablk_count = sqfs_get_lregfile_info(lreg, &finfo,
-						       &frag_entry,
+		datablk_count = sqfs_get_lregfile_info(lreg, &file->finfo,
+						       &file->frag_entry,
 						       sblk->block_size);
-		if (datablk_count < 0) {
-			ret = -EINVAL;
-			goto out;
-		}
-
-		memcpy(finfo.blk_sizes, ipos + sizeof(*lreg),
-		       datablk_count * sizeof(u32));
+		ipos += sizeof(*lreg);
 		break;
 	case SQFS_SYMLINK_TYPE:
 	case SQFS_LSYMLINK_TYPE:
 		symlink = (struct squashfs_symlink_inode *)ipos;
 		resolved = sqfs_resolve_symlink(symlink, filename);
-		ret = sqfs_read(resolved, buf, offset, len, actread);
+		ret = sqfs_open_file(resolved, size, privp);
 		free(resolved);
 		goto out;
 	case SQFS_BLKDEV_TYPE:
@@ -1416,147 +1419,202 @@ int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
 		goto out;
 	}
 
-	/* If the user specifies a length, check its sanity */
-	if (len) {
-		if (len > finfo.size) {
-			ret = -EINVAL;
-			goto out;
-		}
-
-		finfo.size = len;
-	} else {
-		len = finfo.size;
+	if (datablk_count < 0) {
+		ret = -EINVAL;
+		goto out;
 	}
+	file->datablk_count = datablk_count;
+	memcpy(file->finfo.blk_sizes, ipos, datablk_count * sizeof(u32));
 
-	if (datablk_count) {
-		data_offset = finfo.start;
-		datablock = malloc(get_unaligned_le32(&sblk->block_size));
-		if (!datablock) {
-			ret = -ENOMEM;
-			goto out;
-		}
+	file->blk_offsets = malloc(datablk_count * sizeof(u64));
+	file->block = malloc(get_unaligned_le32(&sblk->block_size));
+	if ((datablk_count && !file->blk_offsets) || !file->block) {
+		ret = -ENOMEM;
+		goto out;
 	}
 
+	data_offset = file->finfo.start;
 	for (j = 0; j < datablk_count; j++) {
-		start = data_offset / ctxt.cur_dev->blksz;
-		table_size = SQFS_BLOCK_SIZE(finfo.blk_sizes[j]);
-		table_offset = data_offset - (start * ctxt.cur_dev->blksz);
-		n_blks = DIV_ROUND_UP(table_size + table_offset,
-				      ctxt.cur_dev->blksz);
-
-		data_buffer = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
+		file->blk_offsets[j] = data_offset;
+		data_offset += SQFS_BLOCK_SIZE(file->finfo.blk_sizes[j]);
+	}
+	file->cur_blk = -1;
 
-		if (!data_buffer) {
-			ret = -ENOMEM;
-			goto out;
-		}
+	*size = file->finfo.size;
+	*privp = file;
+	file = NULL;
+	ret = 0;
 
-		ret = sqfs_disk_read(start, n_blks, data_buffer);
-		if (ret < 0) {
-			/*
-			 * Possible causes: too many data blocks or too large
-			 * SquashFS block size. Tip: re-compile the SquashFS
-			 * image with mksquashfs's -b <block_size> option.
-			 */
-			printf("Error: too many data blocks to be read.\n");
-			goto out;
-		}
+out:
+	if (file)
+		sqfs_free_file(file);
+	free(name);
+	free(dir);
+	if (dirsp)
+		sqfs_closedir(dirsp);
 
-		data = data_buffer + table_offset;
+	return ret;
+}
 
-		/* Load the data */
-		if (SQFS_COMPRESSED_BLOCK(finfo.blk_sizes[j])) {
-			dest_len = get_unaligned_le32(&sblk->block_size);
-			ret = sqfs_decompress(&ctxt, datablock, &dest_len,
-					      data, table_size);
-			if (ret)
-				goto out;
+/*
+ * Read data block 'blk' of a file into file->block, or its tail from the
+ * fragment block if 'blk' is the last block and the file is fragmented.
+ */
+static int sqfs_load_block(struct squashfs_file *file, int blk)
+{
+	u32 block_size = get_unaligned_le32(&ctxt.sblk->block_size);
+	u64 start, n_blks, table_size, table_offset, data_offset;
+	char *data_buffer, *data, *dest;
+	unsigned long dest_len;
+	u32 skip, length;
+	bool compressed;
+	int ret;
 
-			if ((*actread + dest_len) > len)
-				dest_len = len - *actread;
-			memcpy(buf + *actread, datablock, dest_len);
-			*actread += dest_len;
-		} else {
-			if ((*actread + table_size) > len)
-				table_size = len - *actread;
-			memcpy(buf + *actread, data, table_size);
-			*actread += table_size;
-		}
+	if (blk == file->cur_blk)
+		return 0;
 
-		data_offset += table_size;
-		free(data_buffer);
-		data_buffer = NULL;
-		if (*actread >= len)
-			break;
+	length = min_t(u64, block_size,
+		       file->finfo.size - (u64)blk * block_size);
+
+	if (blk < file->datablk_count) {
+		data_offset = file->blk_offsets[blk];
+		table_size = SQFS_BLOCK_SIZE(file->finfo.blk_sizes[blk]);
+		compressed = SQFS_COMPRESSED_BLOCK(file->finfo.blk_sizes[blk]);
+		skip = 0;
+	} else if (file->finfo.frag) {
+		data_offset = file->frag_entry.start;
+		table_size = SQFS_BLOCK_SIZE(file->frag_entry.size);
+		compressed = file->finfo.comp;
+		skip = file->finfo.offset;
+	} else {
+		return -EINVAL;
 	}
 
-	/*
-	 * There is no need to continue if the file is not fragmented.
-	 */
-	if (!finfo.frag) {
-		ret = 0;
-		goto out;
+	/* Sparse block */
+	if (!table_size) {
+		memset(file->block, 0, length);
+		goto done;
 	}
 
-	start = frag_entry.start / ctxt.cur_dev->blksz;
-	table_size = SQFS_BLOCK_SIZE(frag_entry.size);
-	table_offset = frag_entry.start - (start * ctxt.cur_dev->blksz);
+	start = data_offset / ctxt.cur_dev->blksz;
+	table_offset = data_offset - (start * ctxt.cur_dev->blksz);
 	n_blks = DIV_ROUND_UP(table_size + table_offset, ctxt.cur_dev->blksz);
 
-	fragment = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
+	data_buffer = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
+	if (!data_buffer)
+		return -ENOMEM;
 
-	if (!fragment) {
-		ret = -ENOMEM;
+	ret = sqfs_disk_read(start, n_blks, data_buffer);
+	if (ret < 0) {
+		/*
+		 * Possible causes: too many data blocks or too large
+		 * SquashFS block size. Tip: re-compile the SquashFS
+		 * image with mksquashfs's -b <block_size> option.
+		 */
+		printf("Error: too many data blocks to be read.\n");
 		goto out;
 	}
 
-	ret = sqfs_disk_read(start, n_blks, fragment);
-	if (ret < 0)
-		goto out;
+	data = data_buffer + table_offset;
 
-	/* File compressed and fragmented */
-	if (finfo.frag && finfo.comp) {
-		dest_len = get_unaligned_le32(&sblk->block_size);
-		fragment_block = malloc(dest_len);
-		if (!fragment_block) {
+	if (compressed) {
+		/* A fragment block holds the tails of several files */
+		dest = skip ? malloc(block_size) : file->block;
+		if (!dest) {
 			ret = -ENOMEM;
 			goto out;
 		}
 
-		ret = sqfs_decompress(&ctxt, fragment_block, &dest_len,
-				      (void *)fragment  + table_offset,
-				      frag_entry.size);
-		if (ret) {
-			free(fragment_block);
+		dest_len = block_size;
+		ret = sqfs_decompress(&ctxt, dest, &dest_len, data,
+				      table_size);
+		if (!ret && skip)
+			memcpy(file->block, dest + skip, length);
+		if (skip)
+			free(dest);
+		if (ret)
 			goto out;
-		}
+	} else {
+		memcpy(file->block, data + skip, length);
+	}
+	free(data_buffer);
 
-		for (j = *actread; j < finfo.size; j++) {
-			memcpy(buf + j, &fragment_block[finfo.offset + j], 1);
-			(*actread)++;
-		}
+done:
+	file->cur_blk = blk;
+	file->cur_len = length;
+
+	return 0;
+
+out:
+	free(data_buffer);
+	file->cur_blk = -1;
 
-		free(fragment_block);
+	return ret;
+}
 
-	} else if (finfo.frag && !finfo.comp) {
-		fragment_block = (void *)fragment + table_offset;
+int sqfs_pread(void *priv, void *buf, loff_t offset, loff_t len,
+	       loff_t *actread)
+{
+	u16 block_log = get_unaligned_le16(&ctxt.sblk->block_log);
+	struct squashfs_file *file = priv;
+	u32 blk_offset, n;
+	int ret;
 
-		for (j = *actread; j < finfo.size; j++) {
-			memcpy(buf + j, &fragment_block[finfo.offset + j], 1);
-			(*actread)++;
+	*actread = 0;
+	if (offset >= file->finfo.size)
+		return 0;
+	if (len > file->finfo.size - offset)
+		len = file->finfo.size - offset;
+
+	while (len) {
+		ret = sqfs_load_block(file, offset >> block_log);
+		if (ret)
+			return ret;
+
+		blk_offset = offset & ((1 << block_log) - 1);
+		n = min_t(loff_t, len, file->cur_len - blk_offset);
+		memcpy(buf + *actread, file->block + blk_offset, n);
+
+		offset += n;
+		len -= n;
+		*actread += n;
+	}
+
+	return 0;
+}
+
+void sqfs_close_file(void *priv)
+{
+	sqfs_free_file(priv);
+}
+
+int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
+	      loff_t *actread)
+{
+	void *file;
+	loff_t size;
+	int ret;
+
+	*actread = 0;
+
+	ret = sqfs_open_file(filename, &size, &file);
+	if (ret)
+		return ret;
+
+	/* If the user specifies a length, check its sanity */
+	if (len) {
+		if (offset + len > size) {
+			ret = -EINVAL;
+			goto out;
 		}
+	} else {
+		len = size - offset;
 	}
 
+	ret = sqfs_pread(file, buf, offset, len, actread);
+
 out:
-	free(fragment);
-	if (datablk_count) {
-		free(data_buffer);
-		free(datablock);
-	}
-	free(file);
-	free(dir);
-	free(finfo.blk_sizes);
-	sqfs_closedir(dirsp);
+	sqfs_close_file(file);
 
 	return ret;
 }
@@ -136,6 +136,25 @@ int blkcache_read(int iftype, int dev,
 		  lbaint_t start, lbaint_t blkcnt,
 		  unsigned long blksz, void *buffer);
 
+/**
+ * blkcache_readahead() - check whether a read should be extended
+ *
+ * This is called when blkcache_read() missed, before the blocks are read
+ * from the device. If the read continues the previous one, the blocks after
+ * it should be read as well and passed to blkcache_fill() together with the
+ * requested blocks.
+ *
+ * @param desc - block device
+ * @param start - starting block number of the request
+ * @param blkcnt - number of blocks requested
+ * @param countp - returns the number of blocks to read from @start
+ *
+ * @return - buffer to read *@countp blocks into, or NULL to read just the
+ * request
+ */
+void *blkcache_readahead(struct blk_desc *desc, lbaint_t start,
+			 lbaint_t blkcnt, lbaint_t *countp);
+
 /**
  * blkcache_fill() - make data read from a block device available
  * to the block cache
@@ -161,31 +180,61 @@ void blkcache_fill(int iftype, int dev,
  */
 void blkcache_invalidate(int iftype, int dev);
 
+/*
+ * configuration of the block cache
+ */
+struct block_cache_config {
+	unsigned size_kib;	/* memory budget per device */
+	unsigned readahead;	/* blocks to read after a sequential read */
+	unsigned max_blocks;	/* largest read which is cached */
+};
+
 /**
  * blkcache_configure() - configure block cache
  *
- * @param blocks - maximum blocks per entry
- * @param entries - maximum entries in cache
+ * This discards the cache and resets the statistics.
+ *
+ * @param config - new configuration
  */
-void blkcache_configure(unsigned blocks, unsigned entries);
+void blkcache_configure(const struct block_cache_config *config);
+
+/**
+ * blkcache_get_config() - get the block cache configuration
+ *
+ * @param config - configuration is copied here
+ */
+void blkcache_get_config(struct block_cache_config *config);
+
+/* Number of line size classes, small reads first */
+#define BLKCACHE_CLASSES	2
 
 /*
- * statistics of the block cache
+ * statistics of the block cache for one device
  */
 struct block_cache_stats {
+	int iftype;
+	int devnum;
+	unsigned long blksz;
 	unsigned hits;
 	unsigned misses;
-	unsigned entries; /* current entry count */
-	unsigned max_blocks_per_entry;
-	unsigned max_entries;
+	unsigned prefetched;	/* blocks read ahead */
+	unsigned prefetch_hits;	/* blocks read ahead and then used */
+	struct {
+		unsigned entries; /* current entry count */
+		unsigned max_entries;
+		unsigned blocks_per_entry;
+	} cls[BLKCACHE_CLASSES];
 };
 
 /**
- * get_blkcache_stats() - return statistics and reset
+ * blkcache_stats() - return statistics of a device and reset them
  *
+ * @param index - index of the device in the cache, starting at 0
  * @param stats - statistics are copied here
+ *
+ * @return - 0 if OK, -ENOENT if there is no device with this index
  */
-void blkcache_stats(struct block_cache_stats *stats);
+int blkcache_stats(int index, struct block_cache_stats *stats);
 
 #else
 
@@ -196,6 +245,13 @@ static inline int blkcache_read(int iftype, int dev,
 	return 0;
 }
 
+static inline void *blkcache_readahead(struct blk_desc *desc,
+				       lbaint_t start, lbaint_t blkcnt,
+				       lbaint_t *countp)
+{
+	return NULL;
+}
+
 static inline void blkcache_fill(int iftype, int dev,
 				 lbaint_t start, lbaint_t blkcnt,
 				 unsigned long blksz, void const *buffer) {}
@@ -204,6 +260,39 @@ static inline void blkcache_invalidate(int iftype, int dev) {}
 
 #endif
 
+/**
+ * struct blk_req - an asynchronous block read or write
+ *
+ * Submitted with blk_dread_async() or blk_dwrite_async() and finished with
+ * blk_poll() or blk_wait(). The caller owns the structure and must keep it,
+ * and the buffer, alive until the request has finished.
+ *
+ * @desc:	Block device the request was submitted to
+ * @start:	Start block number to read or write
+ * @blkcnt:	Number of blocks to read or write
+ * @buffer:	Destination buffer for data read, or data to write
+ * @write:	true if the request writes @buffer to the device
+ * @complete:	Optional callback set up by the caller before submission. It
+ *		is called once, from whichever of blk_dread_async(),
+ *		blk_dwrite_async(), blk_poll() or blk_wait() finds the request
+ *		finished
+ * @priv:	For use by @complete
+ * @result:	-EINPROGRESS while the request is pending, then the number of
+ *		blocks transferred or a -ve error number
+ * @done:	Private to the driver, e.g. number of blocks read so far
+ */
+struct blk_req {
+	struct blk_desc *desc;
+	lbaint_t start;
+	lbaint_t blkcnt;
+	void *buffer;
+	bool write;
+	void (*complete)(struct blk_req *req);
+	void *priv;
+	long result;
+	lbaint_t done;
+};
+
 #if CONFIG_IS_ENABLED(BLK)
 struct udevice;
 
@@ -265,6 +354,45 @@ struct blk_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*select_hwpart)(struct udevice *dev, int hwpart);
+
+	/**
+	 * read_async() - start reading from a block device
+	 *
+	 * Starts the transfer described by @req and returns without waiting
+	 * for it. Only one request may be in flight per device and no other
+	 * operation may be issued to the device until it has finished.
+	 *
+	 * @dev:	Device to read from
+	 * @req:	Request to start
+	 * @return 0 if started, -ENOSYS if the request cannot be handled
+	 * asynchronously (the caller then reads synchronously), other -ve
+	 * error number on error
+	 */
+	int (*read_async)(struct udevice *dev, struct blk_req *req);
+
+	/**
+	 * write_async() - start writing to a block device
+	 *
+	 * Like read_async(), for a write. The buffer must not be changed
+	 * until the request has finished.
+	 *
+	 * @dev:	Device to write to
+	 * @req:	Request to start
+	 * @return 0 if started, -ENOSYS if the request cannot be handled
+	 * asynchronously (the caller then writes synchronously), other -ve
+	 * error number on error
+	 */
+	int (*write_async)(struct udevice *dev, struct blk_req *req);
+
+	/**
+	 * poll() - check a request started with read_async() or write_async()
+	 *
+	 * @dev:	Device the request was started on
+	 * @req:	Request to check
+	 * @return -EINPROGRESS while the transfer is running, otherwise the
+	 * number of blocks transferred or -ve error number
+	 */
+	long (*poll)(struct udevice *dev, struct blk_req *req);
 };
 
 #define blk_get_ops(dev)	((struct blk_ops *)(dev)->driver->ops)
@@ -282,6 +410,59 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt);
 
+/**
+ * blk_dread_async() - start reading from a block device
+ *
+ * Starts a read which continues in the background if the device supports
+ * it (see CONFIG_BLK_ASYNC), so that the caller can work on previously read
+ * data meanwhile. Otherwise, or on a block cache hit, the read is done
+ * before this function returns. Either way the request has to be finished
+ * with blk_poll() or blk_wait().
+ *
+ * @block_dev:	Block device to read from
+ * @start:	Start block number to read (0=first)
+ * @blkcnt:	Number of blocks to read
+ * @buffer:	Destination buffer for data read
+ * @req:	Request to fill in, see struct blk_req
+ * @return 0 if the request was submitted, -ve on error
+ */
+int blk_dread_async(struct blk_desc *block_dev, lbaint_t start,
+		    lbaint_t blkcnt, void *buffer, struct blk_req *req);
+
+/**
+ * blk_dwrite_async() - start writing to a block device
+ *
+ * Like blk_dread_async(), for a write: the caller can receive the next
+ * data meanwhile. The buffer must not be changed until the request has
+ * finished.
+ *
+ * @block_dev:	Block device to write to
+ * @start:	Start block number to write (0=first)
+ * @blkcnt:	Number of blocks to write
+ * @buffer:	Source buffer for data to write
+ * @req:	Request to fill in, see struct blk_req
+ * @return 0 if the request was submitted, -ve on error
+ */
+int blk_dwrite_async(struct blk_desc *block_dev, lbaint_t start,
+		     lbaint_t blkcnt, const void *buffer, struct blk_req *req);
+
+/**
+ * blk_poll() - check whether a request has finished
+ *
+ * @req:	Request submitted with blk_dread_async() or blk_dwrite_async()
+ * @return -EINPROGRESS while the request is pending, otherwise the number
+ * of blocks transferred or -ve error number
+ */
+long blk_poll(struct blk_req *req);
+
+/**
+ * blk_wait() - wait for a request to finish
+ *
+ * @req:	Request submitted with blk_dread_async() or blk_dwrite_async()
+ * @return number of blocks transferred or -ve error number
+ */
+long blk_wait(struct blk_req *req);
+
 /**
  * blk_find_device() - Find a block device
  *
@@ -453,6 +634,34 @@ static inline ulong blk_dread(struct blk_desc *block_dev, lbaint_t start,
 	return blks_read;
 }
 
+static inline int blk_dread_async(struct blk_desc *block_dev,
+				  lbaint_t start, lbaint_t blkcnt,
+				  void *buffer, struct blk_req *req)
+{
+	ulong blks_read = blk_dread(block_dev, start, blkcnt, buffer);
+
+	req->desc = block_dev;
+	req->start = start;
+	req->blkcnt = blkcnt;
+	req->buffer = buffer;
+	req->write = false;
+	req->result = blks_read == blkcnt ? blks_read : -EIO;
+	if (req->complete)
+		req->complete(req);
+
+	return 0;
+}
+
+static inline long blk_poll(struct blk_req *req)
+{
+	return req->result;
+}
+
+static inline long blk_wait(struct blk_req *req)
+{
+	return req->result;
+}
+
 static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt, const void *buffer)
 {
@@ -460,6 +669,24 @@ static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 	return block_dev->block_write(block_dev, start, blkcnt, buffer);
 }
 
+static inline int blk_dwrite_async(struct blk_desc *block_dev,
+				   lbaint_t start, lbaint_t blkcnt,
+				   const void *buffer, struct blk_req *req)
+{
+	ulong blks_written = blk_dwrite(block_dev, start, blkcnt, buffer);
+
+	req->desc = block_dev;
+	req->start = start;
+	req->blkcnt = blkcnt;
+	req->buffer = (void *)buffer;
+	req->write = true;
+	req->result = blks_written == blkcnt ? blks_written : -EIO;
+	if (req->complete)
+		req->complete(req);
+
+	return 0;
+}
+
 static inline ulong blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt)
 {
@@ -15,6 +15,24 @@
 enum bootstage_flags {
 	BOOTSTAGEF_ERROR	= 1 << 0,	/* Error record */
 	BOOTSTAGEF_ALLOC	= 1 << 1,	/* Allocate an id */
+	BOOTSTAGEF_SPAN		= 1 << 2,	/* Record has a duration */
+	BOOTSTAGEF_CMD		= 1 << 3,	/* Span of a command */
+};
+
+/* Longest command line kept in the name of a command's span record */
+#define BOOTSTAGE_CMD_NAME_LEN	40
+
+/**
+ * struct bootstage_span - State of a span while it is being measured
+ *
+ * @start_us: Time the span started
+ * @read_bytes: Block device bytes read since reset when it started
+ * @write_bytes: Block device bytes written since reset when it started
+ */
+struct bootstage_span {
+	ulong start_us;
+	u64 read_bytes;
+	u64 write_bytes;
 };
 
 /* bootstate sub-IDs used for kernel and ramdisk ranges */
@@ -310,9 +328,63 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name);
  */
 uint32_t bootstage_accum(enum bootstage_id id);
 
+/**
+ * bootstage_span_start() - Start measuring a span
+ *
+ * A span is a record with a start time and a duration, which also counts
+ * the block device I/O done while it lasts. Spans may nest. They take at
+ * most half of the records, after which each new span replaces the oldest.
+ *
+ * @span: Span to start
+ */
+void bootstage_span_start(struct bootstage_span *span);
+
+/**
+ * bootstage_span_end() - Finish a span and add its record
+ *
+ * @span: Span started with bootstage_span_start()
+ * @name: Name of the record, which must stay valid
+ * @return the time now, in microseconds
+ */
+ulong bootstage_span_end(struct bootstage_span *span, const char *name);
+
+/**
+ * bootstage_cmd() - Finish the span of a shell command
+ *
+ * The record is only added if the command took at least
+ * CONFIG_BOOTSTAGE_CMD_MIN_US. It is named after the start of the command
+ * line and a hash of all its arguments.
+ *
+ * @span: Span started before the command ran
+ * @argc: Number of arguments of the command
+ * @argv: Arguments of the command
+ */
+void bootstage_cmd(struct bootstage_span *span, int argc, char *const argv[]);
+
+/**
+ * bootstage_blk_io() - Count block device I/O
+ *
+ * @write: true for data written to the device, false for data read
+ * @bytes: Number of bytes transferred
+ */
+void bootstage_blk_io(bool write, ulong bytes);
+
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * bootstage_trace_json() - Write the records as a Chrome trace
+ *
+ * Marks become instant events with a counter of the block I/O done so far,
+ * spans become complete events. Accumulated times are left out. The result
+ * can be loaded in chrome://tracing or Perfetto.
+ *
+ * @buf: Buffer to write the JSON text to
+ * @size: Size of the buffer
+ * @return length of the text, or -ENOSPC if the buffer is too small
+ */
+int bootstage_trace_json(char *buf, int size);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -350,6 +422,13 @@ int bootstage_unstash(const void *base, int size);
  */
 int bootstage_get_size(void);
 
+/**
+ * bootstage_get_rec_count() - Get the number of records in use
+ *
+ * @return number of records, at most CONFIG_BOOTSTAGE_RECORD_COUNT
+ */
+uint bootstage_get_rec_count(void);
+
 /**
  * bootstage_init() - Prepare bootstage for use
  *
@@ -409,6 +488,25 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline void bootstage_span_start(struct bootstage_span *span)
+{
+}
+
+static inline ulong bootstage_span_end(struct bootstage_span *span,
+				       const char *name)
+{
+	return 0;
+}
+
+static inline void bootstage_cmd(struct bootstage_span *span, int argc,
+				 char *const argv[])
+{
+}
+
+static inline void bootstage_blk_io(bool write, ulong bytes)
+{
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
@@ -424,6 +522,11 @@ static inline int bootstage_get_size(void)
 	return 0;
 }
 
+static inline uint bootstage_get_rec_count(void)
+{
+	return 0;
+}
+
 static inline int bootstage_init(bool first)
 {
 	return 0;
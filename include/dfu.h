@@ -139,6 +139,23 @@ struct dfu_entity {
 	int (*flush_medium)(struct dfu_entity *dfu);
 	unsigned int (*poll_timeout)(struct dfu_entity *dfu);
 
+	/*
+	 * Start writing a buffer in the background, see
+	 * CONFIG_DFU_WRITE_BEHIND. Returns -ENOSYS if this write must be done
+	 * synchronously with write_medium() instead.
+	 */
+	int (*write_medium_async)(struct dfu_entity *dfu,
+			u64 offset, void *buf, long *len);
+	/* Returns -EINPROGRESS until the background write has finished */
+	int (*poll_medium)(struct dfu_entity *dfu);
+
+	/*
+	 * Optional, make a range read as zeroes without writing it. @offset
+	 * and @len are multiples of erase_size.
+	 */
+	int (*erase_medium)(struct dfu_entity *dfu, u64 offset, u64 len);
+	u32 erase_size;
+
 	void (*free_entity)(struct dfu_entity *dfu);
 
 	struct list_head list;
@@ -156,6 +173,9 @@ struct dfu_entity {
 	u32 bad_skip;	/* for nand use */
 
 	unsigned int inited:1;
+	unsigned int wb_pending:1;	/* a buffer is written in background */
+	unsigned int decode:1;		/* sparse/compressed images are decoded */
+	unsigned int decoding:1;	/* an image is being decoded */
 };
 
 struct list_head;
@@ -330,6 +350,9 @@ int dfu_read(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
  * The block sequence number @blk_seq_num is a 16 bit counter that must be
  * incremented with each call for the same dfu entity @de.
  *
+ * Callers may receive data in place at @de->i_buf and pass that as @buf,
+ * which saves copying it.
+ *
  * See function :c:func:`dfu_flush`
  * See function :c:func:`dfu_write_from_mem_addr`
  *
@@ -341,6 +364,82 @@ int dfu_read(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
  */
 int dfu_write(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
 
+/**
+ * dfu_write_poll() - check the background write of a dfu entity
+ *
+ * With CONFIG_DFU_WRITE_BEHIND, dfu_write() writes a full buffer while the
+ * caller fills the other half of the DFU buffer. Callers which receive data
+ * for a long time without calling dfu_write() should call this meanwhile,
+ * so that the next write starts as early as possible.
+ *
+ * @de:			dfu entity
+ * Return:		0 if no write failed, a negative error code otherwise
+ */
+int dfu_write_poll(struct dfu_entity *de);
+
+#if CONFIG_IS_ENABLED(DFU_IMAGE_DECODE)
+/**
+ * dfu_image_start() - check whether a sparse or compressed image is written
+ *
+ * Called with the first data written to an entity which has @decode set.
+ * If the data starts an Android sparse image, or a gzip or zstd compressed
+ * image, decoding is set up and @de->decoding is set.
+ *
+ * @de:			dfu entity
+ * @buf:		first data of the file
+ * @len:		size of the data
+ * Return:		1 if the file is decoded, 0 if it is written as is, a
+ *			negative error code otherwise
+ */
+int dfu_image_start(struct dfu_entity *de, const void *buf, long len);
+
+/**
+ * dfu_image_write() - decode the next data of an image
+ *
+ * @de:			dfu entity
+ * @buf:		data of the image
+ * @len:		size of the data
+ * Return:		0 for success, a negative error code otherwise
+ */
+int dfu_image_write(struct dfu_entity *de, const void *buf, long len);
+
+/**
+ * dfu_image_finish() - write what is left of an image and check it is complete
+ *
+ * @de:			dfu entity
+ * Return:		0 for success, a negative error code otherwise
+ */
+int dfu_image_finish(struct dfu_entity *de);
+
+/**
+ * dfu_image_abort() - stop decoding an image
+ *
+ * @de:			dfu entity
+ */
+void dfu_image_abort(struct dfu_entity *de);
+#else
+static inline int dfu_image_start(struct dfu_entity *de, const void *buf,
+				  long len)
+{
+	return 0;
+}
+
+static inline int dfu_image_write(struct dfu_entity *de, const void *buf,
+				  long len)
+{
+	return 0;
+}
+
+static inline int dfu_image_finish(struct dfu_entity *de)
+{
+	return 0;
+}
+
+static inline void dfu_image_abort(struct dfu_entity *de)
+{
+}
+#endif
+
 /**
  * dfu_flush() - flush to dfu entity
  *
@@ -134,6 +134,42 @@ struct dma_ops {
 	 */
 	int (*transfer)(struct udevice *dev, int direction, void *dst,
 			void *src, size_t len);
+	/**
+	 * transfer_async() - Start a DMA transfer without waiting for it
+	 *
+	 * The uclass has already flushed the source from the data cache.
+	 * Only one transfer may be in progress on a device; poll() tells
+	 * when it has finished.
+	 *
+	 * @dev: The DMA device
+	 * @direction: direction of data transfer (should be one from
+	 *   enum dma_direction)
+	 * @dst: The destination pointer. For DMA_MEM_TO_DEV this is the
+	 *   address of the device register, which is written repeatedly.
+	 * @src: The source pointer.
+	 * @len: Length of the data to be copied (number of bytes).
+	 * @return zero if started, -EBUSY if a transfer is in progress, or
+	 *   other -ve error code.
+	 */
+	int (*transfer_async)(struct udevice *dev, int direction, void *dst,
+			      void *src, size_t len);
+	/**
+	 * poll() - Check on the transfer started by transfer_async()
+	 *
+	 * @dev: The DMA device
+	 * @return zero if it has finished (or none was started), -EBUSY if
+	 *   it is still in progress, or other -ve error code if it failed.
+	 */
+	int (*poll)(struct udevice *dev);
+	/**
+	 * stop() - Abort the transfer started by transfer_async()
+	 *
+	 * @dev: The DMA device
+	 * @return zero once the device has stopped accessing memory and the
+	 *   destination (or none was started), -ve error code if it could
+	 *   not be stopped.
+	 */
+	int (*stop)(struct udevice *dev);
 };
 
 #endif /* _DMA_UCLASS_H */
@@ -329,6 +329,58 @@ int dma_get_device(u32 transfer_type, struct udevice **devp);
 	     transferred and on failure return error code.
  */
 int dma_memcpy(void *dst, void *src, size_t len);
+
+/**
+ * dma_transfer_async() - Start a DMA transfer and return without waiting
+ *
+ * The source is flushed from the data cache first, so the caller may reuse
+ * the buffer once dma_poll() or dma_wait() reports that the transfer is
+ * finished, but not before. For DMA_MEM_TO_MEM the destination is
+ * invalidated, so it should be cache-aligned.
+ *
+ * @dev: DMA device to use
+ * @direction: Direction of the transfer (enum dma_direction)
+ * @dst: Destination. For DMA_MEM_TO_DEV this is a device register, which
+ *	is written repeatedly.
+ * @src: Source
+ * @len: Number of bytes to transfer
+ * @return 0 if started, -EBUSY if the device is still busy with an earlier
+ *	transfer, -ENOSYS if it cannot do asynchronous transfers, other -ve
+ *	on error
+ */
+int dma_transfer_async(struct udevice *dev, int direction, void *dst,
+		       void *src, size_t len);
+
+/**
+ * dma_poll() - Check whether an asynchronous transfer has finished
+ *
+ * @dev: DMA device
+ * @return 0 if finished or none was started, -EBUSY if still in progress,
+ *	other -ve if the transfer failed
+ */
+int dma_poll(struct udevice *dev);
+
+/**
+ * dma_wait() - Wait for an asynchronous transfer to finish
+ *
+ * @dev: DMA device
+ * @timeout_ms: Time to wait, in milliseconds
+ * @return 0 if finished or none was started, -ETIMEDOUT if it is still in
+ *	progress after @timeout_ms, other -ve if the transfer failed
+ */
+int dma_wait(struct udevice *dev, ulong timeout_ms);
+
+/**
+ * dma_stop() - Abort an asynchronous transfer
+ *
+ * This must be called before touching the destination of a transfer which
+ * dma_wait() gave up on, since it may otherwise still be running.
+ *
+ * @dev: DMA device
+ * @return 0 if stopped or none was in progress, -ENOSYS if the device cannot
+ *	abort transfers, other -ve if it could not be stopped
+ */
+int dma_stop(struct udevice *dev);
 #else
 static inline int dma_get_device(u32 transfer_type, struct udevice **devp)
 {
@@ -339,5 +391,26 @@ static inline int dma_memcpy(void *dst, void *src, size_t len)
 {
 	return -ENOSYS;
 }
+
+static inline int dma_transfer_async(struct udevice *dev, int direction,
+				     void *dst, void *src, size_t len)
+{
+	return -ENOSYS;
+}
+
+static inline int dma_poll(struct udevice *dev)
+{
+	return -ENOSYS;
+}
+
+static inline int dma_wait(struct udevice *dev, ulong timeout_ms)
+{
+	return -ENOSYS;
+}
+
+static inline int dma_stop(struct udevice *dev)
+{
+	return -ENOSYS;
+}
 #endif /* CONFIG_DMA */
 #endif	/* _DMA_H_ */
@@ -60,6 +60,12 @@ struct ext4_extent {
 	__le32	ee_start_lo;	/* low 32 bits of physical block */
 };
 
+/*
+ * ee_len values above EXT_INIT_MAX_LEN mark an uninitialized extent of
+ * (ee_len - EXT_INIT_MAX_LEN) blocks, which reads back as zeros.
+ */
+#define EXT_INIT_MAX_LEN	(1UL << 15)
+
 /*
  * This is index on-disk structure.
  * It's used at all the levels except the bottom.
@@ -119,12 +125,36 @@ struct ext_filesystem {
 	struct blk_desc *dev_desc;
 };
 
-struct ext_block_cache {
+/* Depth of the deepest extent tree, see ext4_ext_check_inode() in Linux */
+#define EXT_CACHE_LEVELS	5
+
+/*
+ * Number of extent tree blocks read in one go when the blocks referenced by
+ * neighbouring index entries are contiguous on disk
+ */
+#define EXT_CACHE_READAHEAD	8
+
+struct ext_cache_level {
 	char *buf;
 	lbaint_t block;
 	int size;
 };
 
+/*
+ * Each level of the extent tree keeps its own run of blocks, so that
+ * reading a leaf does not drop the index blocks above it.
+ */
+struct ext_block_cache {
+	struct ext_cache_level level[EXT_CACHE_LEVELS];
+};
+
+/*
+ * Upper bound for a single coalesced data read, so that the byte count
+ * handed to ext4fs_devread() cannot overflow. The block layer splits it
+ * further according to the controller's maximum transfer size.
+ */
+#define EXT4_MAX_READ_RUN	(1 << 30)
+
 extern struct ext2_data *ext4fs_root;
 extern struct ext2fs_node *ext4fs_file;
 
@@ -157,13 +187,21 @@ int ext4fs_devread(lbaint_t sector, int byte_offset, int byte_len, char *buf);
 void ext4fs_set_blk_dev(struct blk_desc *rbdd, struct disk_partition *info);
 long int read_allocated_block(struct ext2_inode *inode, int fileblock,
 			      struct ext_block_cache *cache);
+long int ext4fs_map_blocks(struct ext2_inode *inode, lbaint_t fileblock,
+			   lbaint_t maxblocks, struct ext_block_cache *cache,
+			   lbaint_t *blknr);
 int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 struct disk_partition *fs_partition);
 int ext4_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 		   loff_t *actread);
+int ext4fs_open_file(const char *filename, loff_t *size, void **privp);
+int ext4fs_pread(void *priv, void *buf, loff_t offset, loff_t len,
+		 loff_t *actread);
+void ext4fs_close_file(void *priv);
 int ext4_read_superblock(char *buffer);
 int ext4fs_uuid(char *uuid_str);
 void ext_cache_init(struct ext_block_cache *cache);
 void ext_cache_fini(struct ext_block_cache *cache);
-int ext_cache_read(struct ext_block_cache *cache, lbaint_t block, int size);
+void *ext_cache_read(struct ext_block_cache *cache, int depth, lbaint_t block,
+		     int size, int count);
 #endif
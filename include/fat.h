@@ -25,7 +25,14 @@ struct disk_partition;
 #define DIRENTSPERCLUST	((mydata->clust_size * mydata->sect_size) / \
 			 sizeof(dir_entry))
 
+#ifdef CONFIG_FS_FAT_FATBUF_BLOCKS
+#define FATBUFBLOCKS	CONFIG_FS_FAT_FATBUF_BLOCKS
+#else
 #define FATBUFBLOCKS	6
+#endif
+#if FATBUFBLOCKS % 3
+#error "CONFIG_FS_FAT_FATBUF_BLOCKS must be a multiple of 3"
+#endif
 #define FATBUFSIZE	(mydata->sect_size * FATBUFBLOCKS)
 #define FAT12BUFSIZE	((FATBUFSIZE*2)/3)
 #define FAT16BUFSIZE	(FATBUFSIZE/2)
@@ -195,6 +202,12 @@ int fat_size(const char *filename, loff_t *size);
 int file_fat_read_at(const char *filename, loff_t pos, void *buffer,
 		     loff_t maxsize, loff_t *actread);
 int file_fat_read(const char *filename, void *buffer, int maxsize);
+int fat_open_file(const char *filename, loff_t *size, void **privp);
+int fat_pread(void *priv, void *buf, loff_t offset, loff_t len,
+	      loff_t *actread);
+int fat_map_file(void *priv, loff_t offset, loff_t len, lbaint_t *blkp,
+		 loff_t *lenp);
+void fat_close_file(void *priv);
 int fat_set_blk_dev(struct blk_desc *rbdd, struct disk_partition *info);
 int fat_register_device(struct blk_desc *dev_desc, int part_no);
 
@@ -129,7 +129,8 @@ int fs_size(const char *filename, loff_t *size);
  *
  * @filename:	full path of the file to read from
  * @addr:	address of the buffer to write to
- * @offset:	offset in the file from where to start reading
+ * @offset:	offset in the file from where to start reading. A non-zero
+ *		offset at or beyond the end of the file is an error.
  * @len:	the number of bytes to read. Use 0 to read entire file.
  * @actread:	returns the actual number of bytes read
  * Return:	0 if OK with valid *actread, -1 on error conditions
@@ -137,6 +138,24 @@ int fs_size(const char *filename, loff_t *size);
 int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	    loff_t *actread);
 
+/**
+ * fs_read_decomp() - read and decompress a gzipped file
+ *
+ * The file is read in chunks from the partition previously set by
+ * fs_set_blk_dev() and each chunk is decompressed before the next one is
+ * read, so only the uncompressed data ends up in memory.
+ *
+ * @filename:	full path of the file to read from
+ * @addr:	address of the buffer to write the uncompressed data to
+ * @len:	maximum number of bytes to write. Use 0 to allow all memory
+ *		up to the next reserved region.
+ * @actread:	returns the number of uncompressed bytes
+ * @rawread:	returns the number of bytes read from the file
+ * Return:	0 if OK with valid *actread, negative on error
+ */
+int fs_read_decomp(const char *filename, ulong addr, loff_t len,
+		   loff_t *actread, loff_t *rawread);
+
 /**
  * fs_write() - write file to the partition previously set by fs_set_blk_dev()
  *
@@ -152,6 +171,87 @@ int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	     loff_t *actwrite);
 
+/* Note: fs_file should be treated as opaque to the user of fs layer */
+struct fs_file {
+	/* private to fs. layer: */
+	struct blk_desc *desc;
+	int part;
+	int fstype;
+	char *filename;
+	loff_t pos;
+	loff_t size;
+	/* filesystem specific state, see fstype_info.open_file() */
+	void *priv;
+};
+
+/**
+ * fs_file_open() - open a file for streaming reads
+ *
+ * Unlike the other file functions, fs_file_open() does not close the
+ * filesystem previously set by fs_set_blk_dev(). It stays mounted until
+ * fs_file_close() is called, so that a file can be read in several chunks
+ * without probing the partition again for every chunk.
+ *
+ * Filesystems which support it (ext4, FAT and squashfs) resolve the path
+ * only once and keep the inode, directory entry or block list of the file
+ * in the handle, so reads at any offset do not walk the path again. Other
+ * filesystems still look up the path, and walk the file from its start,
+ * for every read.
+ *
+ * @filename:	full path of the file to open
+ * Return:	pointer to the file handle or NULL on error and errno
+ *		set appropriately
+ */
+struct fs_file *fs_file_open(const char *filename);
+
+/**
+ * fs_file_pread() - read from a file opened with fs_file_open()
+ *
+ * The position of the handle is not changed.
+ *
+ * @file:	file handle
+ * @addr:	address of the buffer to write to
+ * @offset:	offset in the file from where to start reading
+ * @len:	the number of bytes to read. Use 0 to read up to the end of
+ *		the file.
+ * @actread:	returns the actual number of bytes read, 0 at end of file
+ * Return:	0 if OK with valid *actread, negative on error
+ */
+int fs_file_pread(struct fs_file *file, ulong addr, loff_t offset, loff_t len,
+		  loff_t *actread);
+
+/**
+ * fs_file_read() - read the next chunk of a file opened with fs_file_open()
+ *
+ * Reading starts at the current position of the handle, which is advanced
+ * by the number of bytes read.
+ *
+ * @file:	file handle
+ * @addr:	address of the buffer to write to
+ * @len:	the number of bytes to read. Use 0 to read the rest of the file.
+ * @actread:	returns the actual number of bytes read, 0 at end of file
+ * Return:	0 if OK with valid *actread, negative on error
+ */
+int fs_file_read(struct fs_file *file, ulong addr, loff_t len,
+		 loff_t *actread);
+
+/**
+ * fs_file_size() - get the size of a file opened with fs_file_open()
+ *
+ * @file:	file handle
+ * Return:	size of the file in bytes
+ */
+loff_t fs_file_size(struct fs_file *file);
+
+/**
+ * fs_file_close() - close a file opened with fs_file_open()
+ *
+ * This also closes the filesystem the file was opened on.
+ *
+ * @file:	file handle, may be NULL
+ */
+void fs_file_close(struct fs_file *file);
+
 /*
  * Directory entry types, matches the subset of DT_x in posix readdir()
  * which apply to u-boot.
@@ -31,6 +31,32 @@ int gzip_parse_header(const unsigned char *src, unsigned long len);
  */
 int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
 
+/**
+ * gunzip_stream() - Decompress gzipped data supplied in chunks
+ *
+ * The compressed data does not have to be in memory all at once: @read is
+ * called to fetch it a chunk at a time, e.g. from a file, and each chunk is
+ * decompressed before the next one is fetched. The CRC and size in the gzip
+ * trailer are checked.
+ *
+ * @dst: Destination for uncompressed data
+ * @dstlen: Size of destination buffer
+ * @read: Called to fetch up to @len bytes of compressed data. On entry
+ *	*@bufp is @buf, which the data can be read into. Alternatively @read
+ *	can point *@bufp at a buffer of its own which holds the data, e.g. one
+ *	it read ahead into. That buffer is not used after the next call.
+ *	Returns the number of bytes fetched, 0 at the end of the data, or -ve
+ *	on error
+ * @priv: Passed to @read
+ * @buf: Buffer for compressed data
+ * @bufsz: Size of @buf in bytes
+ * @lenp: Returns length of uncompressed data
+ * @return 0 if OK, -ENOSPC if @dstlen is too small, other -ve on error
+ */
+int gunzip_stream(void *dst, ulong dstlen,
+		  long (*read)(void *priv, void **bufp, ulong len), void *priv,
+		  void *buf, ulong bufsz, ulong *lenp);
+
 /**
  * zunzip() - Uncompress blocks compressed with zlib without headers
  *
@@ -1228,6 +1228,55 @@ void image_set_host_blob(void *host_blob);
 #endif
 #endif /* IMAGE_ENABLE_FIT */
 
+#ifdef USE_HOSTCC
+#define IMAGE_ENABLE_FIT_WORKER	0
+#else
+#define IMAGE_ENABLE_FIT_WORKER	CONFIG_IS_ENABLED(FIT_HASH_WORKER)
+#endif
+
+#if IMAGE_ENABLE_FIT_WORKER
+/**
+ * fit_hash_worker_begin() - allow hashing of FIT images on the worker core
+ *
+ * Between this call and fit_hash_worker_end(), fit_image_load() queues the
+ * hashes of the other images of the selected configuration on the
+ * secondary core and fit_image_verify() uses the results.
+ */
+void fit_hash_worker_begin(void);
+
+/**
+ * fit_hash_worker_end() - wait for and drop all queued FIT image hashes
+ *
+ * Results are only valid while the images cannot change under them, so
+ * this must be called before control returns to the command line, and
+ * before any memory is written other than by loading an image.
+ */
+void fit_hash_worker_end(void);
+
+/**
+ * fit_hash_worker_invalidate() - drop hashes of data which was overwritten
+ *
+ * This is called when an image is loaded, e.g. copied or decompressed to its
+ * load address, so that other images there are hashed again.
+ *
+ * @addr: Start of the memory written
+ * @size: Size of the memory written in bytes
+ */
+void fit_hash_worker_invalidate(ulong addr, ulong size);
+#else
+static inline void fit_hash_worker_begin(void)
+{
+}
+
+static inline void fit_hash_worker_end(void)
+{
+}
+
+static inline void fit_hash_worker_invalidate(ulong addr, ulong size)
+{
+}
+#endif
+
 /* Information passed to the signing routines */
 struct image_sign_info {
 	const char *keydir;		/* Directory conaining keys */
@@ -254,6 +254,7 @@ enum spi_nor_option_flags {
  *		       spi_nor_scan()
  */
 struct flash_info;
+struct spi_mem_dirmap_desc;
 
 /*
  * TODO: Remove, once all users of spi_flash interface are moved to MTD
@@ -302,6 +303,7 @@ struct flash_info;
  * @flash_is_locked:	[FLASH-SPECIFIC] check if a region of the SPI NOR is
  * @quad_enable:	[FLASH-SPECIFIC] enables SPI NOR quad mode
  *			completely locked
+ * @dirmap:		pointers to struct spi_mem_dirmap_desc for reads
  * @priv:		the private data
  */
 struct spi_nor {
@@ -348,6 +350,10 @@ struct spi_nor {
 	int (*flash_is_locked)(struct spi_nor *nor, loff_t ofs, uint64_t len);
 	int (*quad_enable)(struct spi_nor *nor);
 
+	struct {
+		struct spi_mem_dirmap_desc *rdesc;
+	} dirmap;
+
 	void *priv;
 /* Compatibility for spi_flash, remove once sf layer is merged with mtd */
 	const char *name;
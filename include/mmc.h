@@ -82,6 +82,8 @@ struct bd_info;
 
 
 #define SD_DATA_4BIT	0x00040000
+#define SD_SCR_CMD23_SUPPORT	0x00000002
+#define SD_SCR_DATA_STAT_AFTER_ERASE	0x00800000
 
 #define IS_SD(x)	((x)->version & SD_VERSION_SD)
 #define IS_MMC(x)	((x)->version & MMC_VERSION_MMC)
@@ -230,6 +232,7 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 #define EXT_CSD_ERASE_GROUP_DEF		175	/* R/W */
 #define EXT_CSD_BOOT_BUS_WIDTH		177
 #define EXT_CSD_PART_CONF		179	/* R/W */
+#define EXT_CSD_ERASED_MEM_CONT		181	/* RO */
 #define EXT_CSD_BUS_WIDTH		183	/* R/W */
 #define EXT_CSD_STROBE_SUPPORT		184	/* R/W */
 #define EXT_CSD_HS_TIMING		185	/* R/W */
@@ -453,6 +456,33 @@ struct dm_mmc_ops {
 	int (*send_cmd)(struct udevice *dev, struct mmc_cmd *cmd,
 			struct mmc_data *data);
 
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	/**
+	 * send_cmd_async() - Send a command, leaving its data transfer running
+	 *
+	 * The transfer is finished with poll_data(). Hosts may also complete
+	 * the transfer before returning, poll_data() then returns 0 at once.
+	 *
+	 * @dev:	Device to receive the command
+	 * @cmd:	Command to send
+	 * @data:	Data to receive, must stay valid until poll_data()
+	 *		returns something other than -EINPROGRESS
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*send_cmd_async)(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data);
+
+	/**
+	 * poll_data() - Check the data transfer started by send_cmd_async()
+	 *
+	 * @dev:	Device the command was sent to
+	 * @data:	Data passed to send_cmd_async()
+	 * @return -EINPROGRESS while the transfer is running, 0 once it has
+	 * finished, other -ve on error
+	 */
+	int (*poll_data)(struct udevice *dev, struct mmc_data *data);
+#endif
+
 	/**
 	 * set_ios() - Set the I/O speed/width for an MMC device
 	 *
@@ -549,6 +579,9 @@ int dm_mmc_host_power_cycle(struct udevice *dev);
 int dm_mmc_deferred_probe(struct udevice *dev);
 int dm_mmc_reinit(struct udevice *dev);
 int dm_mmc_get_b_max(struct udevice *dev, void *dst, lbaint_t blkcnt);
+int dm_mmc_send_cmd_async(struct udevice *dev, struct mmc_cmd *cmd,
+			  struct mmc_data *data);
+int dm_mmc_poll_data(struct udevice *dev, struct mmc_data *data);
 
 /* Transition functions for compatibility */
 int mmc_set_ios(struct mmc *mmc);
@@ -734,6 +767,14 @@ struct mmc {
 				  */
 	u32 quirks;
 	u8 hs400_tuning;
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	struct blk_req *async_req;	/* asynchronous transfer in flight */
+	struct mmc_data async_data;	/* its current transfer */
+	lbaint_t async_cnt;		/* blocks in the current transfer */
+	bool async_sbc;			/* current transfer uses CMD23 */
+	bool async_busy;		/* card is programming written data */
+	ulong async_busy_start;		/* when programming started */
+#endif
 };
 
 struct mmc_hwpart_conf {
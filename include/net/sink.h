@@ -0,0 +1,142 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Destinations for files received over the network
+ */
+
+#ifndef __NET_SINK_H__
+#define __NET_SINK_H__
+
+#include <linux/errno.h>
+#include <linux/types.h>
+
+/**
+ * struct net_sink - destination of a file received by tftp, nfs or wget
+ *
+ * Instead of being stored at the load address, the received data is staged
+ * in a buffer of CONFIG_NET_SINK_BUF_SIZE bytes and passed on to the sink in
+ * order, while the transfer goes on.
+ *
+ * @name:	Name shown to the user
+ * @align:	All writes but the last one are a multiple of this size
+ * @start:	Prepare for a transfer. This is called again if the transfer
+ *		is started again.
+ * @write:	Write @len bytes which start at @offset in the file
+ * @finish:	The transfer is complete, @size bytes were written
+ * @abort:	The transfer failed (optional)
+ * @priv:	Private data of the sink
+ */
+struct net_sink {
+	const char *name;
+	ulong align;
+	int (*start)(struct net_sink *sink);
+	int (*write)(struct net_sink *sink, ulong offset, const void *buf,
+		     ulong len);
+	int (*finish)(struct net_sink *sink, ulong size);
+	void (*abort)(struct net_sink *sink);
+	void *priv;
+};
+
+#if IS_ENABLED(CONFIG_NET_SINK)
+/**
+ * net_sink_set() - Use a sink for the next tftp, nfs or wget transfer
+ *
+ * The sink is dropped once that transfer is over.
+ *
+ * @sink: Sink to use, NULL to store the next file in memory again
+ */
+void net_sink_set(struct net_sink *sink);
+
+/**
+ * net_sink_is_set() - Check whether a sink is set for the next transfer
+ *
+ * Return: true if a sink is set
+ */
+bool net_sink_is_set(void);
+
+/**
+ * net_sink_active() - Check whether a transfer to a sink is going on
+ *
+ * This is true between net_sink_begin() and net_sink_end() only.
+ *
+ * Return: true if received data goes to a sink
+ */
+bool net_sink_active(void);
+
+/**
+ * net_sink_begin() - Start a transfer to the sink
+ *
+ * This is called by the protocol each time it (re)starts a transfer.
+ *
+ * Return: 0 if OK, -ve on error
+ */
+int net_sink_begin(void);
+
+/**
+ * net_sink_store() - Stage data received for the sink
+ *
+ * The data may arrive out of order, as long as it fits into the buffer.
+ *
+ * @offset: Offset of the data in the file
+ * @src: Data received
+ * @len: Number of bytes received
+ * Return: 0 if OK, -ENOSPC if the data is too far ahead to be staged
+ */
+int net_sink_store(ulong offset, const void *src, ulong len);
+
+/**
+ * net_sink_commit() - Report that all data up to an offset was received
+ *
+ * Once the buffer is half full, the data is written to the sink. This does
+ * nothing if no sink is set.
+ *
+ * @end: Offset up to which the file was received
+ * Return: 0 if OK, -ve on error
+ */
+int net_sink_commit(ulong end);
+
+/**
+ * net_sink_end() - End the transfer to the sink
+ *
+ * If the transfer succeeded, the staged data is written and the sink
+ * finished, otherwise the sink is aborted. The sink is then dropped, also
+ * if the transfer was never started.
+ *
+ * @ret: Result of the transfer, -ve on error
+ * Return: @ret, or -ve if writing to the sink failed
+ */
+int net_sink_end(int ret);
+#else
+static inline void net_sink_set(struct net_sink *sink) {}
+
+static inline bool net_sink_is_set(void)
+{
+	return false;
+}
+
+static inline bool net_sink_active(void)
+{
+	return false;
+}
+
+static inline int net_sink_begin(void)
+{
+	return 0;
+}
+
+static inline int net_sink_store(ulong offset, const void *src, ulong len)
+{
+	return -ENOSYS;
+}
+
+static inline int net_sink_commit(ulong end)
+{
+	return 0;
+}
+
+static inline int net_sink_end(int ret)
+{
+	return ret;
+}
+#endif
+
+#endif /* __NET_SINK_H__ */
@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Minimal TCP client, enough to download a file over HTTP
+ */
+
+#ifndef __NET_TCP_H__
+#define __NET_TCP_H__
+
+#include <net.h>
+
+/*
+ *	Internet Protocol (IP) + TCP header.
+ */
+struct ip_tcp_hdr {
+	u8		ip_hl_v;	/* header length and version	*/
+	u8		ip_tos;		/* type of service		*/
+	u16		ip_len;		/* total length			*/
+	u16		ip_id;		/* identification		*/
+	u16		ip_off;		/* fragment offset field	*/
+	u8		ip_ttl;		/* time to live			*/
+	u8		ip_p;		/* protocol			*/
+	u16		ip_sum;		/* checksum			*/
+	struct in_addr	ip_src;		/* Source IP address		*/
+	struct in_addr	ip_dst;		/* Destination IP address	*/
+	u16		tcp_src;	/* TCP source port		*/
+	u16		tcp_dst;	/* TCP destination port		*/
+	u32		tcp_seq;	/* Sequence number		*/
+	u32		tcp_ack;	/* Acknowledgment number	*/
+	u8		tcp_hlen;	/* 4 bits header length		*/
+	u8		tcp_flags;	/* Control flags		*/
+	u16		tcp_win;	/* Receive window		*/
+	u16		tcp_xsum;	/* Checksum			*/
+	u16		tcp_urg;	/* Urgent pointer		*/
+} __attribute__((packed));
+
+#define IP_TCP_HDR_SIZE		(sizeof(struct ip_tcp_hdr))
+#define TCP_HDR_SIZE		(IP_TCP_HDR_SIZE - IP_HDR_SIZE)
+
+#define TCP_FIN		0x01
+#define TCP_SYN		0x02
+#define TCP_RST		0x04
+#define TCP_PUSH	0x08
+#define TCP_ACK		0x10
+
+/* Largest segment received, for an Ethernet MTU of 1500 bytes */
+#define TCP_MSS		(1500 - IP_TCP_HDR_SIZE)
+
+enum tcp_event {
+	TCP_EV_CONNECTED,	/* The connection is established */
+	TCP_EV_CLOSED,		/* The peer closed the connection */
+	TCP_EV_RESET,		/* The peer reset the connection */
+	TCP_EV_TIMEOUT,		/* The peer stopped answering */
+};
+
+/**
+ * typedef tcp_rx_handler - Handle data received on the connection
+ *
+ * The data is passed on in order and exactly once.
+ *
+ * @data: Data received
+ * @len: Number of bytes received
+ * @offset: Offset of the data in the stream received so far
+ */
+typedef void tcp_rx_handler(const uchar *data, unsigned int len, ulong offset);
+
+/**
+ * typedef tcp_event_handler - Handle a change of state of the connection
+ *
+ * @event: What happened
+ */
+typedef void tcp_event_handler(enum tcp_event event);
+
+/**
+ * net_set_tcp_header() - Fill in the IP and TCP headers of a segment
+ *
+ * This is used by net_send_ip_packet() for IPPROTO_TCP.
+ *
+ * @pkt: Start of the IP header
+ * @dest: Destination IP address
+ * @dport: Destination port
+ * @sport: Source port
+ * @payload_len: Number of data bytes after the TCP header
+ * @flags: TCP_... flags of the segment
+ * @seq: Sequence number
+ * @ack: Acknowledgment number
+ * Return: size of the IP and TCP headers
+ */
+int net_set_tcp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
+		       int payload_len, u8 flags, u32 seq, u32 ack);
+
+/**
+ * tcp_connect() - Open a connection
+ *
+ * This takes over the net_loop() timeout handler. @event is called with
+ * TCP_EV_CONNECTED once the connection is established.
+ *
+ * @dest: IP address of the server
+ * @port: Port of the server
+ * @rx: Called with the data received
+ * @event: Called when the state of the connection changes
+ */
+void tcp_connect(struct in_addr dest, int port, tcp_rx_handler *rx,
+		 tcp_event_handler *event);
+
+/**
+ * tcp_send() - Send data on an established connection
+ *
+ * Only one segment may be in flight. It is sent again until the peer
+ * acknowledges it.
+ *
+ * @data: Data to send
+ * @len: Number of bytes, at most TCP_MSS
+ * Return: 0 if OK, -ve on error
+ */
+int tcp_send(const void *data, unsigned int len);
+
+/**
+ * tcp_close() - Close the connection
+ *
+ * A FIN is sent if the connection is established. No handler is called
+ * anymore afterwards.
+ */
+void tcp_close(void);
+
+/**
+ * tcp_receive() - Process a TCP segment received by net_loop()
+ *
+ * @ip: Start of the IP header
+ * @len: Length of the IP packet
+ */
+void tcp_receive(struct ip_tcp_hdr *ip, int len);
+
+#endif /* __NET_TCP_H__ */
@@ -392,6 +392,36 @@ int os_read_file(const char *name, void **bufp, int *sizep);
  */
 void *os_find_text_base(void);
 
+/**
+ * os_thread_create() - start a host thread
+ *
+ * The thread runs until the sandbox exits. It is used to stand in for a
+ * secondary CPU core.
+ *
+ * @func:	Function to run in the thread
+ * @arg:	Argument to pass to @func
+ * Return:	0 if OK, -1 on error
+ */
+int os_thread_create(void (*func)(void *arg), void *arg);
+
+/**
+ * os_profile_start() - call a function periodically with the current PC
+ *
+ * This stands in for the timer interrupt of the sampling profiler. A host
+ * SIGALRM is raised at @rate and its handler passes the address the sandbox
+ * was interrupted at to @func.
+ *
+ * @rate:	Number of calls per second, at least 1
+ * @func:	Function to call from the signal handler
+ * Return:	0 if OK, -1 on error
+ */
+int os_profile_start(unsigned int rate, void (*func)(unsigned long pc));
+
+/**
+ * os_profile_stop() - stop the calls started by os_profile_start()
+ */
+void os_profile_stop(void);
+
 /**
  * os_relaunch() - restart the sandbox
  *
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Sampling profiler
+ *
+ * A periodic interrupt records the address U-Boot was running at. The
+ * samples are written to memory with 'profile dump' and turned into a
+ * list of functions with 'proftool -s <file> dump-samples'.
+ */
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#define PROFILE_MAGIC		0x53504255	/* "UBPS" */
+#define PROFILE_VERSION		1
+
+/* Sampling rate used when none is given, in Hz */
+#define PROFILE_DEFAULT_RATE	1000
+
+/**
+ * struct profile_hdr - Header of the samples written by profile_dump()
+ *
+ * The header is followed by @count 32-bit sample offsets, oldest first. An
+ * offset is the sampled address less the start of U-Boot's text, so that it
+ * matches System.map whatever address U-Boot was relocated to.
+ *
+ * @magic: PROFILE_MAGIC
+ * @version: PROFILE_VERSION
+ * @rate: Sampling rate in Hz
+ * @count: Number of samples which follow
+ * @lost: Number of older samples overwritten because the buffer was full
+ */
+struct profile_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t rate;
+	uint32_t count;
+	uint32_t lost;
+};
+
+#ifndef USE_HOSTCC
+#if CONFIG_IS_ENABLED(PROFILE)
+/**
+ * profile_start() - Discard the previous samples and start sampling
+ *
+ * @rate: Sampling rate in Hz
+ * @return 0 if OK, -EBUSY if already running, other -ve on error
+ */
+int profile_start(uint rate);
+
+/**
+ * profile_stop() - Stop sampling
+ *
+ * This does nothing if the profiler is not running. It is called before
+ * booting an OS, which would not expect the interrupt.
+ */
+void profile_stop(void);
+
+/**
+ * profile_show() - Print the state of the profiler and how many samples
+ *	it holds
+ */
+void profile_show(void);
+
+/**
+ * profile_dump() - Write the samples to a buffer
+ *
+ * @buf: Buffer to write a struct profile_hdr and the samples to
+ * @size: Size of the buffer. If it is too small the oldest samples are
+ *	left out.
+ * @return number of bytes written, -EBUSY if the profiler is running,
+ *	-ENOSPC if not even the header fits
+ */
+int profile_dump(void *buf, int size);
+
+/**
+ * profile_sample() - Record a sample
+ *
+ * This is called by the architecture's interrupt handler.
+ *
+ * @pc: Address the interrupted code was running at
+ */
+void profile_sample(ulong pc);
+
+/**
+ * arch_profile_start() - Start the periodic interrupt
+ *
+ * @rate: Rate of the interrupt in Hz
+ * @return 0 if OK, -ve on error
+ */
+int arch_profile_start(uint rate);
+
+/* arch_profile_stop() - Stop the periodic interrupt */
+void arch_profile_stop(void);
+#else
+static inline void profile_stop(void)
+{
+}
+#endif
+#endif /* !USE_HOSTCC */
+
+#endif
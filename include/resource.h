@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Resources built into U-Boot, such as images shown by the board
+ *
+ * A resource is a file which is compressed with gzip when U-Boot is built
+ * and linked in. It is decompressed the first time it is asked for.
+ */
+
+#ifndef __RESOURCE_H
+#define __RESOURCE_H
+
+#include <linker_lists.h>
+
+/**
+ * struct resource_blob - A resource built into U-Boot
+ *
+ * @name: Name used to find the resource, e.g. "battery-charging.bmp"
+ * @start: Start of the gzip data
+ * @end: End of the gzip data
+ * @data: Decompressed resource, or NULL if it is not needed yet
+ * @size: Size of @data in bytes
+ */
+struct resource_blob {
+	const char *name;
+	const u8 *start;
+	const u8 *end;
+	void *data;
+	ulong size;
+};
+
+#if CONFIG_IS_ENABLED(RESOURCE)
+/**
+ * U_BOOT_RESOURCE() - Declare a resource
+ *
+ * The file must also be added to the Makefile as <file>.res.o, e.g.
+ * 'obj-y += battery-charging.bmp.res.o', which compresses it.
+ *
+ * @_sym: File name with '-' and '.' changed to '_', e.g. battery_charging_bmp
+ * @_name: Name used to find the resource
+ */
+#define U_BOOT_RESOURCE(_sym, _name)					\
+	extern const u8 __res_##_sym##_begin[];				\
+	extern const u8 __res_##_sym##_end[];				\
+	ll_entry_declare(struct resource_blob, _sym, resource) = {	\
+		.name = _name,						\
+		.start = __res_##_sym##_begin,				\
+		.end = __res_##_sym##_end,				\
+	}
+
+/**
+ * resource_get() - Get a resource, decompressing it if needed
+ *
+ * The resource is decompressed into memory from malloc() the first time. As
+ * that is part of U-Boot's own region, it is not overwritten by images which
+ * are loaded later.
+ *
+ * @name: Name of the resource
+ * @datap: Returns a pointer to the resource
+ * @sizep: Returns the size of the resource in bytes
+ * @return 0 if OK, -ENOENT if there is no such resource, -ENOMEM if there is
+ *	not enough memory to decompress it, -EIO if the data is corrupt
+ */
+int resource_get(const char *name, void **datap, ulong *sizep);
+#else
+#define U_BOOT_RESOURCE(_sym, _name)					\
+	extern const u8 __res_##_sym##_begin[]
+
+static inline int resource_get(const char *name, void **datap, ulong *sizep)
+{
+	return -ENOSYS;
+}
+#endif
+
+#endif
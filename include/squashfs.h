@@ -18,6 +18,10 @@ int sqfs_probe(struct blk_desc *fs_dev_desc,
 	       struct disk_partition *fs_partition);
 int sqfs_read(const char *filename, void *buf, loff_t offset,
 	      loff_t len, loff_t *actread);
+int sqfs_open_file(const char *filename, loff_t *size, void **privp);
+int sqfs_pread(void *priv, void *buf, loff_t offset, loff_t len,
+	       loff_t *actread);
+void sqfs_close_file(void *priv);
 int sqfs_size(const char *filename, loff_t *size);
 int sqfs_exists(const char *filename);
 void sqfs_close(void);
@@ -101,6 +101,17 @@ void sha1_hmac(const unsigned char *key, int keylen,
  */
 int sha1_self_test( void );
 
+/**
+ * \brief	   Hash whole 64-byte blocks, provided by the architecture
+ *		   when CONFIG_SHA1_ARMV7 is enabled
+ *
+ * \param state    SHA-1 state to update
+ * \param data     buffer holding the data, need not be aligned
+ * \param blocks   number of blocks in the buffer
+ */
+void sha1_block_data_order(unsigned long state[5], const unsigned char *data,
+			   unsigned int blocks);
+
 #ifdef __cplusplus
 }
 #endif
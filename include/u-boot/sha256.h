@@ -22,4 +22,16 @@ void sha256_finish(sha256_context * ctx, uint8_t digest[SHA256_SUM_LEN]);
 void sha256_csum_wd(const unsigned char *input, unsigned int ilen,
 		unsigned char *output, unsigned int chunk_sz);
 
+/**
+ * sha256_block_data_order() - hash whole blocks, arch-specific
+ *
+ * Provided by the architecture when CONFIG_SHA256_ARMV7 is enabled.
+ *
+ * @state:	hash state to update
+ * @data:	input data, need not be aligned
+ * @blocks:	number of 64-byte blocks in @data
+ */
+void sha256_block_data_order(uint32_t state[8], const uint8_t *data,
+			     unsigned int blocks);
+
 #endif /* _SHA256_H */
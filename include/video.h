@@ -64,6 +64,23 @@ enum video_log2_bpp {
 
 #define VNBITS(bpix)	(1 << (bpix))
 
+/**
+ * struct video_rect - A rectangle of the frame buffer, in pixels
+ *
+ * The rectangle is empty if @xend is not greater than @xstart.
+ *
+ * @xstart:	Left-most column
+ * @ystart:	Top row
+ * @xend:	Column after the right-most one
+ * @yend:	Row after the bottom one
+ */
+struct video_rect {
+	int xstart;
+	int ystart;
+	int xend;
+	int yend;
+};
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
@@ -88,6 +105,8 @@ enum video_log2_bpp {
  * @cmap:	Colour map for 8-bit-per-pixel displays
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
+ * @damage:	Region of the frame buffer changed since the last sync, if
+ *		CONFIG_VIDEO_DAMAGE is enabled
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -112,6 +131,7 @@ struct video_priv {
 	ushort *cmap;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+	struct video_rect damage;
 };
 
 /**
@@ -121,9 +141,16 @@ struct video_priv {
  *		For these devices implement video_sync hook to call a sync
  *		function. vid is pointer to video device udevice. Function
  *		should return 0 on success video_sync and error code otherwise
+ * @sync_rect: Synchronize part of the FB with the device. If this is
+ *		provided and CONFIG_VIDEO_DAMAGE is enabled, it is used instead
+ *		of video_sync, with the region changed since the last sync.
+ *		It is not called if nothing has changed. The driver may send
+ *		more than @rect if that suits the hardware. Returns 0 on
+ *		success or an error code otherwise
  */
 struct video_ops {
 	int (*video_sync)(struct udevice *vid);
+	int (*sync_rect)(struct udevice *vid, const struct video_rect *rect);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -253,6 +280,27 @@ static inline int video_sync_copy(struct udevice *dev, void *from, void *to)
 }
 #endif
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * video_damage() - Record that part of the frame buffer has changed
+ *
+ * The region is added to those which the next video_sync() sends to the
+ * display. It is clipped to the display, so callers need not do this.
+ *
+ * @vid: Video device being updated
+ * @x: Left-most column changed, in pixels
+ * @y: Top row changed, in pixels
+ * @width: Number of columns changed
+ * @height: Number of rows changed
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
 #ifndef CONFIG_DM_VIDEO
 
 /* Video functions */
@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Jobs for a secondary CPU core
+ *
+ * U-Boot runs on the boot CPU only. On SoCs with more than one core, the
+ * worker facility brings up a second core into a loop which runs jobs
+ * queued by the boot CPU, so that long computations such as hashing an
+ * image can run while the boot CPU carries on loading.
+ *
+ * Jobs run concurrently with the rest of U-Boot, so they must only do
+ * plain computation on memory: no console output, no drivers, no timers,
+ * no malloc() and no watchdog servicing.
+ */
+
+#ifndef __WORKER_H
+#define __WORKER_H
+
+#include <linux/errno.h>
+#include <linux/types.h>
+
+/**
+ * struct worker_job - a job for the secondary core
+ *
+ * @func:	Function to run on the secondary core
+ * @arg:	Argument to pass to @func
+ * @done:	Set by the secondary core when @func has returned
+ */
+struct worker_job {
+	void (*func)(void *arg);
+	void *arg;
+	volatile bool done;
+};
+
+#if CONFIG_IS_ENABLED(WORKER)
+
+/**
+ * worker_init() - start the secondary core if it is not running yet
+ *
+ * This is called by worker_queue() as needed, but may be called early to
+ * avoid the start-up latency when the first job is queued.
+ *
+ * @return 0 if OK, -ve on error
+ */
+int worker_init(void);
+
+/**
+ * worker_stop() - stop the secondary core
+ *
+ * This waits for the queued jobs to finish and then puts the secondary core
+ * back into the state it was in at reset. It must be called before an OS
+ * is started, since the core runs U-Boot code from memory which the OS
+ * takes over. A later worker_queue() starts the core again.
+ */
+void worker_stop(void);
+
+/**
+ * worker_queue() - queue a job for the secondary core
+ *
+ * The job structure must stay valid until worker_wait() has returned or
+ * worker_done() returns true.
+ *
+ * @job:	Job to set up and queue
+ * @func:	Function to run on the secondary core
+ * @arg:	Argument to pass to @func
+ * @return 0 if OK, -EBUSY if the queue is full, other -ve value if the
+ *	secondary core could not be started
+ */
+int worker_queue(struct worker_job *job, void (*func)(void *arg), void *arg);
+
+/**
+ * worker_done() - check whether a queued job has finished
+ *
+ * @job:	Job passed to worker_queue()
+ * @return true if the job has finished and its results may be used
+ */
+bool worker_done(struct worker_job *job);
+
+/**
+ * worker_wait() - wait for a queued job to finish
+ *
+ * @job:	Job passed to worker_queue()
+ */
+void worker_wait(struct worker_job *job);
+
+/**
+ * worker_main() - job loop of the secondary core
+ *
+ * This is the entry point passed to arch_worker_start(). It returns once
+ * worker_stop() asks it to, after which arch_worker_stop() takes the core
+ * down.
+ */
+void worker_main(void);
+
+/* Architecture hooks */
+
+/**
+ * arch_worker_start() - start the secondary core
+ *
+ * @entry:	Function the secondary core should call once it can run C
+ *		code. It is called with global_data set up as on the boot CPU.
+ * @return 0 if OK, -ve on error
+ */
+int arch_worker_start(void (*entry)(void));
+
+/**
+ * arch_worker_stop() - stop the secondary core
+ *
+ * This is called on the boot CPU once the entry function passed to
+ * arch_worker_start() is returning. The core must be stopped when it
+ * returns, even if this fails.
+ *
+ * @return 0 if OK, -ve on error
+ */
+int arch_worker_stop(void);
+
+/**
+ * arch_worker_idle() - wait for an event from the other core
+ *
+ * This may return spuriously, callers check their condition again.
+ */
+void arch_worker_idle(void);
+
+/**
+ * arch_worker_kick() - wake the other core up from arch_worker_idle()
+ */
+void arch_worker_kick(void);
+
+#else
+
+static inline int worker_init(void)
+{
+	return -ENOSYS;
+}
+
+static inline void worker_stop(void)
+{
+}
+
+static inline int worker_queue(struct worker_job *job,
+			       void (*func)(void *arg), void *arg)
+{
+	return -ENOSYS;
+}
+
+static inline bool worker_done(struct worker_job *job)
+{
+	return true;
+}
+
+static inline void worker_wait(struct worker_job *job)
+{
+}
+
+#endif /* WORKER */
+
+#endif /* __WORKER_H */
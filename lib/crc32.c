@@ -169,6 +169,35 @@ const uint32_t * ZEXPORT get_crc_table()
 }
 #endif
 
+#if !defined(USE_HOSTCC) && defined(CONFIG_CRC32_SLICE_BY_8) && \
+	__BYTE_ORDER == __LITTLE_ENDIAN
+#define CRC32_SLICE_BY_8
+
+/*
+ * crc_slice_table[k - 1][n] is the CRC of byte n followed by k zero bytes, so
+ * that the CRC of eight bytes can be looked up one table per byte.
+ */
+static int __efi_runtime_data crc_slice_table_empty = 1;
+static uint32_t __efi_runtime_data crc_slice_table[7][256];
+
+static void __efi_runtime make_crc_slice_table(void)
+{
+  const uint32_t *prev = crc_table;
+  int n, k;
+
+#ifdef CONFIG_DYNAMIC_CRC_TABLE
+  if (crc_table_empty)
+    make_crc_table();
+#endif
+  for (k = 0; k < 7; k++) {
+    for (n = 0; n < 256; n++)
+      crc_slice_table[k][n] = crc_table[prev[n] & 255] ^ (prev[n] >> 8);
+    prev = crc_slice_table[k];
+  }
+  crc_slice_table_empty = 0;
+}
+#endif
+
 /* ========================================================================= */
 # if __BYTE_ORDER == __LITTLE_ENDIAN
 #  define DO_CRC(x) crc = tab[(crc ^ (x)) & 255] ^ (crc >> 8)
@@ -202,6 +231,23 @@ uint32_t __efi_runtime crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 
     rem_len = len & 3;
     len = len >> 2;
+#ifdef CRC32_SLICE_BY_8
+    if (len >= 2 && crc_slice_table_empty)
+      make_crc_slice_table();
+    for (; len >= 2; len -= 2) {
+	 uint32_t one = *b++ ^ crc;
+	 uint32_t two = *b++;
+
+	 crc = crc_slice_table[6][one & 255] ^
+	       crc_slice_table[5][(one >> 8) & 255] ^
+	       crc_slice_table[4][(one >> 16) & 255] ^
+	       crc_slice_table[3][one >> 24] ^
+	       crc_slice_table[2][two & 255] ^
+	       crc_slice_table[1][(two >> 8) & 255] ^
+	       crc_slice_table[0][(two >> 16) & 255] ^
+	       tab[two >> 24];
+    }
+#endif
     for (--b; len; --len) {
 	 /* load data 32 bits wide, xor data 32 bits wide. */
 	 crc ^= *++b; /* use pre increment for speed */
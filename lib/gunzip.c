@@ -82,6 +82,66 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	return zunzip(dst, dstlen, src, lenp, 1, offset);
 }
 
+int gunzip_stream(void *dst, ulong dstlen,
+		  long (*read)(void *priv, void **bufp, ulong len), void *priv,
+		  void *buf, ulong bufsz, ulong *lenp)
+{
+	z_stream s;
+	void *in;
+	long len;
+	int r;
+
+	*lenp = 0;
+	memset(&s, '\0', sizeof(s));
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+
+	/* Let zlib check the gzip header and trailer, including the CRC */
+	r = inflateInit2(&s, 16 + MAX_WBITS);
+	if (r != Z_OK) {
+		printf("Error: inflateInit2() returned %d\n", r);
+		return -EINVAL;
+	}
+	s.next_out = dst;
+	s.avail_out = min(dstlen, (ulong)UINT_MAX);
+
+	do {
+		in = buf;
+		len = read(priv, &in, bufsz);
+		if (len < 0) {
+			r = len;
+			break;
+		}
+		if (!len) {
+			puts("Error: gunzip out of data\n");
+			r = -EIO;
+			break;
+		}
+		s.next_in = in;
+		s.avail_in = len;
+
+		do {
+			r = inflate(&s, Z_NO_FLUSH);
+		} while (r == Z_OK && s.avail_in);
+		if (r == Z_BUF_ERROR && s.avail_in) {
+			puts("Error: gunzip output buffer too small\n");
+			r = -ENOSPC;
+		} else if (r == Z_OK || r == Z_BUF_ERROR) {
+			/* Input used up, read on */
+			r = Z_OK;
+		} else if (r != Z_STREAM_END) {
+			printf("Error: inflate() returned %d\n", r);
+			r = -EIO;
+		}
+		WATCHDOG_RESET();
+	} while (r == Z_OK);
+
+	*lenp = s.next_out - (unsigned char *)dst;
+	inflateEnd(&s);
+
+	return r == Z_STREAM_END ? 0 : r;
+}
+
 #ifdef CONFIG_CMD_UNZIP
 __weak
 void gzwrite_progress_init(u64 expectedsize)
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler
+ *
+ * The architecture raises a periodic interrupt and passes the interrupted
+ * address to profile_sample(), which keeps the latest samples in a ring
+ * buffer. Unlike function tracing this needs no compiler instrumentation,
+ * so the image being profiled is the one which ships.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <profile.h>
+#include <asm/sections.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	PROFILE_SAMPLES	= CONFIG_PROFILE_SAMPLES,
+};
+
+static struct profile_state {
+	u32 *buf;		/* Ring buffer of PROFILE_SAMPLES offsets */
+	ulong taken;		/* Samples taken since the start */
+	uint rate;
+	bool running;
+} prof;
+
+/* Convert an address to an offset from the start of U-Boot's text */
+static u32 profile_pc_to_offset(ulong pc)
+{
+#ifdef CONFIG_SANDBOX
+	return pc - (ulong)&_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		return pc - gd->relocaddr;
+
+	return pc - CONFIG_SYS_TEXT_BASE;
+#endif
+}
+
+void profile_sample(ulong pc)
+{
+	if (!prof.running)
+		return;
+
+	prof.buf[prof.taken % PROFILE_SAMPLES] = profile_pc_to_offset(pc);
+	prof.taken++;
+}
+
+int profile_start(uint rate)
+{
+	int ret;
+
+	if (prof.running)
+		return -EBUSY;
+	if (!prof.buf) {
+		prof.buf = malloc(PROFILE_SAMPLES * sizeof(*prof.buf));
+		if (!prof.buf)
+			return -ENOMEM;
+	}
+
+	prof.taken = 0;
+	prof.rate = rate;
+	prof.running = true;
+	ret = arch_profile_start(rate);
+	if (ret) {
+		prof.running = false;
+		return log_msg_ret("arch", ret);
+	}
+
+	return 0;
+}
+
+void profile_stop(void)
+{
+	if (!prof.running)
+		return;
+
+	arch_profile_stop();
+	prof.running = false;
+}
+
+void profile_show(void)
+{
+	ulong count = min(prof.taken, (ulong)PROFILE_SAMPLES);
+
+	if (prof.running)
+		printf("Sampling at %u Hz\n", prof.rate);
+	else
+		printf("Stopped\n");
+	printf("%lu samples, %lu lost, room for %u\n", count,
+	       prof.taken - count, PROFILE_SAMPLES);
+}
+
+int profile_dump(void *buf, int size)
+{
+	struct profile_hdr *hdr = buf;
+	u32 *out = (u32 *)(hdr + 1);
+	ulong count, first, i;
+
+	if (prof.running)
+		return -EBUSY;
+	if (size < sizeof(*hdr))
+		return -ENOSPC;
+
+	/* Keep the latest samples if they do not all fit */
+	count = min(prof.taken, (ulong)PROFILE_SAMPLES);
+	count = min(count, (ulong)(size - sizeof(*hdr)) / sizeof(*out));
+	first = prof.taken - count;
+	for (i = 0; i < count; i++)
+		out[i] = prof.buf[(first + i) % PROFILE_SAMPLES];
+
+	hdr->magic = PROFILE_MAGIC;
+	hdr->version = PROFILE_VERSION;
+	hdr->rate = prof.rate;
+	hdr->count = count;
+	hdr->lost = first;
+
+	return sizeof(*hdr) + count * sizeof(*out);
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Resources built into U-Boot
+ *
+ * Resources are kept compressed, which makes U-Boot smaller and so quicker
+ * to load, and only those which are used are decompressed. There is no
+ * lasting lmb reservation to put them in, since lmb is set up again by each
+ * user, but memory from malloc() is inside the region which lmb always
+ * reserves for U-Boot itself.
+ */
+
+#include <common.h>
+#include <gzip.h>
+#include <log.h>
+#include <malloc.h>
+#include <resource.h>
+#include <asm/unaligned.h>
+
+static struct resource_blob *resource_find(const char *name)
+{
+	struct resource_blob *start =
+		ll_entry_start(struct resource_blob, resource);
+	const int count = ll_entry_count(struct resource_blob, resource);
+	struct resource_blob *res;
+
+	for (res = start; res != start + count; res++) {
+		if (!strcmp(name, res->name))
+			return res;
+	}
+
+	return NULL;
+}
+
+int resource_get(const char *name, void **datap, ulong *sizep)
+{
+	struct resource_blob *res;
+	ulong len, size;
+	void *data;
+
+	res = resource_find(name);
+	if (!res)
+		return -ENOENT;
+
+	if (!res->data) {
+		len = res->end - res->start;
+		if (len < 4)
+			return log_msg_ret("len", -EIO);
+
+		/* gzip ends with the size of the uncompressed data */
+		size = get_unaligned_le32(res->end - 4);
+		data = malloc(size);
+		if (!data)
+			return log_msg_ret("mem", -ENOMEM);
+		if (gunzip(data, size, (uchar *)res->start, &len)) {
+			free(data);
+			return log_msg_ret("gz", -EIO);
+		}
+		res->data = data;
+		res->size = len;
+		log_debug("Resource '%s': %lu bytes from %lu\n", name, len,
+			  (ulong)(res->end - res->start));
+	}
+	*datap = res->data;
+	*sizep = res->size;
+
+	return 0;
+}
@@ -31,6 +31,55 @@
 #  define PUP(a) *++(a)
 #endif
 
+/*
+   Matches within the output are copied a chunk at a time: 16 bytes with NEON,
+   whose byte-element loads and stores may be unaligned even when alignment
+   checking is on, or 8 bytes with unaligned word accesses otherwise.
+ */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#  define INFLATE_CHUNK 16
+#  define CHUNK_COPY(d, s) vst1q_u8(d, vld1q_u8(s))
+#else
+#  define INFLATE_CHUNK 8
+#  define CHUNK_COPY(d, s) put_unaligned(get_unaligned((u64 *)(s)), (u64 *)(d))
+#endif
+
+/*
+   Copy a match of len bytes starting dist bytes back from out, which points
+   to the next byte to write, and return the new output position. A chunk
+   must not overlap its own source, so shorter distances are first widened
+   to a multiple of dist that is at least a chunk: copying the bytes in
+   between one at a time makes the output periodic over the wider distance.
+ */
+local inline unsigned char FAR *inflate_copy(unsigned char FAR *out,
+                                              unsigned dist, unsigned len)
+{
+    unsigned char FAR *from = out - dist;
+    unsigned wide, n;
+
+    if (dist < INFLATE_CHUNK) {
+        wide = dist;
+        while (wide < INFLATE_CHUNK)
+            wide += dist;
+        n = wide - dist < len ? wide - dist : len;
+        len -= n;
+        while (n--)
+            *out++ = *from++;
+        from = out - wide;
+    }
+    while (len >= INFLATE_CHUNK) {
+        CHUNK_COPY(out, from);
+        out += INFLATE_CHUNK;
+        from += INFLATE_CHUNK;
+        len -= INFLATE_CHUNK;
+    }
+    while (len--)
+        *out++ = *from++;
+
+    return out;
+}
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -252,48 +301,8 @@ void inflate_fast(z_streamp strm, unsigned start)
                             PUP(out) = PUP(from);
                     }
                 }
-                else {
-		    unsigned short *sout;
-		    unsigned long loops;
-
-                    from = out - dist;          /* copy direct from output */
-                    /* minimum length is three */
-		    /* Align out addr */
-		    if (!((long)(out - 1 + OFF) & 1)) {
-			PUP(out) = PUP(from);
-			len--;
-		    }
-		    sout = (unsigned short *)(out - OFF);
-		    if (dist > 2 ) {
-			unsigned short *sfrom;
-
-			sfrom = (unsigned short *)(from - OFF);
-			loops = len >> 1;
-			do
-			    PUP(sout) = get_unaligned(++sfrom);
-			while (--loops);
-			out = (unsigned char *)sout + OFF;
-			from = (unsigned char *)sfrom + OFF;
-		    } else { /* dist == 1 or dist == 2 */
-			unsigned short pat16;
-
-			pat16 = *(sout-2+2*OFF);
-			if (dist == 1)
-#if defined(__BIG_ENDIAN)
-			    pat16 = (pat16 & 0xff) | ((pat16 & 0xff ) << 8);
-#elif defined(__LITTLE_ENDIAN)
-			    pat16 = (pat16 & 0xff00) | ((pat16 & 0xff00 ) >> 8);
-#else
-#error __BIG_ENDIAN nor __LITTLE_ENDIAN is defined
-#endif
-			loops = len >> 1;
-			do
-			    PUP(sout) = pat16;
-			while (--loops);
-			out = (unsigned char *)sout + OFF;
-		    }
-		    if (len & 1)
-			PUP(out) = PUP(from);
+                else {                          /* copy direct from output */
+                    out = inflate_copy(out + OFF, dist, len) - OFF;
                 }
             }
             else if ((op & 64) == 0) {          /* 2nd level distance code */
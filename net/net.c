@@ -92,6 +92,8 @@
 #include <log.h>
 #include <net.h>
 #include <net/fastboot.h>
+#include <net/sink.h>
+#include <net/tcp.h>
 #include <net/tftp.h>
 #if defined(CONFIG_CMD_PCAP)
 #include <net/pcap.h>
@@ -113,6 +115,7 @@
 #include "nfs.h"
 #include "ping.h"
 #include "rarp.h"
+#include "wget.h"
 #if defined(CONFIG_CMD_WOL)
 #include "wol.h"
 #endif
@@ -418,7 +421,7 @@ int net_loop(enum proto_t protocol)
 		ret = eth_init();
 		if (ret < 0) {
 			eth_halt();
-			return ret;
+			return net_sink_end(ret);
 		}
 	} else {
 		eth_init_state_only();
@@ -442,7 +445,7 @@ restart:
 		/* network not configured */
 		eth_halt();
 		net_set_state(prev_net_state);
-		return -ENODEV;
+		return net_sink_end(-ENODEV);
 
 	case 2:
 		/* network device not configured */
@@ -526,6 +529,11 @@ restart:
 		case WOL:
 			wol_start();
 			break;
+#endif
+#if defined(CONFIG_CMD_WGET)
+		case WGET:
+			wget_start();
+			break;
 #endif
 		default:
 			break;
@@ -662,6 +670,8 @@ restart:
 	}
 
 done:
+	/* Finish writing the file to its sink, if there is one */
+	ret = net_sink_end(ret);
 #ifdef CONFIG_USB_KEYBOARD
 	net_busy_flag = 0;
 #endif
@@ -847,6 +857,14 @@ int net_send_ip_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 				   payload_len);
 		pkt_hdr_size = eth_hdr_size + IP_UDP_HDR_SIZE;
 		break;
+#if defined(CONFIG_PROT_TCP)
+	case IPPROTO_TCP:
+		pkt_hdr_size = eth_hdr_size +
+			net_set_tcp_header(pkt + eth_hdr_size, dest, dport,
+					   sport, payload_len, action,
+					   tcp_seq_num, tcp_ack_num);
+		break;
+#endif
 	default:
 		return -EINVAL;
 	}
@@ -868,8 +886,8 @@ int net_send_ip_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 		arp_request();
 		return 1;	/* waiting */
 	} else {
-		debug_cond(DEBUG_DEV_PKT, "sending UDP to %pI4/%pM\n",
-			   &dest, ether);
+		debug_cond(DEBUG_DEV_PKT, "sending %s to %pI4/%pM\n",
+			   proto == IPPROTO_UDP ? "UDP" : "TCP", &dest, ether);
 		net_send_packet(net_tx_packet, pkt_hdr_size + payload_len);
 		return 0;	/* transmitted */
 	}
@@ -1253,6 +1271,11 @@ void net_process_received_packet(uchar *in_packet, int len)
 		if (ip->ip_p == IPPROTO_ICMP) {
 			receive_icmp(ip, len, src_ip, et);
 			return;
+#if defined(CONFIG_PROT_TCP)
+		} else if (ip->ip_p == IPPROTO_TCP) {
+			tcp_receive((struct ip_tcp_hdr *)ip, len);
+			return;
+#endif
 		} else if (ip->ip_p != IPPROTO_UDP) {	/* Only UDP packets */
 			return;
 		}
@@ -1355,6 +1378,9 @@ static int net_check_prereq(enum proto_t protocol)
 
 #if defined(CONFIG_CMD_NFS)
 	case NFS:
+#endif
+#if defined(CONFIG_CMD_WGET)
+	case WGET:
 #endif
 		/* Fall through */
 	case TFTPGET:
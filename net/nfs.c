@@ -34,6 +34,7 @@
 #include <net.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <net/sink.h>
 #include "nfs.h"
 #include "bootp.h"
 #include <time.h>
@@ -87,6 +88,17 @@ static inline int store_block(uchar *src, unsigned offset, unsigned len)
 	ulong newsize = offset + len;
 #ifdef CONFIG_SYS_DIRECT_FLASH_NFS
 	int i, rc = 0;
+#endif
+
+	/* The blocks are read in order, so they can be written right away */
+	if (net_sink_active()) {
+		if (net_sink_store(offset, src, len) ||
+		    net_sink_commit(newsize))
+			return -1;
+		goto stored;
+	}
+
+#ifdef CONFIG_SYS_DIRECT_FLASH_NFS
 
 	for (i = 0; i < CONFIG_SYS_MAX_FLASH_BANKS; i++) {
 		/* start address in flash? */
@@ -112,6 +124,7 @@ static inline int store_block(uchar *src, unsigned offset, unsigned len)
 		unmap_sysmem(ptr);
 	}
 
+stored:
 	if (net_boot_file_size < (offset + len))
 		net_boot_file_size = newsize;
 	return 0;
@@ -915,7 +928,13 @@ void nfs_start(void)
 		       net_boot_file_expected_size_in_blocks << 9);
 		print_size(net_boot_file_expected_size_in_blocks << 9, "");
 	}
-	printf("\nLoad address: 0x%lx\nLoading: *\b", image_load_addr);
+	if (net_sink_begin()) {
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	if (!net_sink_active())
+		printf("\nLoad address: 0x%lx", image_load_addr);
+	printf("\nLoading: *\b");
 
 	net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
 	net_set_udp_handler(nfs_handler);
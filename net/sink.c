@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Destinations for files received over the network
+ *
+ * The data received by tftp, nfs or wget is staged in a buffer, which may be
+ * filled out of order. Once the data at its start is complete and fills
+ * half of it, that part is written to the sink and the rest moved down.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <net/sink.h>
+
+static struct net_sink *net_sink;
+/* Staging buffer, allocated while a transfer is going on */
+static char *sink_buf;
+/* Offset in the file of the start of sink_buf */
+static ulong sink_base;
+/* Offset in the file of the end of the data staged so far */
+static ulong sink_end;
+
+void net_sink_set(struct net_sink *sink)
+{
+	net_sink_end(-ECANCELED);
+	net_sink = sink;
+}
+
+bool net_sink_is_set(void)
+{
+	return net_sink;
+}
+
+bool net_sink_active(void)
+{
+	return net_sink && sink_buf;
+}
+
+int net_sink_begin(void)
+{
+	if (!net_sink)
+		return 0;
+
+	if (!sink_buf) {
+		sink_buf = malloc_cache_aligned(CONFIG_NET_SINK_BUF_SIZE);
+		if (!sink_buf)
+			return -ENOMEM;
+	}
+	sink_base = 0;
+	sink_end = 0;
+	printf("Writing to %s\n", net_sink->name);
+
+	return net_sink->start ? net_sink->start(net_sink) : 0;
+}
+
+int net_sink_store(ulong offset, const void *src, ulong len)
+{
+	/* Already written, this is a duplicate */
+	if (offset < sink_base)
+		return 0;
+	if (offset + len > sink_base + CONFIG_NET_SINK_BUF_SIZE)
+		return -ENOSPC;
+
+	memcpy(sink_buf + offset - sink_base, src, len);
+	sink_end = max(sink_end, offset + len);
+
+	return 0;
+}
+
+/* Write the data up to @end and move what follows to the buffer start */
+static int net_sink_flush(ulong end, bool last)
+{
+	ulong len = end - sink_base;
+	int ret;
+
+	if (!last)
+		len -= len % net_sink->align;
+	if (!len)
+		return 0;
+
+	ret = net_sink->write(net_sink, sink_base, sink_buf, len);
+	if (ret) {
+		printf("\nWriting to %s failed (err=%d)\n", net_sink->name,
+		       ret);
+		return ret;
+	}
+	memmove(sink_buf, sink_buf + len, sink_end - sink_base - len);
+	sink_base += len;
+
+	return 0;
+}
+
+int net_sink_commit(ulong end)
+{
+	if (!net_sink)
+		return 0;
+	if (end - sink_base < CONFIG_NET_SINK_BUF_SIZE / 2)
+		return 0;
+
+	return net_sink_flush(end, false);
+}
+
+int net_sink_end(int ret)
+{
+	int err;
+
+	/* The sink is for one transfer, even if that never got started */
+	if (!sink_buf) {
+		net_sink = NULL;
+		return ret;
+	}
+
+	if (ret >= 0) {
+		err = net_sink_flush(sink_end, true);
+		if (!err && net_sink->finish)
+			err = net_sink->finish(net_sink, sink_end);
+		if (err)
+			ret = err;
+	}
+	if (ret < 0 && net_sink->abort)
+		net_sink->abort(net_sink);
+
+	free(sink_buf);
+	sink_buf = NULL;
+	net_sink = NULL;
+
+	return ret;
+}
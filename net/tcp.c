@@ -0,0 +1,360 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Minimal TCP client
+ *
+ * There is a single connection, which mostly receives data. The receiver
+ * hands each byte to the protocol as soon as it arrives in order, so the
+ * whole receive window is advertised all the time. Segments which arrive
+ * out of order are dropped and the last byte received in order is
+ * acknowledged again, which makes the peer send the missing data again.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <net.h>
+#include <time.h>
+#include <net/tcp.h>
+#include <linux/kernel.h>
+#include <linux/log2.h>
+
+/* How often the timeout handler runs, in ms */
+#define TCP_TICK_MS	10
+/* Time without news from the peer before sending again, in ms */
+#define TCP_RTO_MS	1000
+/* Number of times a segment is sent again before giving up */
+#define TCP_RETRIES	10
+
+/* Window scale which makes CONFIG_TCP_RX_WINDOW fit into 16 bits */
+#define TCP_WSCALE	(CONFIG_TCP_RX_WINDOW > 0xffff ? \
+			 ilog2(CONFIG_TCP_RX_WINDOW >> 16) + 1 : 0)
+
+#define TCP_OPT_END	0
+#define TCP_OPT_NOP	1
+#define TCP_OPT_MSS	2
+#define TCP_OPT_WSCALE	3
+/* Size of the options sent with a SYN */
+#define TCP_SYN_OPT_SIZE	8
+
+enum tcp_state {
+	TCP_CLOSED,
+	TCP_SYN_SENT,
+	TCP_ESTABLISHED,
+};
+
+static enum tcp_state tcp_state;
+static struct in_addr tcp_remote_ip;
+static int tcp_remote_port;
+static int tcp_our_port;
+/* Oldest sequence number sent and not acknowledged yet */
+static u32 tcp_snd_una;
+/* Next sequence number to send */
+static u32 tcp_snd_nxt;
+/* Sequence number of the first byte of the received stream */
+static u32 tcp_rcv_start;
+/* Next sequence number expected from the peer */
+static u32 tcp_rcv_nxt;
+/* Window scale used, 0 unless the peer supports it */
+static int tcp_wscale;
+/* Number of segments received and not acknowledged yet */
+static int tcp_ack_pending;
+/* Last time something was received from the peer */
+static ulong tcp_activity;
+static int tcp_retries;
+static tcp_rx_handler *tcp_rx;
+static tcp_event_handler *tcp_event;
+/* Data sent and not acknowledged yet */
+static uchar tcp_tx_buf[TCP_MSS];
+static unsigned int tcp_tx_len;
+
+static uint tcp_checksum(struct ip_tcp_hdr *ip, unsigned int tcp_len)
+{
+	struct {
+		struct in_addr src;
+		struct in_addr dst;
+		u8 zero;
+		u8 proto;
+		u16 len;
+	} pseudo;
+
+	net_copy_ip(&pseudo.src, &ip->ip_src);
+	net_copy_ip(&pseudo.dst, &ip->ip_dst);
+	pseudo.zero = 0;
+	pseudo.proto = IPPROTO_TCP;
+	pseudo.len = htons(tcp_len);
+
+	return add_ip_checksums(sizeof(pseudo),
+				compute_ip_checksum(&pseudo, sizeof(pseudo)),
+				compute_ip_checksum((uchar *)ip + IP_HDR_SIZE,
+						    tcp_len));
+}
+
+int net_set_tcp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
+		       int payload_len, u8 flags, u32 seq, u32 ack)
+{
+	struct ip_tcp_hdr *ip = (struct ip_tcp_hdr *)pkt;
+	uchar *opt = pkt + IP_TCP_HDR_SIZE;
+	int hdr_len = IP_TCP_HDR_SIZE;
+	uint win;
+
+	if (flags & TCP_SYN) {
+		/* The window in a SYN is never scaled */
+		win = min(CONFIG_TCP_RX_WINDOW, 0xffff);
+		*opt++ = TCP_OPT_MSS;
+		*opt++ = 4;
+		*opt++ = TCP_MSS >> 8;
+		*opt++ = TCP_MSS & 0xff;
+		*opt++ = TCP_OPT_NOP;
+		*opt++ = TCP_OPT_WSCALE;
+		*opt++ = 3;
+		*opt++ = TCP_WSCALE;
+		hdr_len += TCP_SYN_OPT_SIZE;
+	} else {
+		win = min(CONFIG_TCP_RX_WINDOW >> tcp_wscale, 0xffff);
+	}
+
+	net_set_ip_header(pkt, dest, net_ip, hdr_len + payload_len,
+			  IPPROTO_TCP);
+
+	ip->tcp_src = htons(sport);
+	ip->tcp_dst = htons(dport);
+	ip->tcp_seq = htonl(seq);
+	ip->tcp_ack = htonl(ack);
+	ip->tcp_hlen = (hdr_len - IP_HDR_SIZE) / 4 << 4;
+	ip->tcp_flags = flags;
+	ip->tcp_win = htons(win);
+	ip->tcp_xsum = 0;
+	ip->tcp_urg = 0;
+	ip->tcp_xsum = tcp_checksum(ip, hdr_len - IP_HDR_SIZE + payload_len);
+
+	return hdr_len;
+}
+
+static void tcp_send_segment(u8 flags, u32 seq, const void *data,
+			     unsigned int len)
+{
+	uchar *pkt = net_tx_packet + net_eth_hdr_size() + IP_TCP_HDR_SIZE;
+
+	if (len)
+		memcpy(pkt, data, len);
+	net_send_ip_packet(net_server_ethaddr, tcp_remote_ip, tcp_remote_port,
+			   tcp_our_port, len, IPPROTO_TCP, flags, seq,
+			   tcp_rcv_nxt);
+	if (flags & TCP_ACK)
+		tcp_ack_pending = 0;
+}
+
+static void tcp_send_ack(void)
+{
+	tcp_send_segment(TCP_ACK, tcp_snd_nxt, NULL, 0);
+}
+
+/* Drop the connection and tell the protocol why */
+static void tcp_finish(enum tcp_event event)
+{
+	tcp_state = TCP_CLOSED;
+	net_set_timeout_handler(0, NULL);
+	tcp_event(event);
+}
+
+static void tcp_timeout_handler(void)
+{
+	if (tcp_ack_pending)
+		tcp_send_ack();
+
+	if (get_timer(tcp_activity) >= TCP_RTO_MS) {
+		if (++tcp_retries > TCP_RETRIES) {
+			tcp_finish(TCP_EV_TIMEOUT);
+			return;
+		}
+		tcp_activity = get_timer(0);
+		if (tcp_state == TCP_SYN_SENT)
+			tcp_send_segment(TCP_SYN, tcp_snd_una, NULL, 0);
+		else if (tcp_tx_len)
+			tcp_send_segment(TCP_ACK | TCP_PUSH, tcp_snd_una,
+					 tcp_tx_buf, tcp_tx_len);
+		else
+			tcp_send_ack();
+	}
+
+	net_set_timeout_handler(TCP_TICK_MS, tcp_timeout_handler);
+}
+
+void tcp_connect(struct in_addr dest, int port, tcp_rx_handler *rx,
+		 tcp_event_handler *event)
+{
+	tcp_remote_ip = dest;
+	tcp_remote_port = port;
+	tcp_our_port = 1024 + (get_timer(0) % 3072);
+	tcp_rx = rx;
+	tcp_event = event;
+	tcp_snd_una = (u32)get_ticks();
+	tcp_snd_nxt = tcp_snd_una + 1;
+	tcp_rcv_nxt = 0;
+	tcp_wscale = 0;
+	tcp_ack_pending = 0;
+	tcp_tx_len = 0;
+	tcp_retries = 0;
+	tcp_activity = get_timer(0);
+	tcp_state = TCP_SYN_SENT;
+
+	memset(net_server_ethaddr, 0, 6);
+	net_set_timeout_handler(TCP_TICK_MS, tcp_timeout_handler);
+	tcp_send_segment(TCP_SYN, tcp_snd_una, NULL, 0);
+}
+
+int tcp_send(const void *data, unsigned int len)
+{
+	if (tcp_state != TCP_ESTABLISHED)
+		return -ENOTCONN;
+	if (tcp_tx_len)
+		return -EBUSY;
+	if (len > TCP_MSS)
+		return -EMSGSIZE;
+
+	memcpy(tcp_tx_buf, data, len);
+	tcp_tx_len = len;
+	tcp_send_segment(TCP_ACK | TCP_PUSH, tcp_snd_nxt, tcp_tx_buf, len);
+	tcp_snd_nxt += len;
+
+	return 0;
+}
+
+void tcp_close(void)
+{
+	if (tcp_state == TCP_ESTABLISHED)
+		tcp_send_segment(TCP_FIN | TCP_ACK, tcp_snd_nxt, NULL, 0);
+	tcp_state = TCP_CLOSED;
+	net_set_timeout_handler(0, NULL);
+}
+
+/* Only the window scale of the peer matters, the MSS is for the sender */
+static bool tcp_peer_wscale(const uchar *opt, int len)
+{
+	while (len > 0 && *opt != TCP_OPT_END) {
+		if (*opt == TCP_OPT_NOP) {
+			opt++;
+			len--;
+			continue;
+		}
+		if (len < 2 || opt[1] < 2 || opt[1] > len)
+			break;
+		if (*opt == TCP_OPT_WSCALE)
+			return true;
+		len -= opt[1];
+		opt += opt[1];
+	}
+
+	return false;
+}
+
+void tcp_receive(struct ip_tcp_hdr *ip, int len)
+{
+	unsigned int tcp_len = len - IP_HDR_SIZE;
+	unsigned int hlen, data_len;
+	const uchar *data;
+	u32 seq, ack;
+	ulong offset;
+	uint sum;
+	s32 diff;
+	u8 flags;
+
+	if (len < IP_TCP_HDR_SIZE || tcp_state == TCP_CLOSED)
+		return;
+	if (net_read_ip(&ip->ip_src).s_addr != tcp_remote_ip.s_addr ||
+	    ntohs(ip->tcp_src) != tcp_remote_port ||
+	    ntohs(ip->tcp_dst) != tcp_our_port)
+		return;
+
+	hlen = (ip->tcp_hlen >> 4) * 4;
+	if (hlen < TCP_HDR_SIZE || hlen > tcp_len)
+		return;
+	sum = tcp_checksum(ip, tcp_len);
+	if (sum && sum != 0xffff) {
+		debug("TCP checksum bad\n");
+		return;
+	}
+
+	seq = ntohl(ip->tcp_seq);
+	ack = ntohl(ip->tcp_ack);
+	flags = ip->tcp_flags;
+	data = (uchar *)ip + IP_HDR_SIZE + hlen;
+	data_len = tcp_len - hlen;
+
+	if (tcp_state == TCP_SYN_SENT) {
+		if (!(flags & TCP_ACK) || ack != tcp_snd_nxt)
+			return;
+		if (flags & TCP_RST) {
+			tcp_finish(TCP_EV_RESET);
+			return;
+		}
+		if (!(flags & TCP_SYN))
+			return;
+
+		if (tcp_peer_wscale((uchar *)ip + IP_TCP_HDR_SIZE,
+				    hlen - TCP_HDR_SIZE))
+			tcp_wscale = TCP_WSCALE;
+		tcp_rcv_start = seq + 1;
+		tcp_rcv_nxt = tcp_rcv_start;
+		tcp_snd_una = ack;
+		tcp_retries = 0;
+		tcp_activity = get_timer(0);
+		tcp_state = TCP_ESTABLISHED;
+		tcp_send_ack();
+		tcp_event(TCP_EV_CONNECTED);
+		return;
+	}
+
+	/* A reset is only believed if it is exactly where it is expected */
+	if (flags & TCP_RST) {
+		if (seq == tcp_rcv_nxt)
+			tcp_finish(TCP_EV_RESET);
+		return;
+	}
+
+	tcp_retries = 0;
+	tcp_activity = get_timer(0);
+	if ((flags & TCP_ACK) && (s32)(ack - tcp_snd_una) > 0 &&
+	    (s32)(ack - tcp_snd_nxt) <= 0) {
+		tcp_snd_una = ack;
+		if (tcp_snd_una == tcp_snd_nxt)
+			tcp_tx_len = 0;
+	}
+
+	diff = tcp_rcv_nxt - seq;
+	if (diff < 0) {
+		/* Something was lost, ask for it again */
+		tcp_send_ack();
+		return;
+	}
+	if (diff > 0) {
+		/* The peer did not get an ACK, keep the new part only */
+		if ((u32)diff >= data_len + !!(flags & TCP_FIN)) {
+			if (data_len || (flags & (TCP_SYN | TCP_FIN)))
+				tcp_send_ack();
+			return;
+		}
+		data += diff;
+		data_len -= diff;
+	}
+
+	if (data_len) {
+		offset = tcp_rcv_nxt - tcp_rcv_start;
+		tcp_rcv_nxt += data_len;
+		tcp_ack_pending++;
+		tcp_rx(data, data_len, offset);
+		/* The protocol may have closed the connection */
+		if (tcp_state != TCP_ESTABLISHED)
+			return;
+	}
+
+	if (flags & TCP_FIN) {
+		tcp_rcv_nxt++;
+		tcp_send_segment(TCP_FIN | TCP_ACK, tcp_snd_nxt, NULL, 0);
+		tcp_finish(TCP_EV_CLOSED);
+		return;
+	}
+
+	/* Acknowledge every other segment, and the end of each burst */
+	if (tcp_ack_pending >= 2 || (tcp_ack_pending && (flags & TCP_PUSH)))
+		tcp_send_ack();
+}
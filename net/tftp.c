@@ -14,7 +14,9 @@
 #include <log.h>
 #include <mapmem.h>
 #include <net.h>
+#include <net/sink.h>
 #include <net/tftp.h>
+#include <linux/bitmap.h>
 #include "bootp.h"
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
 #include <flash.h>
@@ -45,6 +47,13 @@ DECLARE_GLOBAL_DATA_PTR;
 #define TFTP_ERROR	5
 #define TFTP_OACK	6
 
+/* Number of blocks which can be received ahead of a missing one */
+#define TFTP_OOO_BLOCKS		128
+/* Blocks received after a gap before the missing one is requested again */
+#define TFTP_REORDER_BLOCKS	3
+/* Halve the window if more than one window in this many saw loss */
+#define TFTP_LOSS_WINDOWS	16
+
 static ulong timeout_ms = TIMEOUT;
 static int timeout_count_max = TIMEOUT_COUNT;
 static ulong time_start;   /* Record time we started tftp */
@@ -103,6 +112,20 @@ static ushort	tftp_windowsize;
 static ushort	tftp_next_ack;
 /* Last nack block we send */
 static ushort	tftp_last_nack;
+/* Blocks received ahead of tftp_cur_block, by absolute number */
+static DECLARE_BITMAP(tftp_ooo_map, TFTP_OOO_BLOCKS);
+/* Number of blocks in tftp_ooo_map */
+static uint	tftp_ooo_count;
+/* Absolute number of the final block, 0 if not received yet */
+static ulong	tftp_final_block;
+/* Duplicate blocks received since the last new one */
+static uint	tftp_dup_count;
+/* Retransmit requests and timeouts during this transfer */
+static uint	tftp_loss_count;
+/* Window size to request, adapted to the loss seen by earlier transfers */
+static ushort	tftp_window_adapt;
+/* Window size option tftp_window_adapt was started from */
+static ushort	tftp_window_max;
 #ifdef CONFIG_CMD_TFTPPUT
 /* 1 if writing, else 0 */
 static int	tftp_put_active;
@@ -157,14 +180,25 @@ static unsigned short tftp_block_size = TFTP_BLOCK_SIZE;
 static unsigned short tftp_block_size_option = CONFIG_TFTP_BLOCKSIZE;
 static unsigned short tftp_window_size_option = TFTP_WINDOWSIZE;
 
-static inline int store_block(int block, uchar *src, unsigned int len)
+/* Store a block given its absolute number, counting wraparounds */
+static inline int store_block(ulong block, uchar *src, unsigned int len)
 {
-	ulong offset = block * tftp_block_size + tftp_block_wrap_offset -
-			tftp_block_size;
+	ulong offset = (block - 1) * tftp_block_size;
 	ulong newsize = offset + len;
 	ulong store_addr = tftp_load_addr + offset;
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
 	int i, rc = 0;
+#endif
+
+	if (net_sink_active()) {
+		int ret = net_sink_store(offset, src, len);
+
+		if (ret)
+			return ret;
+		goto stored;
+	}
+
+#ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
 
 	for (i = 0; i < CONFIG_SYS_MAX_FLASH_BANKS; i++) {
 		/* start address in flash? */
@@ -205,6 +239,7 @@ static inline int store_block(int block, uchar *src, unsigned int len)
 		unmap_sysmem(ptr);
 	}
 
+stored:
 	if (net_boot_file_size < newsize)
 		net_boot_file_size = newsize;
 
@@ -217,6 +252,11 @@ static void new_transfer(void)
 	tftp_prev_block = 0;
 	tftp_block_wrap = 0;
 	tftp_block_wrap_offset = 0;
+	bitmap_zero(tftp_ooo_map, TFTP_OOO_BLOCKS);
+	tftp_ooo_count = 0;
+	tftp_final_block = 0;
+	tftp_dup_count = 0;
+	tftp_loss_count = 0;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_final_block_sent = 0;
 #endif
@@ -310,9 +350,68 @@ static void update_block_number(void)
 	show_block_marker();
 }
 
+/* Absolute number of the current block, counting wraparounds */
+static ulong tftp_abs_block(void)
+{
+	return tftp_block_wrap * TFTP_SEQUENCE_SIZE + tftp_cur_block;
+}
+
+/*
+ * Move past the blocks which were received ahead of the current one
+ *
+ * @return number of blocks skipped
+ */
+static uint tftp_advance_buffered(void)
+{
+	uint count = 0;
+
+	while (tftp_ooo_count &&
+	       __test_and_clear_bit((tftp_abs_block() + 1) % TFTP_OOO_BLOCKS,
+				    tftp_ooo_map)) {
+		tftp_ooo_count--;
+		tftp_cur_block = (tftp_cur_block + 1) % TFTP_SEQUENCE_SIZE;
+		update_block_number();
+		tftp_prev_block = tftp_cur_block;
+		count++;
+	}
+
+	return count;
+}
+
+/* Acknowledge the current block, the server starts a new window after it */
+static void tftp_send_ack(void)
+{
+	tftp_send();
+	tftp_next_ack = (ushort)(tftp_cur_block + tftp_windowsize);
+}
+
+/*
+ * Adapt the window size requested by the next transfer to the loss seen by
+ * this one: double it up to the configured size after a transfer without
+ * loss and halve it when loss hit more than one window in
+ * TFTP_LOSS_WINDOWS.
+ */
+static void tftp_adapt_window(void)
+{
+	ulong windows;
+
+	if (tftp_put_active)
+		return;
+
+	windows = tftp_abs_block() / max_t(ushort, tftp_windowsize, 1) + 1;
+	if (!tftp_loss_count)
+		tftp_window_adapt = min_t(uint, tftp_window_adapt * 2,
+					  tftp_window_max);
+	else if (tftp_loss_count * TFTP_LOSS_WINDOWS > windows)
+		tftp_window_adapt = max_t(ushort, tftp_window_adapt / 2, 1);
+	debug("TFTP: %u losses in %lu windows, next window size %d\n",
+	      tftp_loss_count, windows, tftp_window_adapt);
+}
+
 /* The TFTP get or put is complete */
 static void tftp_complete(void)
 {
+	tftp_adapt_window();
 #ifdef CONFIG_TFTP_TSIZE
 	/* Print hash marks for the last packet received */
 	while (tftp_tsize && tftp_tsize_num_hash < 49) {
@@ -379,9 +478,9 @@ static void tftp_send(void)
 		 * Implemented only for tftp get.
 		 * Don't bother sending if it's 1
 		 */
-		if (tftp_state == STATE_SEND_RRQ && tftp_window_size_option > 1)
+		if (tftp_state == STATE_SEND_RRQ && tftp_window_adapt > 1)
 			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
-					0, tftp_window_size_option, 0);
+					0, tftp_window_adapt, 0);
 		len = pkt - xp;
 		break;
 
@@ -465,6 +564,69 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/*
+ * Handle a data block which is not the next one expected
+ *
+ * Blocks up to TFTP_OOO_BLOCKS ahead are stored right away, so that only
+ * the missing ones have to be received again. Once TFTP_REORDER_BLOCKS
+ * arrived after a gap, the missing block is taken as lost and requested
+ * again by acknowledging the current block, once for each block.
+ *
+ * Older blocks are duplicates, which are expected after the remote was asked
+ * to start a new window. Only a full window of them means that the remote
+ * did not get our acknowledgement.
+ *
+ * @return 0 if OK, -ve if the block could not be stored
+ */
+static int tftp_data_unexpected(ushort block, uchar *src, unsigned len)
+{
+	ushort ahead = block - (ushort)tftp_cur_block;
+	ulong abs_block;
+	int ret;
+
+	if ((short)ahead <= 0) {
+		if (++tftp_dup_count >= tftp_windowsize) {
+			tftp_dup_count = 0;
+			tftp_send_ack();
+		}
+		return 0;
+	} else if (tftp_state == STATE_DATA && ahead <= TFTP_OOO_BLOCKS) {
+		abs_block = tftp_abs_block() + ahead;
+		if (!__test_and_set_bit(abs_block % TFTP_OOO_BLOCKS,
+					tftp_ooo_map)) {
+			ret = store_block(abs_block, src, len);
+			if (ret == -ENOSPC) {
+				/* No room to stage it yet, it is sent again */
+				__test_and_clear_bit(abs_block % TFTP_OOO_BLOCKS,
+						     tftp_ooo_map);
+			} else if (ret) {
+				return ret;
+			} else {
+				if (len < tftp_block_size)
+					tftp_final_block = abs_block;
+				tftp_ooo_count++;
+			}
+		}
+		/* A block which was reordered should show up soon */
+		if (tftp_ooo_count < TFTP_REORDER_BLOCKS && !tftp_final_block)
+			return 0;
+	}
+
+	/*
+	 * If one packet is dropped most likely
+	 * all other buffers in the window
+	 * that will arrive will cause a sending NACK.
+	 * This just overwellms the server, let's just send one.
+	 */
+	if (tftp_last_nack != tftp_cur_block) {
+		tftp_send_ack();
+		tftp_last_nack = tftp_cur_block;
+		tftp_loss_count++;
+	}
+
+	return 0;
+}
+
 static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 unsigned src, unsigned len)
 {
@@ -472,6 +634,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	__be16 *s;
 	int i;
 	u16 timeout_val_rcvd;
+	uint skipped;
 
 	if (dest != tftp_our_port) {
 			return;
@@ -606,17 +769,10 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			debug("Received unexpected block: %d, expected: %d\n",
 			      ntohs(*(__be16 *)pkt),
 			      (ushort)(tftp_cur_block + 1));
-			/*
-			 * If one packet is dropped most likely
-			 * all other buffers in the window
-			 * that will arrive will cause a sending NACK.
-			 * This just overwellms the server, let's just send one.
-			 */
-			if (tftp_last_nack != tftp_cur_block) {
-				tftp_send();
-				tftp_last_nack = tftp_cur_block;
-				tftp_next_ack = (ushort)(tftp_cur_block +
-							 tftp_windowsize);
+			if (tftp_data_unexpected(ntohs(*(__be16 *)pkt), pkt + 2,
+						 len)) {
+				eth_halt();
+				net_set_state(NETLOOP_FAIL);
 			}
 			break;
 		}
@@ -654,25 +810,41 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		timeout_count_max = tftp_timeout_count_max;
 		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 
-		if (store_block(tftp_cur_block, pkt + 2, len)) {
+		if (store_block(tftp_abs_block(), pkt + 2, len)) {
 			eth_halt();
 			net_set_state(NETLOOP_FAIL);
 			break;
 		}
+		if (len < tftp_block_size)
+			tftp_final_block = tftp_abs_block();
 
 		/*
-		 *	Acknowledge the block just received, which will prompt
-		 *	the remote for the next one.
+		 * If this block was missing, skip the blocks received after
+		 * it and let the remote continue from there rather than
+		 * sending them again.
 		 */
-		if (tftp_cur_block == tftp_next_ack) {
-			tftp_send();
-			tftp_next_ack += tftp_windowsize;
+		skipped = tftp_advance_buffered();
+		tftp_dup_count = 0;
+		if (net_sink_active() &&
+		    net_sink_commit(min(tftp_abs_block() * tftp_block_size,
+					(ulong)net_boot_file_size))) {
+			eth_halt();
+			net_set_state(NETLOOP_FAIL);
+			break;
 		}
 
-		if (len < tftp_block_size) {
+		if (tftp_final_block == tftp_abs_block()) {
 			tftp_send();
 			tftp_complete();
+			break;
 		}
+
+		/*
+		 *	Acknowledge the block just received, which will prompt
+		 *	the remote for the next one.
+		 */
+		if (skipped || tftp_cur_block == tftp_next_ack)
+			tftp_send_ack();
 		break;
 
 	case TFTP_ERROR:
@@ -704,12 +876,17 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 static void tftp_timeout_handler(void)
 {
 	if (++timeout_count > timeout_count_max) {
+		tftp_adapt_window();
 		restart("Retry count exceeded");
 	} else {
 		puts("T ");
 		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
-		if (tftp_state != STATE_RECV_WRQ)
+		if (tftp_state == STATE_DATA && !tftp_put_active) {
+			tftp_loss_count++;
+			tftp_send_ack();
+		} else if (tftp_state != STATE_RECV_WRQ) {
 			tftp_send();
+		}
 	}
 }
 
@@ -771,8 +948,14 @@ void tftp_start(enum proto_t protocol)
 	}
 #endif
 
+	/* Start adapting again from a new window size */
+	if (tftp_window_size_option != tftp_window_max) {
+		tftp_window_max = tftp_window_size_option;
+		tftp_window_adapt = tftp_window_size_option;
+	}
+
 	debug("TFTP blocksize = %i, TFTP windowsize = %d timeout = %ld ms\n",
-	      tftp_block_size_option, tftp_window_size_option, timeout_ms);
+	      tftp_block_size_option, tftp_window_adapt, timeout_ms);
 
 	tftp_remote_ip = net_server_ip;
 	if (!net_parse_bootfile(&tftp_remote_ip, tftp_filename, MAX_LEN)) {
@@ -838,7 +1021,13 @@ void tftp_start(enum proto_t protocol)
 			puts("trying to overwrite reserved memory...\n");
 			return;
 		}
-		printf("Load address: 0x%lx\n", tftp_load_addr);
+		if (net_sink_begin()) {
+			eth_halt();
+			net_set_state(NETLOOP_FAIL);
+			return;
+		}
+		if (!net_sink_active())
+			printf("Load address: 0x%lx\n", tftp_load_addr);
 		puts("Loading: *\b");
 		tftp_state = STATE_SEND_RRQ;
 #ifdef CONFIG_CMD_BOOTEFI
@@ -893,9 +1082,15 @@ void tftp_start_server(void)
 		puts("\nTFTP error: trying to overwrite reserved memory...\n");
 		return;
 	}
+	if (net_sink_begin()) {
+		eth_halt();
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
 	printf("Using %s device\n", eth_get_name());
 	printf("Listening for TFTP transfer on %pI4\n", &net_ip);
-	printf("Load address: 0x%lx\n", tftp_load_addr);
+	if (!net_sink_active())
+		printf("Load address: 0x%lx\n", tftp_load_addr);
 
 	puts("Loading: *\b");
 
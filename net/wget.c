@@ -0,0 +1,314 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Download a file over HTTP
+ *
+ * A single HTTP/1.1 GET request is sent over TCP and the body of the
+ * response is stored at the load address, or passed on to the network
+ * sink, as it arrives.
+ */
+
+#include <common.h>
+#include <display_options.h>
+#include <env.h>
+#include <image.h>
+#include <lmb.h>
+#include <log.h>
+#include <mapmem.h>
+#include <net.h>
+#include <net/sink.h>
+#include <net/tcp.h>
+#include <linux/ctype.h>
+#include "wget.h"
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define WGET_PORT		80
+/* Largest response header accepted */
+#define WGET_HDR_SIZE		2048
+/* Bytes received per hash mark */
+#define WGET_HASH_SIZE		(64 << 10)
+#define HASHES_PER_LINE		65
+
+enum wget_state {
+	WGET_CONNECTING,
+	WGET_HEADER,
+	WGET_BODY,
+	WGET_DONE,
+};
+
+static enum wget_state wget_state;
+static struct in_addr wget_server_ip;
+static int wget_port;
+static char wget_path[1024];
+static char wget_hdr[WGET_HDR_SIZE + 1];
+static unsigned int wget_hdr_len;
+/* Offset of the body in the stream received */
+static ulong wget_body_start;
+/* Size of the body, ULONG_MAX if the server did not send it */
+static ulong wget_content_length;
+static ulong wget_load_addr;
+static ulong wget_load_size;
+static ulong wget_hashes;
+static ulong wget_time_start;
+
+static void wget_fail(const char *msg)
+{
+	printf("\nwget: %s\n", msg);
+	tcp_close();
+	wget_state = WGET_DONE;
+	net_set_state(NETLOOP_FAIL);
+}
+
+static void wget_complete(void)
+{
+	ulong time = get_timer(wget_time_start);
+
+	tcp_close();
+	wget_state = WGET_DONE;
+	if (time > 0) {
+		puts("\n\t ");	/* Line up with "Loading: " */
+		print_size(net_boot_file_size / time * 1000, "/s");
+	}
+	puts("\ndone\n");
+	net_set_state(NETLOOP_SUCCESS);
+}
+
+static int wget_store(const uchar *src, unsigned int len, ulong offset)
+{
+	void *ptr;
+
+	if (net_sink_active()) {
+		/* The data arrives in order, so it can be written right away */
+		if (net_sink_store(offset, src, len) ||
+		    net_sink_commit(offset + len))
+			return -EIO;
+	} else {
+		if (wget_load_size && offset + len > wget_load_size) {
+			puts("\nwget: trying to overwrite reserved memory...\n");
+			return -ENOSPC;
+		}
+		ptr = map_sysmem(wget_load_addr + offset, len);
+		memcpy(ptr, src, len);
+		unmap_sysmem(ptr);
+	}
+	net_boot_file_size = offset + len;
+
+	while (wget_hashes < net_boot_file_size / WGET_HASH_SIZE) {
+		putc('#');
+		if (!(++wget_hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+	}
+
+	return 0;
+}
+
+/* Find a header line and return its value, or NULL if it is not there */
+static const char *wget_find_header(const char *name)
+{
+	const char *line = strstr(wget_hdr, "\r\n");
+	int len = strlen(name);
+
+	while (line && strncmp(line, "\r\n\r\n", 4)) {
+		line += 2;
+		if (!strncasecmp(line, name, len) && line[len] == ':') {
+			line += len + 1;
+			while (*line == ' ' || *line == '\t')
+				line++;
+			return line;
+		}
+		line = strstr(line, "\r\n");
+	}
+
+	return NULL;
+}
+
+/* Check the response header once it is complete */
+static int wget_parse_header(void)
+{
+	const char *val;
+	int status;
+
+	if (strncmp(wget_hdr, "HTTP/1.", 7) || !wget_hdr[7] ||
+	    wget_hdr[8] != ' ') {
+		wget_fail("invalid response");
+		return -EPROTO;
+	}
+	status = simple_strtoul(wget_hdr + 9, NULL, 10);
+	if (status != 200) {
+		*strchr(wget_hdr, '\r') = '\0';
+		printf("\nwget: server replied '%s'\n", wget_hdr);
+		wget_fail("download failed");
+		return -ENOENT;
+	}
+
+	val = wget_find_header("Transfer-Encoding");
+	if (val && strncasecmp(val, "identity", 8)) {
+		wget_fail("chunked transfers are not supported");
+		return -EPROTO;
+	}
+
+	wget_content_length = ULONG_MAX;
+	val = wget_find_header("Content-Length");
+	if (val && isdigit(*val)) {
+		wget_content_length = simple_strtoul(val, NULL, 10);
+		printf(" Size is 0x%lx Bytes = ", wget_content_length);
+		print_size(wget_content_length, "");
+	}
+	if (!net_sink_active() && wget_load_size &&
+	    wget_content_length != ULONG_MAX &&
+	    wget_content_length > wget_load_size) {
+		wget_fail("file does not fit into free memory");
+		return -ENOSPC;
+	}
+	printf("\nLoading: ");
+
+	return 0;
+}
+
+static void wget_rx(const uchar *data, unsigned int len, ulong offset)
+{
+	unsigned int copy;
+	char *end;
+
+	if (wget_state == WGET_HEADER) {
+		copy = min(len, WGET_HDR_SIZE - wget_hdr_len);
+		memcpy(wget_hdr + wget_hdr_len, data, copy);
+		wget_hdr[wget_hdr_len + copy] = '\0';
+		end = strstr(wget_hdr, "\r\n\r\n");
+		if (!end) {
+			wget_hdr_len += copy;
+			if (wget_hdr_len == WGET_HDR_SIZE)
+				wget_fail("response header too long");
+			return;
+		}
+
+		/* Whatever follows the header in this segment is body */
+		wget_body_start = end + 4 - wget_hdr;
+		if (wget_parse_header())
+			return;
+		wget_state = WGET_BODY;
+		copy = wget_body_start - wget_hdr_len;
+		data += copy;
+		len -= copy;
+		offset += copy;
+		wget_hdr_len = wget_body_start;
+		if (!wget_content_length) {
+			wget_complete();
+			return;
+		}
+	}
+
+	if (wget_state != WGET_BODY || !len)
+		return;
+
+	offset -= wget_body_start;
+	if (offset + len > wget_content_length)
+		len = wget_content_length - offset;
+	if (wget_store(data, len, offset)) {
+		wget_fail("storing the file failed");
+		return;
+	}
+	if (net_boot_file_size == wget_content_length)
+		wget_complete();
+}
+
+static void wget_event(enum tcp_event event)
+{
+	char req[TCP_MSS + 1];
+	int len;
+
+	switch (event) {
+	case TCP_EV_CONNECTED:
+		len = snprintf(req, sizeof(req),
+			       "GET %s HTTP/1.1\r\n"
+			       "Host: %pI4\r\n"
+			       "User-Agent: U-Boot\r\n"
+			       "Connection: close\r\n"
+			       "\r\n", wget_path, &wget_server_ip);
+		if (len >= sizeof(req) || tcp_send(req, len)) {
+			wget_fail("path too long");
+			return;
+		}
+		wget_state = WGET_HEADER;
+		break;
+	case TCP_EV_CLOSED:
+		/* Without a Content-Length, the end of the file is the FIN */
+		if (wget_state == WGET_BODY &&
+		    (wget_content_length == ULONG_MAX ||
+		     net_boot_file_size == wget_content_length))
+			wget_complete();
+		else
+			wget_fail("connection closed by the server");
+		break;
+	case TCP_EV_RESET:
+		wget_fail(wget_state == WGET_CONNECTING ?
+			  "connection refused" : "connection reset");
+		break;
+	case TCP_EV_TIMEOUT:
+		wget_fail("server not responding");
+		break;
+	}
+}
+
+/* Initialize wget_load_addr and wget_load_size from image_load_addr and lmb */
+static int wget_init_load_addr(void)
+{
+#ifdef CONFIG_LMB
+	struct lmb lmb;
+	phys_size_t max_size;
+
+	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+
+	max_size = lmb_get_free_size(&lmb, image_load_addr);
+	if (!max_size)
+		return -1;
+
+	wget_load_size = max_size;
+#endif
+	wget_load_addr = image_load_addr;
+	return 0;
+}
+
+void wget_start(void)
+{
+	char *path = wget_path;
+
+	wget_server_ip = net_server_ip;
+	/* The path sent must be absolute */
+	*path++ = '/';
+	if (!net_parse_bootfile(&wget_server_ip, path, sizeof(wget_path) - 1)) {
+		puts("*** ERROR: no file to download given\n");
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	if (*path == '/')
+		memmove(wget_path, path, strlen(path) + 1);
+	wget_port = env_get_ulong("httpdstp", 10, WGET_PORT);
+
+	printf("Using %s device\n", eth_get_name());
+	printf("HTTP from server %pI4:%d; our IP address is %pI4\n",
+	       &wget_server_ip, wget_port, &net_ip);
+	printf("Filename '%s'.", wget_path);
+
+	wget_load_size = 0;
+	if (net_sink_begin()) {
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	if (!net_sink_active()) {
+		if (wget_init_load_addr()) {
+			puts("\nwget error: trying to overwrite reserved memory...\n");
+			net_set_state(NETLOOP_FAIL);
+			return;
+		}
+		printf("\nLoad address: 0x%lx", wget_load_addr);
+	}
+
+	wget_state = WGET_CONNECTING;
+	wget_hdr_len = 0;
+	wget_hashes = 0;
+	wget_time_start = get_timer(0);
+	net_boot_file_size = 0;
+
+	tcp_connect(wget_server_ip, wget_port, wget_rx, wget_event);
+}
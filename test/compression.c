@@ -12,6 +12,7 @@
 #include <lz4.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <u-boot/crc.h>
 #include <asm/io.h>
 
 #include <u-boot/zlib.h>
@@ -157,6 +158,49 @@ static int uncompress_using_gzip(struct unit_test_state *uts,
 	return ret;
 }
 
+struct stream_state {
+	const char *in;
+	unsigned long left;
+	int count;
+};
+
+/*
+ * Hand out the compressed data in small pieces. Every other piece is left
+ * where it is, as with a buffer which was read ahead into.
+ */
+static long read_stream(void *priv, void **bufp, ulong len)
+{
+	struct stream_state *state = priv;
+
+	len = min(len, state->left);
+	if (state->count++ & 1)
+		*bufp = (void *)state->in;
+	else
+		memcpy(*bufp, state->in, len);
+	state->in += len;
+	state->left -= len;
+
+	return len;
+}
+
+static int uncompress_using_gzip_stream(struct unit_test_state *uts,
+					void *in, unsigned long in_size,
+					void *out, unsigned long out_max,
+					unsigned long *out_size)
+{
+	struct stream_state state = { in, in_size };
+	unsigned long size;
+	char buf[7];
+	int ret;
+
+	ret = gunzip_stream(out, out_max, read_stream, &state, buf,
+			    sizeof(buf), &size);
+	if (out_size)
+		*out_size = size;
+
+	return ret;
+}
+
 static int compress_using_bzip2(struct unit_test_state *uts,
 				void *in, unsigned long in_size,
 				void *out, unsigned long out_max,
@@ -414,6 +458,111 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_gzip, 0);
 
+static int compression_test_gzip_stream(struct unit_test_state *uts)
+{
+	return run_test(uts, "gzip_stream", compress_using_gzip,
+			uncompress_using_gzip_stream);
+}
+COMPRESSION_TEST(compression_test_gzip_stream, 0);
+
+/*
+ * Build data made of runs repeating with every period from 1 to 40 bytes, so
+ * that inflate copies matches at all distances the chunked copy handles
+ * specially, with and without overlap
+ */
+static void fill_periodic(unsigned char *buf, ulong size)
+{
+	uint seed = 0x12345678;
+	uint period = 1;
+	ulong i, j;
+
+	for (i = 0; i < size;) {
+		for (j = 0; j < period && i < size; j++, i++) {
+			seed = seed * 1103515245 + 12345;
+			buf[i] = seed >> 16;
+		}
+		for (j = 0; j < 300 && i < size; j++, i++)
+			buf[i] = buf[i - period];
+		period = period % 40 + 1;
+	}
+}
+
+static int compression_test_gzip_matches(struct unit_test_state *uts)
+{
+	const ulong size = 64 << 10;
+	unsigned char *orig, *comp, *uncomp;
+	ulong comp_size = size, uncomp_size = size;
+
+	orig = malloc(size);
+	comp = malloc(size);
+	uncomp = malloc(size + 1);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(uncomp);
+
+	fill_periodic(orig, size);
+	ut_assertok(gzip(comp, &comp_size, orig, size));
+	ut_assert(comp_size < size / 4);
+
+	uncomp[size] = 'A';
+	ut_assertok(gunzip(uncomp, size, comp, &uncomp_size));
+	ut_asserteq(size, uncomp_size);
+	ut_asserteq_mem(orig, uncomp, size);
+	ut_asserteq('A', uncomp[size]);
+
+	free(uncomp);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_matches, 0);
+
+/* Bit-at-a-time CRC32 to check the table-driven versions against */
+static uint32_t crc32_ref(uint32_t crc, const unsigned char *p, ulong len)
+{
+	int k;
+
+	crc = ~crc;
+	while (len--) {
+		crc ^= *p++;
+		for (k = 0; k < 8; k++)
+			crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+	}
+
+	return ~crc;
+}
+
+static int compression_test_crc32(struct unit_test_state *uts)
+{
+	const ulong size = 4096;
+	unsigned char *buf;
+	ulong offset, len;
+
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	fill_periodic(buf, size);
+
+	/* All alignments and lengths around the 4- and 8-byte loops */
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len < 40; len++) {
+			ut_asserteq(crc32_ref(0, buf + offset, len),
+				    crc32(0, buf + offset, len));
+		}
+	}
+	ut_asserteq(crc32_ref(0, buf, size), crc32(0, buf, size));
+
+	/* Continuing a CRC gives the same result */
+	ut_asserteq(crc32(0, buf, size),
+		    crc32(crc32(0, buf, 1001), buf + 1001, size - 1001));
+	ut_asserteq(0xcbf43926, crc32(0, (unsigned char *)"123456789", 9));
+
+	free(buf);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_crc32, 0);
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
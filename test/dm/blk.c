@@ -4,10 +4,13 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <dm.h>
+#include <malloc.h>
 #include <part.h>
 #include <usb.h>
 #include <asm/state.h>
+#include <linux/sizes.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -164,3 +167,50 @@ static int dm_test_blk_get_from_parent(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_blk_get_from_parent, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_BOOTSTAGE
+/* Test that the block I/O done during a bootstage span is counted */
+static int dm_test_blk_bootstage(struct unit_test_state *uts)
+{
+	struct bootstage_span span;
+	struct blk_desc *desc;
+	char buf[1024], *trace, *rec;
+	int i, len;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &desc));
+	ut_asserteq(2, blk_dread(desc, 0, 2, buf));
+
+	/*
+	 * Add more spans than the table holds, as a long session of commands
+	 * does. They must leave room for marks and not stop new spans.
+	 */
+	for (i = 0; i < CONFIG_BOOTSTAGE_RECORD_COUNT; i++) {
+		bootstage_span_start(&span);
+		bootstage_span_end(&span, "blk filler");
+	}
+	ut_assert(bootstage_get_rec_count() < CONFIG_BOOTSTAGE_RECORD_COUNT);
+
+	bootstage_span_start(&span);
+	ut_asserteq(2, blk_dwrite(desc, 0, 2, buf));
+	ut_asserteq(2, blk_dread(desc, 0, 2, buf));
+	bootstage_span_end(&span, "blk test");
+
+	trace = malloc(SZ_64K);
+	ut_assertnonnull(trace);
+	len = bootstage_trace_json(trace, SZ_64K - 1);
+	ut_assert(len > 0);
+	trace[len] = '\0';
+
+	rec = strstr(trace, "{\"name\":\"blk test\",\"ph\":\"X\"");
+	ut_assertnonnull(rec);
+	/* The read may have been extended by read-ahead */
+	rec = strstr(rec, "\"read\":");
+	ut_assertnonnull(rec);
+	ut_assert(simple_strtoul(rec + 7, &rec, 10) >= 1024);
+	ut_assert(!strncmp(rec, ",\"written\":1024}", 16));
+	free(trace);
+
+	return 0;
+}
+DM_TEST(dm_test_blk_bootstage, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
@@ -37,6 +37,43 @@ static int dm_test_dma_m2m(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_dma_m2m, UT_TESTF_SCAN_FDT);
 
+static int dm_test_dma_async(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	u8 src_buf[512];
+	u8 dst_buf[512];
+	size_t len = 512;
+	int i;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_DMA, "dma", &dev));
+
+	memset(dst_buf, 0, len);
+	for (i = 0; i < len; i++)
+		src_buf[i] = i;
+
+	ut_assertok(dma_transfer_async(dev, DMA_MEM_TO_MEM, dst_buf, src_buf,
+				       len));
+	ut_asserteq(-EBUSY, dma_transfer_async(dev, DMA_MEM_TO_MEM, dst_buf,
+					       src_buf, len));
+	ut_assertok(dma_wait(dev, 100));
+	ut_asserteq_mem(src_buf, dst_buf, len);
+
+	/* Nothing is in progress now */
+	ut_assertok(dma_poll(dev));
+
+	/* A stopped transfer does not write to the destination */
+	memset(dst_buf, 0, len);
+	ut_assertok(dma_transfer_async(dev, DMA_MEM_TO_MEM, dst_buf, src_buf,
+				       len));
+	ut_assertok(dma_stop(dev));
+	ut_assertok(dma_wait(dev, 100));
+	ut_asserteq(0, dst_buf[1]);
+	ut_assertok(dma_stop(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_dma_async, UT_TESTF_SCAN_FDT);
+
 static int dm_test_dma(struct unit_test_state *uts)
 {
 	struct udevice *dev;
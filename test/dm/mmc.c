@@ -4,6 +4,7 @@
  */
 
 #include <common.h>
+#include <blk.h>
 #include <dm.h>
 #include <mmc.h>
 #include <part.h>
@@ -43,3 +44,187 @@ static int dm_test_mmc_blk(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_mmc_blk, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+static void mmc_test_complete(struct blk_req *req)
+{
+	int *count = req->priv;
+
+	(*count)++;
+}
+
+/* Test asynchronous reads */
+static int dm_test_mmc_blk_async(struct unit_test_state *uts)
+{
+	struct blk_desc *dev_desc;
+	struct blk_req req;
+	char cmp[1024];
+	int count = 0;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	/* Make sure the data really comes from the device */
+	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+
+	memset(cmp, '\0', sizeof(cmp));
+	req.complete = mmc_test_complete;
+	req.priv = &count;
+	ut_assertok(blk_dread_async(dev_desc, 0, 2, cmp, &req));
+	if (IS_ENABLED(CONFIG_BLK_ASYNC)) {
+		ut_asserteq(-EINPROGRESS, blk_poll(&req));
+		ut_asserteq(0, count);
+	}
+	ut_asserteq(2, blk_wait(&req));
+	ut_asserteq(1, count);
+	ut_assertok(strcmp(cmp, "this is a test"));
+
+	/* Polling a finished request does not complete it again */
+	ut_asserteq(2, blk_poll(&req));
+	ut_asserteq(1, count);
+
+	/* Synchronous reads work again */
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(2, blk_dread(dev_desc, 0, 2, cmp));
+	ut_assertok(strcmp(cmp, "this is a test"));
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_blk_async, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test asynchronous writes */
+static int dm_test_mmc_blk_async_write(struct unit_test_state *uts)
+{
+	struct blk_desc *dev_desc;
+	struct blk_req req;
+	char buf[1024];
+	int count = 0;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+
+	memset(buf, 'a', sizeof(buf));
+	req.complete = mmc_test_complete;
+	req.priv = &count;
+	ut_assertok(blk_dwrite_async(dev_desc, 0, 2, buf, &req));
+	if (IS_ENABLED(CONFIG_BLK_ASYNC)) {
+		ut_asserteq(-EINPROGRESS, blk_poll(&req));
+		ut_asserteq(0, count);
+	}
+	ut_asserteq(2, blk_wait(&req));
+	ut_asserteq(1, count);
+
+	/* Synchronous transfers work again */
+	ut_asserteq(2, blk_dwrite(dev_desc, 0, 2, buf));
+	memset(buf, '\0', sizeof(buf));
+	ut_asserteq(2, blk_dread(dev_desc, 0, 2, buf));
+	ut_assertok(strcmp(buf, "this is a test"));
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_blk_async_write, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(BLOCK_CACHE)
+static int mmc_test_cache_stats(struct blk_desc *dev_desc,
+				struct block_cache_stats *stats)
+{
+	int i;
+
+	for (i = 0; !blkcache_stats(i, stats); i++) {
+		if (stats->iftype == dev_desc->if_type &&
+		    stats->devnum == dev_desc->devnum)
+			return 0;
+	}
+
+	return -ENOENT;
+}
+
+/* Test that sequential reads are read ahead into the block cache */
+static int dm_test_mmc_blk_readahead(struct unit_test_state *uts)
+{
+	struct block_cache_config config, old;
+	struct block_cache_stats stats;
+	struct blk_desc *dev_desc;
+	char cmp[512];
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	ut_assert(dev_desc->lba > 4);
+	blkcache_get_config(&old);
+	config = old;
+	config.readahead = 2;
+	blkcache_configure(&config);
+	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+
+	/* The first read is not sequential */
+	ut_asserteq(1, blk_dread(dev_desc, 0, 1, cmp));
+	ut_assertok(mmc_test_cache_stats(dev_desc, &stats));
+	ut_asserteq(0, stats.prefetched);
+
+	/*
+	 * The second one is, so blocks 2 and 3 are read with it. The
+	 * sandbox device returns the test string for multiple-block reads
+	 * only.
+	 */
+	memset(cmp, '\0', sizeof(cmp));
+	ut_asserteq(1, blk_dread(dev_desc, 1, 1, cmp));
+	ut_assertok(strcmp(cmp, "this is a test"));
+	ut_assertok(mmc_test_cache_stats(dev_desc, &stats));
+	ut_asserteq(2, stats.prefetched);
+	ut_asserteq(0, stats.prefetch_hits);
+
+	/* Blocks 2 and 3 now come from the cache */
+	ut_asserteq(1, blk_dread(dev_desc, 2, 1, cmp));
+	ut_asserteq(1, blk_dread(dev_desc, 3, 1, cmp));
+	ut_assertok(mmc_test_cache_stats(dev_desc, &stats));
+	ut_asserteq(2, stats.hits);
+	ut_asserteq(0, stats.misses);
+	ut_asserteq(2, stats.prefetch_hits);
+
+	/* Reading block 1 again hits, it is not counted as read ahead */
+	ut_asserteq(1, blk_dread(dev_desc, 1, 1, cmp));
+	ut_assertok(strcmp(cmp, "this is a test"));
+	ut_assertok(mmc_test_cache_stats(dev_desc, &stats));
+	ut_asserteq(1, stats.hits);
+	ut_asserteq(0, stats.prefetch_hits);
+
+	blkcache_configure(&old);
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_blk_readahead, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that small and large reads are cached in lines of their own size */
+static int dm_test_mmc_blk_cache_classes(struct unit_test_state *uts)
+{
+	struct block_cache_config config, old;
+	struct block_cache_stats stats;
+	struct blk_desc *dev_desc;
+	char buf[16 * 512];
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &dev_desc));
+	ut_assert(dev_desc->lba > 24);
+	blkcache_get_config(&old);
+	config = old;
+	config.readahead = 0;
+	blkcache_configure(&config);
+	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+
+	ut_asserteq(1, blk_dread(dev_desc, 0, 1, buf));
+	ut_asserteq(16, blk_dread(dev_desc, 8, 16, buf));
+	ut_assertok(mmc_test_cache_stats(dev_desc, &stats));
+	ut_asserteq(8, stats.cls[0].blocks_per_entry);
+	ut_asserteq(32, stats.cls[1].blocks_per_entry);
+	ut_asserteq(1, stats.cls[0].entries);
+	ut_asserteq(1, stats.cls[1].entries);
+	ut_asserteq(2, stats.misses);
+
+	/* Both come from the cache, a read within the large line too */
+	ut_asserteq(1, blk_dread(dev_desc, 0, 1, buf));
+	ut_asserteq(16, blk_dread(dev_desc, 8, 16, buf));
+	ut_asserteq(2, blk_dread(dev_desc, 12, 2, buf));
+	ut_assertok(mmc_test_cache_stats(dev_desc, &stats));
+	ut_asserteq(3, stats.hits);
+	ut_asserteq(0, stats.misses);
+
+	blkcache_configure(&old);
+
+	return 0;
+}
+DM_TEST(dm_test_mmc_blk_cache_classes, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <bmp_layout.h>
 #include <bzlib.h>
 #include <dm.h>
 #include <log.h>
@@ -13,6 +14,7 @@
 #include <os.h>
 #include <video.h>
 #include <video_console.h>
+#include <asm/unaligned.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <test/test.h>
@@ -164,6 +166,47 @@ static int dm_test_video_chars(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_chars, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/* Test that console output records only the region it changes */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+
+	/* Probing clears and syncs the display, so nothing is left over */
+	ut_asserteq(0, priv->damage.xend);
+
+	vidconsole_putc_xy(con, VID_TO_POS(16), 32, 'a');
+	vidconsole_putc_xy(con, VID_TO_POS(40), 32, 'b');
+	ut_asserteq(16, priv->damage.xstart);
+	ut_asserteq(32, priv->damage.ystart);
+	ut_asserteq(48, priv->damage.xend);
+	ut_asserteq(48, priv->damage.yend);
+
+	ut_assertok(video_sync(dev, false));
+	ut_asserteq(0, priv->damage.xend);
+
+	/* Scrolling touches the rows moved, clipped to the display */
+	vidconsole_move_rows(con, 0, 1, 2);
+	ut_asserteq(0, priv->damage.xstart);
+	ut_asserteq(0, priv->damage.ystart);
+	ut_asserteq(1366, priv->damage.xend);
+	ut_asserteq(32, priv->damage.yend);
+
+	video_damage(dev, 1360, 760, 100, 100);
+	ut_asserteq(1366, priv->damage.xend);
+	ut_asserteq(768, priv->damage.yend);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
+
 #ifdef CONFIG_VIDEO_ANSI
 #define ANSI_ESC "\x1b"
 /* Test handling of ANSI escape sequences */
@@ -335,6 +378,146 @@ static int dm_test_video_bmp_comp(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_bmp_comp, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+/**
+ * write_bmp4() - Write a 4bpp BMP image to memory
+ *
+ * The image is 5 x 2 pixels. The top row uses colours 1, 2, 3, 1, 2 of the
+ * palette (white, red, blue) and the bottom one is all colour 3.
+ *
+ * @addr: Address to write the image to
+ * @compression: BMP_BI_RGB or BMP_BI_RLE4
+ */
+static void write_bmp4(ulong addr, uint compression)
+{
+	static const u8 rgb_data[] = {
+		0x33, 0x33, 0x30, 0x00, 0x12, 0x31, 0x20, 0x00,
+	};
+	static const u8 rle4_data[] = {
+		0x05, 0x33, 0x00, 0x00,				/* bottom */
+		0x00, 0x05, 0x12, 0x31, 0x20, 0x00, 0x00, 0x00,	/* top */
+		0x00, 0x01,
+	};
+	struct bmp_color_table_entry *cte;
+	struct bmp_image *bmp;
+	const u8 *data;
+	int data_offset, size;
+
+	data = compression == BMP_BI_RLE4 ? rle4_data : rgb_data;
+	size = compression == BMP_BI_RLE4 ? sizeof(rle4_data) :
+		sizeof(rgb_data);
+	data_offset = sizeof(struct bmp_header) + 16 * sizeof(*cte);
+
+	bmp = map_sysmem(addr, data_offset + size);
+	memset(bmp, '\0', data_offset);
+	bmp->header.signature[0] = 'B';
+	bmp->header.signature[1] = 'M';
+	put_unaligned_le32(data_offset + size, &bmp->header.file_size);
+	put_unaligned_le32(data_offset, &bmp->header.data_offset);
+	put_unaligned_le32(40, &bmp->header.size);
+	put_unaligned_le32(5, &bmp->header.width);
+	put_unaligned_le32(2, &bmp->header.height);
+	put_unaligned_le16(1, &bmp->header.planes);
+	put_unaligned_le16(4, &bmp->header.bit_count);
+	put_unaligned_le32(compression, &bmp->header.compression);
+
+	cte = bmp->color_table;
+	cte[1].red = 0xff;
+	cte[1].green = 0xff;
+	cte[1].blue = 0xff;
+	cte[2].red = 0xff;
+	cte[3].blue = 0xff;
+	memcpy((void *)bmp + data_offset, data, size);
+	unmap_sysmem(bmp);
+}
+
+/* Check the pixels of the image written by write_bmp4(), drawn at x, y */
+static int check_bmp4(struct unit_test_state *uts, struct udevice *dev,
+		      int x, int y)
+{
+	static const u16 top[] = { 0xffff, 0xf800, 0x001f, 0xffff, 0xf800 };
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	u16 *line;
+	int i;
+
+	line = priv->fb + y * priv->line_length;
+	for (i = 0; i < ARRAY_SIZE(top); i++)
+		ut_asserteq(top[i], line[x + i]);
+	line = priv->fb + (y + 1) * priv->line_length;
+	for (i = 0; i < ARRAY_SIZE(top); i++)
+		ut_asserteq(0x001f, line[x + i]);
+
+	return 0;
+}
+
+/* Test drawing a 4bpp bitmap */
+static int dm_test_video_bmp4(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	write_bmp4(0, BMP_BI_RGB);
+	ut_assertok(video_bmp_display(dev, 0, 10, 20, false));
+	ut_assertok(check_bmp4(uts, dev, 10, 20));
+
+	return 0;
+}
+DM_TEST(dm_test_video_bmp4, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_VIDEO_BMP_RLE4
+/* Test drawing a 4bpp run-length-encoded bitmap */
+static int dm_test_video_bmp_rle4(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	write_bmp4(0, BMP_BI_RLE4);
+	ut_assertok(video_bmp_display(dev, 0, 10, 20, false));
+	ut_assertok(check_bmp4(uts, dev, 10, 20));
+
+	return 0;
+}
+DM_TEST(dm_test_video_bmp_rle4, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
+
+#ifdef CONFIG_VIDEO_BMP_CACHE
+/* Test that a bitmap is drawn again from the cache, unless it changes */
+static int dm_test_video_bmp_cache(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct bmp_image *bmp;
+	struct udevice *dev;
+	u16 *line;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	priv = dev_get_uclass_priv(dev);
+	write_bmp4(0, BMP_BI_RGB);
+	ut_assertok(video_bmp_display(dev, 0, 10, 20, false));
+
+	/* The same image elsewhere on the display comes from the cache */
+	ut_assertok(video_clear(dev));
+	ut_assertok(video_bmp_display(dev, 0, 30, 40, false));
+	ut_assertok(check_bmp4(uts, dev, 30, 40));
+
+	/* Changing the palette must not use the cached image */
+	bmp = map_sysmem(0, 0);
+	bmp->color_table[2].red = 0;
+	bmp->color_table[2].green = 0xff;
+	unmap_sysmem(bmp);
+	ut_assertok(video_bmp_display(dev, 0, 30, 40, false));
+	line = priv->fb + 40 * priv->line_length;
+	ut_asserteq(0x07e0, line[31]);
+
+	/* A file size larger than the image can need is rejected */
+	bmp = map_sysmem(0, 0);
+	put_unaligned_le32(0x7fffffff, &bmp->header.file_size);
+	unmap_sysmem(bmp);
+	ut_asserteq(-EINVAL, video_bmp_display(dev, 0, 30, 40, false));
+
+	return 0;
+}
+DM_TEST(dm_test_video_bmp_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
+
 /* Test TrueType console */
 static int dm_test_video_truetype(struct unit_test_state *uts)
 {
@@ -391,3 +574,29 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_video_truetype_bs, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test that TrueType text drawn from the glyph cache looks the same */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	struct vidconsole_priv *vc_priv;
+	struct udevice *dev, *con;
+	const char *test_string = "Loading kernel... 42%";
+	int size;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	vidconsole_put_string(con, test_string);
+	size = compress_frame_buffer(uts, dev);
+
+	/* Print it again in the same place, with every glyph now cached */
+	ut_assertok(video_clear(dev));
+	vc_priv = dev_get_uclass_priv(con);
+	vc_priv->xcur_frac = vc_priv->xstart_frac;
+	vc_priv->ycur = 0;
+	vc_priv->last_ch = 0;
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(size, compress_frame_buffer(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
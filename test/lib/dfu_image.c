@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for decoding sparse and compressed images written through DFU
+ */
+
+#include <common.h>
+#include <dfu.h>
+#include <malloc.h>
+#include <sparse_format.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <asm/unaligned.h>
+#include <linux/sizes.h>
+
+enum {
+	DFU_TEST_MEDIUM_SIZE	= SZ_2M,
+	DFU_TEST_ERASE_SIZE	= SZ_64K,
+	DFU_TEST_BLK_SZ		= 4096,
+	DFU_TEST_BLKS		= 310,
+	DFU_TEST_RAW_SIZE	= 300000,
+	/* Medium contents which were not written */
+	DFU_TEST_UNTOUCHED	= 0xa5,
+};
+
+/*
+ * The sparse image used by the tests, in blocks of DFU_TEST_BLK_SZ:
+ *
+ *   0 -   1  raw, dfu_test_byte()
+ *   2 -   4  don't care
+ *            CRC32 chunk
+ *   5 -   8  fill 0xdeadbeef
+ *   9 - 308  fill 0, long enough to be erased
+ * 309        raw, dfu_test_byte()
+ */
+enum {
+	DFU_TEST_DONT_CARE	= 2 * DFU_TEST_BLK_SZ,
+	DFU_TEST_FILL		= 5 * DFU_TEST_BLK_SZ,
+	DFU_TEST_ZERO		= 9 * DFU_TEST_BLK_SZ,
+	DFU_TEST_LAST		= 309 * DFU_TEST_BLK_SZ,
+	DFU_TEST_END		= DFU_TEST_BLKS * DFU_TEST_BLK_SZ,
+	DFU_TEST_SPARSE_SIZE	= sizeof(sparse_header_t) +
+				  6 * sizeof(chunk_header_t) + 3 * 4 +
+				  3 * DFU_TEST_BLK_SZ,
+};
+
+struct dfu_test_medium {
+	u8 *data;
+	ulong erased;
+	bool unaligned;
+};
+
+/* gzip -n -9 of the image built by dfu_test_sparse() */
+static const char sparse_gzip[] =
+	"\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\xb3\xfa\xaf\xf6\x96\x91"
+	"\x81\x81\x41\x86\x81\x87\x81\x41\x80\x81\xc1\x0c\xc8\x61\x63\x80"
+	"\x80\x83\xa7\x18\x18\x98\x80\x34\x8f\x02\x90\x60\x64\x62\x66\x61"
+	"\x65\x63\xe7\xe0\xe4\xe2\xe6\xe1\xe5\xe3\x17\x10\x14\x12\x16\x11"
+	"\x15\x13\x97\x90\x94\x92\x96\x91\x95\x93\x57\x50\x54\x52\x56\x51"
+	"\x55\x53\xd7\xd0\xd4\xd2\xd6\xd1\xd5\xd3\x37\x30\x34\x32\x36\x31"
+	"\x35\x33\xb7\xb0\xb4\xb2\xb6\xb1\xb5\xb3\x77\x70\x74\x72\x76\x71"
+	"\x75\x73\xf7\xf0\xf4\xf2\xf6\xf1\xf5\xf3\x0f\x08\x0c\x0a\x0e\x09"
+	"\x0d\x0b\x8f\x88\x8c\x8a\x8e\x89\x8d\x8b\x4f\x48\x4c\x4a\x4e\x49"
+	"\x4d\x4b\xcf\xc8\xcc\xca\xce\xc9\xcd\xcb\x2f\x28\x2c\x2a\x2e\x29"
+	"\x2d\x2b\xaf\xa8\xac\xaa\xae\xa9\xad\xab\x6f\x68\x6c\x6a\x6e\x69"
+	"\x6d\x6b\xef\xe8\xec\xea\xee\xe9\xed\xeb\x9f\x30\x71\xd2\xe4\x29"
+	"\x53\xa7\x4d\x9f\x31\x73\xd6\xec\x39\x73\xe7\xcd\x5f\xb0\x70\xd1"
+	"\xe2\x25\x4b\x97\x2d\x5f\xb1\x72\xd5\xea\x35\x6b\xd7\xad\xdf\xb0"
+	"\x71\xd3\xe6\x2d\x5b\xb7\x6d\xdf\xb1\x73\xd7\xee\x3d\x7b\xf7\xed"
+	"\x3f\x70\xf0\xd0\xe1\x23\x47\x8f\x1d\x3f\x71\xf2\xd4\xe9\x33\x67"
+	"\xcf\x9d\xbf\x70\xf1\xd2\xe5\x2b\x57\xaf\x5d\xbf\x71\xf3\xd6\xed"
+	"\x3b\x77\xef\xdd\x7f\xf0\xf0\xd1\xe3\x27\x4f\x9f\x3d\x7f\xf1\xf2"
+	"\xd5\xeb\x37\x6f\xdf\xbd\xff\xf0\xf1\xd3\xe7\x2f\x5f\xbf\x7d\xff"
+	"\xf1\xf3\xd7\xa8\xd7\x47\xbd\x3e\xea\xf5\x51\xaf\x8f\x7a\x7d\xd4"
+	"\xeb\xa3\x5e\x1f\xf5\xfa\xa8\xd7\x47\xbd\x3e\xea\xf5\x51\xaf\x8f"
+	"\x7a\x7d\xd4\xeb\xa3\x5e\x1f\xf5\xfa\xa8\xd7\x47\xbd\x3e\xea\xf5"
+	"\x51\xaf\x8f\x7a\x7d\xd4\xeb\xa3\x5e\x1f\xf5\xfa\xa8\xd7\x47\xbd"
+	"\x3e\xea\xf5\x51\xaf\x8f\x7a\x7d\xd4\xeb\xc3\xc6\xeb\x87\x4f\x31"
+	"\x30\x30\x83\xd6\x02\x00\xf1\x91\x53\x90\xf5\x01\x02\xd0\x75\x02"
+	"\x87\x80\x7c\x16\x28\xff\xfd\xbe\xb5\xf7\x40\x7c\x1d\x46\x84\x3c"
+	"\x68\x1d\x01\x68\x8d\x01\x0f\x50\x60\x34\xa0\x47\xbd\x3e\xea\xf5"
+	"\x51\xaf\x8f\x7a\x7d\xd4\xeb\xa3\x5e\x1f\xf5\xfa\xa8\xd7\x47\xbd"
+	"\x3e\xea\xf5\x51\xaf\x8f\x7a\x7d\xd4\xeb\xa3\x5e\x1f\xfe\x5e\x07"
+	"\x00\x6a\xec\x01\x3d\x70\x30\x00\x00";
+
+/* zstd -19 of the same image */
+static const char sparse_zstd[] =
+	"\x28\xb5\x2f\xfd\x64\x70\x2f\xe5\x0a\x00\x64\x13\x3a\xff\x26\xed"
+	"\x01\x00\x00\x00\x1c\x00\x0c\x00\x00\x10\x00\x00\x36\x06\x00\xc1"
+	"\xca\x00\x00\x02\x00\x00\x00\x0c\x20\x00\x00\x00\x01\x02\x03\x04"
+	"\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10\x11\x12\x13\x14"
+	"\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f\x20\x21\x22\x23\x24"
+	"\x25\x26\x27\x28\x29\x2a\x2b\x2c\x2d\x2e\x2f\x30\x31\x32\x33\x34"
+	"\x35\x36\x37\x38\x39\x3a\x3b\x3c\x3d\x3e\x3f\x40\x41\x42\x43\x44"
+	"\x45\x46\x47\x48\x49\x4a\x4b\x4c\x4d\x4e\x4f\x50\x51\x52\x53\x54"
+	"\x55\x56\x57\x58\x59\x5a\x5b\x5c\x5d\x5e\x5f\x60\x61\x62\x63\x64"
+	"\x65\x66\x67\x68\x69\x6a\x6b\x6c\x6d\x6e\x6f\x70\x71\x72\x73\x74"
+	"\x75\x76\x77\x78\x79\x7a\x7b\x7c\x7d\x7e\x7f\x80\x81\x82\x83\x84"
+	"\x85\x86\x87\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f\x90\x91\x92\x93\x94"
+	"\x95\x96\x97\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f\xa0\xa1\xa2\xa3\xa4"
+	"\xa5\xa6\xa7\xa8\xa9\xaa\xab\xac\xad\xae\xaf\xb0\xb1\xb2\xb3\xb4"
+	"\xb5\xb6\xb7\xb8\xb9\xba\xbb\xbc\xbd\xbe\xbf\xc0\xc1\xc2\xc3\xc4"
+	"\xc5\xc6\xc7\xc8\xc9\xca\xcb\xcc\xcd\xce\xcf\xd0\xd1\xd2\xd3\xd4"
+	"\xd5\xd6\xd7\xd8\xd9\xda\xdb\xdc\xdd\xde\xdf\xe0\xe1\xe2\xe3\xe4"
+	"\xe5\xe6\xe7\xe8\xe9\xea\xeb\xec\xed\xee\xef\xf0\xf1\xf2\xf3\xf4"
+	"\xf5\xf6\xf7\xf8\xf9\xfa\xc3\xca\x00\x00\x03\x00\x00\x00\x0c\x00"
+	"\x00\x00\xc4\xca\x00\x10\x00\xc2\x04\xef\xbe\xad\xde\x2c\x01\xc1"
+	"\x01\x0c\x0d\x00\xfd\x8f\xfe\xe3\x03\x4d\xe0\x00\xc0\x00\x10\x43"
+	"\x2d\x06\x96\x40\x76\x33\x01\x03\xd3\xba\xab\x3e\x10\x78\xff\xeb"
+	"\xd3\xc5\x70\x00\xe6\x12\xa5\x5e\x14\x8a";
+
+/* zstd -19 of DFU_TEST_RAW_SIZE bytes of dfu_test_byte() */
+static const char raw_zstd[] =
+	"\x28\xb5\x2f\xfd\xa4\xe0\x93\x04\x00\x2c\x08\x00\xb4\x0f\x00\x01"
+	"\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10\x11"
+	"\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f\x20\x21"
+	"\x22\x23\x24\x25\x26\x27\x28\x29\x2a\x2b\x2c\x2d\x2e\x2f\x30\x31"
+	"\x32\x33\x34\x35\x36\x37\x38\x39\x3a\x3b\x3c\x3d\x3e\x3f\x40\x41"
+	"\x42\x43\x44\x45\x46\x47\x48\x49\x4a\x4b\x4c\x4d\x4e\x4f\x50\x51"
+	"\x52\x53\x54\x55\x56\x57\x58\x59\x5a\x5b\x5c\x5d\x5e\x5f\x60\x61"
+	"\x62\x63\x64\x65\x66\x67\x68\x69\x6a\x6b\x6c\x6d\x6e\x6f\x70\x71"
+	"\x72\x73\x74\x75\x76\x77\x78\x79\x7a\x7b\x7c\x7d\x7e\x7f\x80\x81"
+	"\x82\x83\x84\x85\x86\x87\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f\x90\x91"
+	"\x92\x93\x94\x95\x96\x97\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f\xa0\xa1"
+	"\xa2\xa3\xa4\xa5\xa6\xa7\xa8\xa9\xaa\xab\xac\xad\xae\xaf\xb0\xb1"
+	"\xb2\xb3\xb4\xb5\xb6\xb7\xb8\xb9\xba\xbb\xbc\xbd\xbe\xbf\xc0\xc1"
+	"\xc2\xc3\xc4\xc5\xc6\xc7\xc8\xc9\xca\xcb\xcc\xcd\xce\xcf\xd0\xd1"
+	"\xd2\xd3\xd4\xd5\xd6\xd7\xd8\xd9\xda\xdb\xdc\xdd\xde\xdf\xe0\xe1"
+	"\xe2\xe3\xe4\xe5\xe6\xe7\xe8\xe9\xea\xeb\xec\xed\xee\xef\xf0\xf1"
+	"\xf2\xf3\xf4\xf5\xf6\xf7\xf8\xf9\xfa\x01\x00\x7b\x81\x7f\x7f\x6e"
+	"\xa4\x54\x00\x00\x00\x01\x00\xfd\xff\xd1\xff\xb9\x06\x02\x45\x00"
+	"\x00\x00\x01\x00\xdd\x13\x1d\x00\x01\xbb\x9e\x4f\x3a";
+
+static u8 dfu_test_byte(ulong offset)
+{
+	return offset % 251;
+}
+
+static int dfu_test_get_medium_size(struct dfu_entity *dfu, u64 *size)
+{
+	*size = DFU_TEST_MEDIUM_SIZE;
+
+	return 0;
+}
+
+static int dfu_test_write_medium(struct dfu_entity *dfu, u64 offset,
+				 void *buf, long *len)
+{
+	struct dfu_test_medium *medium = dfu->dev_private;
+
+	if (offset + *len > DFU_TEST_MEDIUM_SIZE)
+		return -EINVAL;
+	if (offset % SZ_512)
+		medium->unaligned = true;
+	memcpy(medium->data + offset, buf, *len);
+
+	return 0;
+}
+
+static int dfu_test_erase_medium(struct dfu_entity *dfu, u64 offset, u64 len)
+{
+	struct dfu_test_medium *medium = dfu->dev_private;
+
+	if (offset % DFU_TEST_ERASE_SIZE || len % DFU_TEST_ERASE_SIZE ||
+	    offset + len > DFU_TEST_MEDIUM_SIZE)
+		return -EINVAL;
+	memset(medium->data + offset, '\0', len);
+	medium->erased += len;
+
+	return 0;
+}
+
+static u8 *dfu_test_chunk(u8 *p, u16 type, u32 blks, u32 data_sz)
+{
+	chunk_header_t *chunk = (chunk_header_t *)p;
+
+	chunk->chunk_type = cpu_to_le16(type);
+	chunk->reserved1 = 0;
+	chunk->chunk_sz = cpu_to_le32(blks);
+	chunk->total_sz = cpu_to_le32(sizeof(*chunk) + data_sz);
+
+	return p + sizeof(*chunk);
+}
+
+static u8 *dfu_test_raw(u8 *p, ulong offset, ulong len)
+{
+	ulong i;
+
+	for (i = 0; i < len; i++)
+		*p++ = dfu_test_byte(offset + i);
+
+	return p;
+}
+
+/* Build the sparse image described above in @buf */
+static void dfu_test_sparse(u8 *buf)
+{
+	sparse_header_t *hdr = (sparse_header_t *)buf;
+	u8 *p = buf + sizeof(*hdr);
+
+	memset(hdr, '\0', sizeof(*hdr));
+	hdr->magic = cpu_to_le32(SPARSE_HEADER_MAGIC);
+	hdr->major_version = cpu_to_le16(1);
+	hdr->file_hdr_sz = cpu_to_le16(sizeof(sparse_header_t));
+	hdr->chunk_hdr_sz = cpu_to_le16(sizeof(chunk_header_t));
+	hdr->blk_sz = cpu_to_le32(DFU_TEST_BLK_SZ);
+	hdr->total_blks = cpu_to_le32(DFU_TEST_BLKS);
+	hdr->total_chunks = cpu_to_le32(6);
+
+	p = dfu_test_chunk(p, CHUNK_TYPE_RAW, 2, 2 * DFU_TEST_BLK_SZ);
+	p = dfu_test_raw(p, 0, 2 * DFU_TEST_BLK_SZ);
+	p = dfu_test_chunk(p, CHUNK_TYPE_DONT_CARE, 3, 0);
+	p = dfu_test_chunk(p, CHUNK_TYPE_CRC32, 0, 4);
+	put_unaligned_le32(0, p);
+	p += 4;
+	p = dfu_test_chunk(p, CHUNK_TYPE_FILL, 4, 4);
+	put_unaligned_le32(0xdeadbeef, p);
+	p += 4;
+	p = dfu_test_chunk(p, CHUNK_TYPE_FILL, 300, 4);
+	put_unaligned_le32(0, p);
+	p += 4;
+	p = dfu_test_chunk(p, CHUNK_TYPE_RAW, 1, DFU_TEST_BLK_SZ);
+	dfu_test_raw(p, DFU_TEST_LAST, DFU_TEST_BLK_SZ);
+}
+
+/*
+ * Write @len bytes of @image as DFU does, in buffers of @bufsize bytes, and
+ * check that the image was decoded
+ */
+static int dfu_test_write(struct unit_test_state *uts,
+			  struct dfu_test_medium *medium, const void *image,
+			  ulong len, ulong bufsize)
+{
+	struct dfu_entity dfu;
+	ulong offset, n;
+
+	memset(&dfu, '\0', sizeof(dfu));
+	strcpy(dfu.name, "test");
+	dfu.dev_private = medium;
+	dfu.get_medium_size = dfu_test_get_medium_size;
+	dfu.write_medium = dfu_test_write_medium;
+	dfu.erase_medium = dfu_test_erase_medium;
+	dfu.erase_size = DFU_TEST_ERASE_SIZE;
+	dfu.decode = 1;
+
+	memset(medium->data, DFU_TEST_UNTOUCHED, DFU_TEST_MEDIUM_SIZE);
+	medium->erased = 0;
+	medium->unaligned = false;
+
+	ut_asserteq(1, dfu_image_start(&dfu, image, min(len, bufsize)));
+	ut_asserteq(1, dfu.decoding);
+	for (offset = 0; offset < len; offset += n) {
+		n = min(len - offset, bufsize);
+		ut_assertok(dfu_image_write(&dfu, image + offset, n));
+	}
+	ut_assertok(dfu_image_finish(&dfu));
+	ut_asserteq(0, dfu.decoding);
+	ut_asserteq(false, medium->unaligned);
+
+	return 0;
+}
+
+/* Check the medium holds what the sparse image describes */
+static int dfu_test_check_sparse(struct unit_test_state *uts,
+				 struct dfu_test_medium *medium)
+{
+	const u8 *data = medium->data;
+	ulong i;
+
+	for (i = 0; i < DFU_TEST_DONT_CARE; i++)
+		ut_asserteq(dfu_test_byte(i), data[i]);
+	for (; i < DFU_TEST_FILL; i++)
+		ut_asserteq(DFU_TEST_UNTOUCHED, data[i]);
+	for (; i < DFU_TEST_ZERO; i += 4)
+		ut_asserteq(0xdeadbeef, get_unaligned_le32(data + i));
+	for (; i < DFU_TEST_LAST; i++)
+		ut_asserteq(0, data[i]);
+	for (; i < DFU_TEST_END; i++)
+		ut_asserteq(dfu_test_byte(i), data[i]);
+	for (; i < DFU_TEST_MEDIUM_SIZE; i++)
+		ut_asserteq(DFU_TEST_UNTOUCHED, data[i]);
+
+	/* The zero fill is erased, apart from the partial erase blocks */
+	ut_asserteq(ALIGN_DOWN(DFU_TEST_LAST, DFU_TEST_ERASE_SIZE) -
+		    ALIGN(DFU_TEST_ZERO, DFU_TEST_ERASE_SIZE),
+		    medium->erased);
+
+	return 0;
+}
+
+/* Test writing a sparse image, split so that headers cross buffers */
+static int lib_test_dfu_image_sparse(struct unit_test_state *uts)
+{
+	struct dfu_test_medium medium;
+	u8 *image;
+
+	medium.data = malloc(DFU_TEST_MEDIUM_SIZE);
+	image = malloc(DFU_TEST_SPARSE_SIZE);
+	ut_assertnonnull(medium.data);
+	ut_assertnonnull(image);
+
+	dfu_test_sparse(image);
+	ut_assertok(dfu_test_write(uts, &medium, image, DFU_TEST_SPARSE_SIZE,
+				   1000));
+	ut_assertok(dfu_test_check_sparse(uts, &medium));
+
+	free(image);
+	free(medium.data);
+
+	return 0;
+}
+LIB_TEST(lib_test_dfu_image_sparse, 0);
+
+/* Test writing compressed images, in buffers much smaller than the stream */
+static int lib_test_dfu_image_comp(struct unit_test_state *uts)
+{
+	struct dfu_test_medium medium;
+	ulong i;
+
+	medium.data = malloc(DFU_TEST_MEDIUM_SIZE);
+	ut_assertnonnull(medium.data);
+
+	if (IS_ENABLED(CONFIG_DFU_IMAGE_GZIP)) {
+		ut_assertok(dfu_test_write(uts, &medium, sparse_gzip,
+					   sizeof(sparse_gzip) - 1, 61));
+		ut_assertok(dfu_test_check_sparse(uts, &medium));
+	}
+
+	if (IS_ENABLED(CONFIG_DFU_IMAGE_ZSTD)) {
+		ut_assertok(dfu_test_write(uts, &medium, sparse_zstd,
+					   sizeof(sparse_zstd) - 1, 61));
+		ut_assertok(dfu_test_check_sparse(uts, &medium));
+
+		/* Not sparse, several times the size of the inflate buffer */
+		ut_assertok(dfu_test_write(uts, &medium, raw_zstd,
+					   sizeof(raw_zstd) - 1, 50));
+		for (i = 0; i < DFU_TEST_RAW_SIZE; i++)
+			ut_asserteq(dfu_test_byte(i), medium.data[i]);
+		for (; i < DFU_TEST_MEDIUM_SIZE; i++)
+			ut_asserteq(DFU_TEST_UNTOUCHED, medium.data[i]);
+		ut_asserteq(0, medium.erased);
+	}
+
+	free(medium.data);
+
+	return 0;
+}
+LIB_TEST(lib_test_dfu_image_comp, 0);
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the sinks which take files received over the network
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <net/sink.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+enum {
+	SINK_TEST_BLOCK	= 1000,
+	/* Several buffer flushes, ending with a partial block */
+	SINK_TEST_SIZE	= CONFIG_NET_SINK_BUF_SIZE * 2 + 123,
+};
+
+struct sink_test_priv {
+	u8 *buf;
+	ulong written;
+	ulong size;
+	int writes;
+	bool unaligned;
+};
+
+static int sink_test_write(struct net_sink *sink, ulong offset,
+			   const void *buf, ulong len)
+{
+	struct sink_test_priv *priv = sink->priv;
+
+	if (offset != priv->written || offset + len > SINK_TEST_SIZE)
+		return -EINVAL;
+	if (len % sink->align)
+		priv->unaligned = true;
+	memcpy(priv->buf + offset, buf, len);
+	priv->written += len;
+	priv->writes++;
+
+	return 0;
+}
+
+static int sink_test_finish(struct net_sink *sink, ulong size)
+{
+	struct sink_test_priv *priv = sink->priv;
+
+	priv->size = size;
+
+	return 0;
+}
+
+static void sink_test_fill(u8 *data)
+{
+	int i;
+
+	for (i = 0; i < SINK_TEST_SIZE; i++)
+		data[i] = i * 7 + (i >> 12);
+}
+
+/* Receive a file in blocks, swapping each pair of blocks as if reordered */
+static int sink_test_receive(struct unit_test_state *uts, const u8 *data)
+{
+	ulong offset, len, next;
+
+	for (offset = 0; offset < SINK_TEST_SIZE; offset = next) {
+		next = min(offset + 2 * SINK_TEST_BLOCK, (ulong)SINK_TEST_SIZE);
+		if (net_sink_active()) {
+			len = min((ulong)SINK_TEST_BLOCK, next - offset);
+			if (next - offset > len)
+				ut_assertok(net_sink_store(offset + len,
+							   data + offset + len,
+							   next - offset - len));
+			ut_assertok(net_sink_store(offset, data + offset, len));
+		}
+		ut_assertok(net_sink_commit(next));
+	}
+
+	return 0;
+}
+
+/* Test writing a file to a sink as it is received */
+static int lib_test_net_sink(struct unit_test_state *uts)
+{
+	struct sink_test_priv priv = {};
+	struct net_sink sink = {
+		.name	= "test",
+		.align	= 512,
+		.write	= sink_test_write,
+		.finish	= sink_test_finish,
+		.priv	= &priv,
+	};
+	u8 *data;
+
+	data = malloc(SINK_TEST_SIZE);
+	ut_assertnonnull(data);
+	priv.buf = calloc(1, SINK_TEST_SIZE);
+	ut_assertnonnull(priv.buf);
+	sink_test_fill(data);
+
+	net_sink_set(&sink);
+	ut_assert(net_sink_is_set());
+	ut_assert(!net_sink_active());
+	ut_assertok(net_sink_begin());
+	ut_assert(net_sink_active());
+	ut_assertok(sink_test_receive(uts, data));
+
+	/* The data is written while it arrives, not only at the end */
+	ut_assert(priv.writes >= 2);
+	ut_assert(!priv.unaligned);
+	ut_assertok(net_sink_end(0));
+	ut_assert(!net_sink_active());
+	ut_assert(!net_sink_is_set());
+
+	ut_asserteq(SINK_TEST_SIZE, priv.size);
+	ut_asserteq(SINK_TEST_SIZE, priv.written);
+	ut_asserteq_mem(data, priv.buf, SINK_TEST_SIZE);
+
+	free(priv.buf);
+	free(data);
+
+	return 0;
+}
+LIB_TEST(lib_test_net_sink, 0);
+
+/* Test a transfer larger than the buffer with no sink, as a plain tftp does */
+static int lib_test_net_sink_none(struct unit_test_state *uts)
+{
+	net_sink_set(NULL);
+	ut_assert(!net_sink_active());
+	ut_assertok(net_sink_begin());
+	ut_assertok(sink_test_receive(uts, NULL));
+	ut_assertok(net_sink_end(0));
+
+	return 0;
+}
+LIB_TEST(lib_test_net_sink_none, 0);
+
+/* Test that a sink is dropped if its transfer fails before it starts */
+static int lib_test_net_sink_unstarted(struct unit_test_state *uts)
+{
+	struct net_sink sink = {
+		.name	= "test",
+		.align	= 1,
+		.write	= sink_test_write,
+	};
+
+	net_sink_set(&sink);
+	ut_asserteq(-ENONET, net_sink_end(-ENONET));
+	ut_assert(!net_sink_is_set());
+	ut_assert(!net_sink_active());
+
+	return 0;
+}
+LIB_TEST(lib_test_net_sink_unstarted, 0);
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the sampling profiler
+ */
+
+#include <common.h>
+#include <profile.h>
+#include <time.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+static int lib_test_profile(struct unit_test_state *uts)
+{
+	struct profile_hdr *hdr;
+	char buf[1024];
+	ulong start;
+	int size;
+
+	ut_assertok(profile_start(1000));
+	ut_asserteq(-EBUSY, profile_start(1000));
+	ut_asserteq(-EBUSY, profile_dump(buf, sizeof(buf)));
+
+	/* Keep busy for 50ms, which should give about 50 samples */
+	start = timer_get_us();
+	while (timer_get_us() - start < 50000)
+		;
+	profile_stop();
+
+	size = profile_dump(buf, sizeof(buf));
+	ut_assert(size > sizeof(*hdr));
+	hdr = (struct profile_hdr *)buf;
+	ut_asserteq(PROFILE_MAGIC, hdr->magic);
+	ut_asserteq(PROFILE_VERSION, hdr->version);
+	ut_asserteq(1000, hdr->rate);
+	ut_assert(hdr->count > 0);
+	ut_asserteq(sizeof(*hdr) + hdr->count * sizeof(u32), size);
+
+	/* Only the latest samples are kept if the buffer is too small */
+	size = profile_dump(buf, sizeof(*hdr) + sizeof(u32));
+	ut_asserteq(sizeof(*hdr) + sizeof(u32), size);
+	ut_asserteq(1, hdr->count);
+	ut_asserteq(-ENOSPC, profile_dump(buf, sizeof(*hdr) - 1));
+
+	return 0;
+}
+LIB_TEST(lib_test_profile, 0);
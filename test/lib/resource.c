@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for resources built into U-Boot
+ */
+
+#include <common.h>
+#include <resource.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+U_BOOT_RESOURCE(resource_test_txt, "resource-test.txt");
+
+static int lib_test_resource(struct unit_test_state *uts)
+{
+	const char expect[] =
+		"This file is built into U-Boot as a compressed resource.\n";
+	void *data, *again;
+	ulong size;
+
+	ut_asserteq(-ENOENT, resource_get("no-such-file", &data, &size));
+
+	ut_assertok(resource_get("resource-test.txt", &data, &size));
+	ut_asserteq(strlen(expect), size);
+	ut_asserteq_mem(expect, data, size);
+
+	/* It is only decompressed the first time */
+	ut_assertok(resource_get("resource-test.txt", &again, &size));
+	ut_asserteq_ptr(data, again);
+
+	return 0;
+}
+LIB_TEST(lib_test_resource, 0);
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for jobs on a secondary CPU core
+ */
+
+#include <common.h>
+#include <worker.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define TEST_JOBS	40	/* more than fit in the queue at once */
+
+struct test_job {
+	struct worker_job job;
+	uint in;
+	uint out;
+};
+
+static void test_worker_func(void *arg)
+{
+	struct test_job *tj = arg;
+	uint i, sum = 0;
+
+	for (i = 0; i <= tj->in; i++)
+		sum += i;
+	tj->out = sum;
+}
+
+static int lib_test_worker(struct unit_test_state *uts)
+{
+	struct test_job jobs[TEST_JOBS];
+	int i, oldest, ret;
+
+	ut_assertok(worker_init());
+
+	/* Queue until the queue is full, then wait for the oldest job */
+	oldest = 0;
+	for (i = 0; i < TEST_JOBS; i++) {
+		jobs[i].in = i * 100;
+		jobs[i].out = 0;
+		for (;;) {
+			ret = worker_queue(&jobs[i].job, test_worker_func,
+					   &jobs[i]);
+			if (ret != -EBUSY)
+				break;
+			worker_wait(&jobs[oldest++].job);
+		}
+		ut_assertok(ret);
+	}
+
+	for (i = 0; i < TEST_JOBS; i++) {
+		worker_wait(&jobs[i].job);
+		ut_assert(worker_done(&jobs[i].job));
+		ut_asserteq(i * 100 * (i * 100 + 1) / 2, jobs[i].out);
+	}
+
+	return 0;
+}
+
+LIB_TEST(lib_test_worker, 0);
+
+/* Test that stopping the core finishes the queued jobs and allows a restart */
+static int lib_test_worker_stop(struct unit_test_state *uts)
+{
+	struct test_job jobs[2];
+
+	jobs[0].in = 1000;
+	ut_assertok(worker_queue(&jobs[0].job, test_worker_func, &jobs[0]));
+	worker_stop();
+	ut_assert(worker_done(&jobs[0].job));
+	ut_asserteq(1000 * 1001 / 2, jobs[0].out);
+
+	/* Stopping again does nothing */
+	worker_stop();
+
+	jobs[1].in = 10;
+	ut_assertok(worker_queue(&jobs[1].job, test_worker_func, &jobs[1]));
+	worker_wait(&jobs[1].job);
+	ut_asserteq(10 * 11 / 2, jobs[1].out);
+
+	return 0;
+}
+
+LIB_TEST(lib_test_worker_stop, 0);
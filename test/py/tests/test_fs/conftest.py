@@ -294,6 +294,10 @@ def fs_obj_basic(request, u_boot_config):
         check_call('dd if=/dev/urandom of=%s bs=1M count=1'
 	    % small_file, shell=True)
 
+        # And a gzipped copy of it, several chunks long for load -z
+        check_call('gzip -c %s > %s/%s'
+            % (small_file, mount_dir, SMALL_GZ_FILE), shell=True)
+
         # Delete the small file copies which possibly are written as part of a
         # previous test.
         # check_call('rm -f "%s.w"' % MB1, shell=True)
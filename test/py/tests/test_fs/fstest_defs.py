@@ -6,6 +6,9 @@ MIN_FILE='testfile'
 # $SMALL_FILE is the name of the 1MB file in the file system image
 SMALL_FILE='1MB.file'
 
+# $SMALL_GZ_FILE is the name of $SMALL_FILE compressed with gzip
+SMALL_GZ_FILE='1MB.file.gz'
+
 # $MEDIUM_FILE is the name of the 10MB file in the file system image
 MEDIUM_FILE='10MB.file'
 
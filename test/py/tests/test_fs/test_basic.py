@@ -290,3 +290,38 @@ class TestFsBasic(object):
                 'setenv filesize'])
             assert(md5val[0] in ''.join(output))
             assert_fs_integrity(fs_type, fs_img)
+
+    def test_fs14(self, u_boot_console, fs_obj_basic):
+        """
+        Test Case 14 - load -z, decompressing a gzipped file while reading it
+        """
+        fs_type,fs_img,md5val = fs_obj_basic
+        if not u_boot_console.config.buildconfig.get('config_gzip', None):
+            pytest.skip('load -z needs CONFIG_GZIP')
+        with u_boot_console.log.section('Test Case 14 - load -z'):
+            output = u_boot_console.run_command_list([
+                'host bind 0 %s' % fs_img,
+                'mw.b %x 00 100' % ADDR,
+                'load -z host 0:0 %x /%s' % (ADDR, SMALL_GZ_FILE),
+                'printenv filesize',
+                'md5sum %x $filesize' % ADDR,
+                'setenv filesize'])
+            assert('filesize=100000' in ''.join(output))
+            assert(md5val[0] in ''.join(output))
+
+    def test_fs15(self, u_boot_console, fs_obj_basic):
+        """
+        Test Case 15 - load, starting at or beyond the end of the file
+        """
+        fs_type,fs_img,md5val = fs_obj_basic
+        with u_boot_console.log.section('Test Case 15 - load (offset at EOF)'):
+            output = u_boot_console.run_command_list([
+                'host bind 0 %s' % fs_img,
+                '%sload host 0:0 %x /%s 0x10 0x100000'
+                    % (fs_type, ADDR, SMALL_FILE)])
+            assert('Failed to load' in ''.join(output))
+
+            output = u_boot_console.run_command(
+                '%sload host 0:0 %x /%s 0x10 0x200000'
+                    % (fs_type, ADDR, SMALL_FILE))
+            assert('Failed to load' in output)
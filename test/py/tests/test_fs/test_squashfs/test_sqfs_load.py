@@ -42,5 +42,9 @@ def test_sqfs_load(u_boot_console):
         output = u_boot_console.run_command(command + "sym")
         assert str(opt.sizes[0]) in output
 
+        # test reading at an offset, across a data block and the fragment
+        output = u_boot_console.run_command(command + "blks_frag 200 f80")
+        assert "512 bytes read" in output
+
         # remove generated files
         opt.cleanup(build_dir)
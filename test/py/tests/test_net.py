@@ -4,8 +4,12 @@
 # Test various network-related functionality, such as the dhcp, ping, and
 # tftpboot commands.
 
+import http.server
+import os
 import pytest
+import threading
 import u_boot_utils
+import zlib
 
 """
 Note: This test relies on boardenv_* containing configuration values to define
@@ -56,6 +60,23 @@ env__net_nfs_readable_file = {
     'size': 5058624,
     'crc32': 'c2244b26',
 }
+
+# Details regarding a file that may be read from an HTTP server. The server
+# runs at $serverip, on port 80 unless 'port' is given. This variable may be
+# omitted or set to None if wget testing is not possible or desired.
+env__net_wget_readable_file = {
+    'fn': 'ubtest-readable.bin',
+    'addr': 0x10000000,
+    'size': 5058624,
+    'crc32': 'c2244b26',
+    'port': 8080,
+}
+
+# Port on which the test starts an HTTP server itself, serving a random file
+# from the host running the tests. $serverip must be an address of that host,
+# as with sandbox using eth-raw on one of its interfaces. This variable may be
+# omitted or set to None if this is not possible.
+env__net_wget_local_port = 8080
 """
 
 net_set_up = False
@@ -214,3 +235,101 @@ def test_net_nfs(u_boot_console):
 
     output = u_boot_console.run_command('crc32 %x $filesize' % addr)
     assert expected_crc in output
+
+def wget_file(u_boot_console, fn, port, addr, size, crc32, timeout=None):
+    """Download a file with wget and check its size and CRC32."""
+
+    if not addr:
+        addr = u_boot_utils.find_ram_base(u_boot_console)
+    if not timeout:
+        timeout = u_boot_console.p.timeout
+
+    u_boot_console.run_command('setenv httpdstp %d' % port)
+    with u_boot_console.temporary_timeout(timeout):
+        output = u_boot_console.run_command('wget %x %s' % (addr, fn))
+    u_boot_console.run_command('setenv httpdstp')
+
+    expected_text = 'Bytes transferred = '
+    if size:
+        expected_text += '%d' % size
+    assert 'wget: ' not in output
+    assert expected_text in output
+
+    if not crc32:
+        return
+
+    if u_boot_console.config.buildconfig.get('config_cmd_crc32', 'n') != 'y':
+        return
+
+    output = u_boot_console.run_command('crc32 %x $filesize' % addr)
+    assert crc32 in output
+
+@pytest.mark.buildconfigspec('cmd_wget')
+def test_net_wget(u_boot_console):
+    """Test the wget command.
+
+    A file is downloaded from the HTTP server, its size and optionally its
+    CRC32 are validated.
+
+    The details of the file to download are provided by the boardenv_* file;
+    see the comment at the beginning of this file.
+    """
+
+    if not net_set_up:
+        pytest.skip('Network not initialized')
+
+    f = u_boot_console.config.env.get('env__net_wget_readable_file', None)
+    if not f:
+        pytest.skip('No HTTP readable file to read')
+
+    wget_file(u_boot_console, f['fn'], f.get('port', 80), f.get('addr', None),
+              f.get('size', None), f.get('crc32', None),
+              f.get('timeout', None))
+
+@pytest.mark.buildconfigspec('cmd_wget')
+def test_net_wget_local(u_boot_console):
+    """Test the wget command against an HTTP server started by the test.
+
+    A random file is served from the host running the tests, downloaded and
+    its size and CRC32 are validated.
+
+    The port of the server is provided by the boardenv_* file; see the
+    comment at the beginning of this file.
+    """
+
+    if not net_set_up:
+        pytest.skip('Network not initialized')
+
+    port = u_boot_console.config.env.get('env__net_wget_local_port', None)
+    if not port:
+        pytest.skip('No local HTTP server port defined')
+
+    fn = 'ubtest-wget.bin'
+    size = 3 * 1024 * 1024 + 123
+    data = os.urandom(size)
+    path = os.path.join(u_boot_console.config.result_dir, fn)
+    with open(path, 'wb') as fh:
+        fh.write(data)
+
+    class Handler(http.server.SimpleHTTPRequestHandler):
+        def __init__(self, *args, **kwargs):
+            super().__init__(*args, directory=u_boot_console.config.result_dir,
+                             **kwargs)
+
+        def log_message(self, format, *args):
+            pass
+
+    server = http.server.HTTPServer(('', port), Handler)
+    thread = threading.Thread(target=server.serve_forever)
+    thread.start()
+    try:
+        wget_file(u_boot_console, fn, port, None, size,
+                  '%08x' % zlib.crc32(data))
+        u_boot_console.run_command('setenv httpdstp %d' % port)
+        output = u_boot_console.run_command('wget ubtest-missing.bin')
+        u_boot_console.run_command('setenv httpdstp')
+        assert 'server replied' in output
+    finally:
+        server.shutdown()
+        thread.join()
+        os.remove(path)
@@ -18,6 +18,7 @@
 #include <sys/types.h>
 
 #include <compiler.h>
+#include <profile.h>
 #include <trace.h>
 
 #define MAX_LINE_LEN 500
@@ -31,6 +32,7 @@ struct func_info {
 	const char *name;
 	unsigned long code_size;
 	unsigned long call_count;
+	unsigned long sample_count;
 	unsigned flags;
 	/* the section this function is in */
 	struct objsection_info *objsection;
@@ -55,6 +57,8 @@ struct func_info *func_list;
 int func_count;
 struct trace_call *call_list;
 int call_count;
+struct profile_hdr sample_hdr;	/* Header of the profiler samples */
+uint32_t *sample_list;
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
@@ -85,9 +89,11 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-samples\tList the functions hit by profiler samples\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
+		"   -s <samples>\tSpecify samples file (from 'profile dump')\n"
 		"   -t <trace>\tSpecific trace data file (from U-Boot)\n"
 		"   -v <0-4>\tSpecify verbosity\n");
 	exit(EXIT_FAILURE);
@@ -201,6 +207,8 @@ static struct func_info *find_caller_by_offset(uint32_t offset)
 		else
 			return &func_list[mid];
 	}
+	if (high >= 0 && h_cmp_offset(&key, &func_list[high]) >= 0)
+		return &func_list[high];
 
 	return low >= 0 ? &func_list[low] : NULL;
 }
@@ -297,6 +305,37 @@ static int read_profile_file(const char *fname)
 	return 0;
 }
 
+static int read_samples_file(const char *fname)
+{
+	struct profile_hdr *hdr = &sample_hdr;
+	FILE *fin;
+	int err = 0;
+
+	fin = fopen(fname, "rb");
+	if (!fin) {
+		error("Cannot open samples file '%s'\n", fname);
+		return 1;
+	}
+	if (read_data(fin, hdr, sizeof(*hdr)) || hdr->magic != PROFILE_MAGIC ||
+	    hdr->version != PROFILE_VERSION) {
+		error("'%s' does not hold profiler samples\n", fname);
+		err = 1;
+	} else {
+		sample_list = calloc(hdr->count, sizeof(*sample_list));
+		assert(sample_list);
+		if (hdr->count &&
+		    read_data(fin, sample_list,
+			      hdr->count * sizeof(*sample_list))) {
+			error("Samples file '%s' is truncated\n", fname);
+			err = 1;
+		}
+	}
+	fclose(fin);
+	notice("%u samples\n", hdr->count);
+
+	return err;
+}
+
 static int regex_report_error(regex_t *regex, int err, const char *op,
 			      const char *name)
 {
@@ -532,9 +571,79 @@ static int make_ftrace(void)
 	return 0;
 }
 
+static int h_cmp_sample_count(const void *v1, const void *v2)
+{
+	const struct func_info *f1 = *(struct func_info **)v1;
+	const struct func_info *f2 = *(struct func_info **)v2;
+
+	if (f1->sample_count != f2->sample_count)
+		return f1->sample_count < f2->sample_count ? 1 : -1;
+
+	return strcmp(f1->name, f2->name);
+}
+
+/*
+ * List the functions hit by the profiler samples, the hottest first:
+ *
+ *  Samples       %  Function
+ *      812   40.6%  mmc_send_cmd
+ *      301   15.0%  memcpy
+ */
+static int make_sample_report(void)
+{
+	struct profile_hdr *hdr = &sample_hdr;
+	struct func_info **sorted, *func;
+	unsigned long unknown = 0;
+	int i, hit = 0;
+
+	if (!sample_list) {
+		error("No samples given (use -s)\n");
+		return -1;
+	}
+
+	for (i = 0; i < hdr->count; i++) {
+		uint32_t offset = sample_list[i];
+
+		func = find_caller_by_offset(offset);
+		if (!func || offset < func->offset ||
+		    (func->code_size &&
+		     offset >= func->offset + func->code_size)) {
+			debug("Sample at %lx is not in a function\n",
+			      text_offset + offset);
+			unknown++;
+			continue;
+		}
+		if (!func->sample_count++)
+			hit++;
+	}
+
+	sorted = calloc(hit, sizeof(*sorted));
+	assert(sorted || !hit);
+	for (i = 0, hit = 0; i < func_count; i++) {
+		if (func_list[i].sample_count)
+			sorted[hit++] = &func_list[i];
+	}
+	qsort(sorted, hit, sizeof(*sorted), h_cmp_sample_count);
+
+	printf("%u samples at %u Hz (%u lost)\n\n", hdr->count, hdr->rate,
+	       hdr->lost);
+	printf("%8s %7s  %s\n", "Samples", "%", "Function");
+	for (i = 0; i < hit; i++) {
+		func = sorted[i];
+		printf("%8lu %6.1f%%  %s\n", func->sample_count,
+		       100.0 * func->sample_count / hdr->count, func->name);
+	}
+	if (unknown)
+		printf("%8lu %6.1f%%  (outside U-Boot)\n", unknown,
+		       100.0 * unknown / hdr->count);
+	free(sorted);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char *const argv[],
 		     const char *prof_fname, const char *map_fname,
-		     const char *trace_config_fname)
+		     const char *trace_config_fname, const char *samples_fname)
 {
 	int err = 0;
 
@@ -542,6 +651,8 @@ static int prof_tool(int argc, char *const argv[],
 		return -1;
 	if (prof_fname && read_profile_file(prof_fname))
 		return -1;
+	if (samples_fname && read_samples_file(samples_fname))
+		return -1;
 	if (trace_config_fname && read_trace_config_file(trace_config_fname))
 		return -1;
 
@@ -552,6 +663,8 @@ static int prof_tool(int argc, char *const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-samples"))
+			err = make_sample_report();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}
@@ -564,10 +677,11 @@ int main(int argc, char *argv[])
 	const char *map_fname = "System.map";
 	const char *prof_fname = NULL;
 	const char *trace_config_fname = NULL;
+	const char *samples_fname = NULL;
 	int opt;
 
 	verbose = 2;
-	while ((opt = getopt(argc, argv, "m:p:t:v:")) != -1) {
+	while ((opt = getopt(argc, argv, "m:p:s:t:v:")) != -1) {
 		switch (opt) {
 		case 'm':
 			map_fname = optarg;
@@ -577,6 +691,10 @@ int main(int argc, char *argv[])
 			prof_fname = optarg;
 			break;
 
+		case 's':
+			samples_fname = optarg;
+			break;
+
 		case 't':
 			trace_config_fname = optarg;
 			break;
@@ -595,5 +713,5 @@ int main(int argc, char *argv[])
 
 	debug("Debug enabled\n");
 	return prof_tool(argc, argv, prof_fname, map_fname,
-			 trace_config_fname);
+			 trace_config_fname, samples_fname);
 }